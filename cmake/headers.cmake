@@ -14,6 +14,7 @@ set(llfio_HEADERS
   "include/llfio/v2.0/algorithm/handle_adapter/cached_parent.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/combining.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/xor.hpp"
+  "include/llfio/v2.0/algorithm/mapped_ring_buffer.hpp"
   "include/llfio/v2.0/algorithm/reduce.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/atomic_append.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/base.hpp"
@@ -31,14 +32,17 @@ set(llfio_HEADERS
   "include/llfio/v2.0/detail/impl/config.ipp"
   "include/llfio/v2.0/detail/impl/fast_random_file_handle.ipp"
   "include/llfio/v2.0/detail/impl/io_multiplexer.ipp"
+  "include/llfio/v2.0/detail/impl/mapped_file_handle_prefetcher.ipp"
   "include/llfio/v2.0/detail/impl/path_discovery.ipp"
   "include/llfio/v2.0/detail/impl/path_view.ipp"
   "include/llfio/v2.0/detail/impl/posix/directory_handle.ipp"
+  "include/llfio/v2.0/detail/impl/posix/epoll_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/posix/file_handle.ipp"
   "include/llfio/v2.0/detail/impl/posix/fs_handle.ipp"
   "include/llfio/v2.0/detail/impl/posix/handle.ipp"
   "include/llfio/v2.0/detail/impl/posix/import.hpp"
   "include/llfio/v2.0/detail/impl/posix/io_handle.ipp"
+  "include/llfio/v2.0/detail/impl/posix/io_uring_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/posix/lockable_io_handle.ipp"
   "include/llfio/v2.0/detail/impl/posix/map_handle.ipp"
   "include/llfio/v2.0/detail/impl/posix/mapped_file_handle.ipp"
@@ -50,7 +54,6 @@ set(llfio_HEADERS
   "include/llfio/v2.0/detail/impl/posix/statfs.ipp"
   "include/llfio/v2.0/detail/impl/posix/storage_profile.ipp"
   "include/llfio/v2.0/detail/impl/posix/symlink_handle.ipp"
-  "include/llfio/v2.0/detail/impl/posix/test/io_uring_multiplexer.ipp"
   "include/llfio/v2.0/detail/impl/posix/utils.ipp"
   "include/llfio/v2.0/detail/impl/reduce.ipp"
   "include/llfio/v2.0/detail/impl/safe_byte_ranges.ipp"
@@ -7,23 +7,32 @@ set(llfio_TESTS
   "test/tests/directory_handle_create_close/runner.cpp"
   "test/tests/directory_handle_enumerate/kernel_directory_handle_enumerate.cpp.hpp"
   "test/tests/directory_handle_enumerate/runner.cpp"
+  "test/tests/epoll_multiplexer.cpp"
   "test/tests/fast_random_file_handle.cpp"
   "test/tests/file_handle_create_close/kernel_file_handle.cpp.hpp"
   "test/tests/file_handle_create_close/runner.cpp"
   "test/tests/file_handle_lock_unlock.cpp"
   "test/tests/handle_adapter_xor.cpp"
+  "test/tests/io_request_flags.cpp"
+  "test/tests/io_uring_multiplexer.cpp"
   "test/tests/issue0009.cpp"
   "test/tests/issue0027.cpp"
   "test/tests/issue0028.cpp"
   "test/tests/large_pages.cpp"
+  "test/tests/map_handle_cache.cpp"
   "test/tests/map_handle_create_close/kernel_map_handle.cpp.hpp"
   "test/tests/map_handle_create_close/runner.cpp"
   "test/tests/mapped.cpp"
+  "test/tests/mapped_file_handle_prefetcher.cpp"
+  "test/tests/mapped_ring_buffer.cpp"
+  "test/tests/max_buffers.cpp"
   "test/tests/path_discovery.cpp"
   "test/tests/path_view.cpp"
   "test/tests/pipe_handle.cpp"
   "test/tests/process_handle.cpp"
   "test/tests/reduce.cpp"
+  "test/tests/residency.cpp"
+  "test/tests/section_handle_anonymous.cpp"
   "test/tests/section_handle_create_close/kernel_section_handle.cpp.hpp"
   "test/tests/section_handle_create_close/runner.cpp"
   "test/tests/shared_fs_mutex.cpp"
@@ -0,0 +1,370 @@
+/* A ring buffer whose wrap around is made contiguous by mapping its storage twice
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_MAPPED_RING_BUFFER_HPP
+#define LLFIO_ALGORITHM_MAPPED_RING_BUFFER_HPP
+
+#include "../map_handle.hpp"
+
+#include <atomic>
+#include <memory>  // for unique_ptr
+#include <thread>  // for yield
+
+//! \file mapped_ring_buffer.hpp Provides algorithm::mapped_ring_buffer
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  /*! \class mapped_ring_buffer
+  \brief A byte ring buffer whose storage is mapped twice back to back, so every read and write is a
+  single contiguous span even when it wraps around the end of the buffer.
+
+  The storage is a `section_handle`. Its first page (64Kb on Windows) holds the control block with the
+  head and tail indices, each in its own cache line. The remaining `capacity()` bytes are mapped twice
+  into an address space reservation of `2 * capacity()` bytes, using `map_handle::map_at()`. Byte `n`
+  of the buffer therefore appears at both `n` and `n + capacity()`, so a span which begins before the
+  end of the first view and runs into the second view is still a correct view of the ring.
+
+  One consumer is supported, with either one producer (`producers::single`), or any number of
+  concurrent producers (`producers::multiple`). In the latter case producers claim space with a
+  compare and swap, and publish it in the order in which it was claimed.
+
+  If the section is file backed, or is anonymous memory whose native handle has been inherited
+  by, or passed to, another process, then the ring buffer works across processes. Create it
+  in one process using `ring_buffer(section_handle &, producers)` and open it in the others using
+  `attach()`. The head and tail indices are 64 bit atomics, so every process must be using
+  lock free atomics of that size, which is the case on all the major platforms.
+
+  Caveats:
+  - There is no ability to sleep until data or space becomes available. `begin_write()` and
+  `begin_read()` return an empty span instead, and it is up to you to poll or to signal using
+  some other mechanism.
+  - A multiple producer who has claimed space, but not yet published it, blocks publication of space
+  claimed after it by the other producers. Sudden exit of such a producer stalls the ring buffer.
+  - The capacity is rounded up to a multiple of the page size (64Kb on Windows).
+  */
+  class mapped_ring_buffer
+  {
+  public:
+    //! The type of a span of bytes within the buffer
+    using buffer_type = map_handle::buffer_type;
+    //! The type of a span of const bytes within the buffer
+    using const_buffer_type = map_handle::const_buffer_type;
+    //! The type of a count of bytes
+    using size_type = map_handle::size_type;
+
+    //! How many producers may concurrently write into the buffer
+    enum class producers : uint32_t
+    {
+      single = 1,   //!< One producer thread, which is the cheapest
+      multiple = 2  //!< Any number of concurrent producer threads or processes
+    };
+
+  private:
+    static constexpr uint64_t _magic = 0x3142524f49464c4c;  // LLFIORB1
+    struct _control_block_t
+    {
+      uint64_t magic;
+      uint64_t capacity;
+      producers producer_kind;
+      alignas(64) std::atomic<uint64_t> head;     // end of published data
+      alignas(64) std::atomic<uint64_t> reserve;  // end of claimed space, multiple producers only
+      alignas(64) std::atomic<uint64_t> tail;     // end of consumed data
+    };
+
+    std::unique_ptr<section_handle> _sectionh;  // if the storage is owned by this instance
+    map_handle _controlh, _firsth, _secondh;
+    _control_block_t *_control{nullptr};
+    byte *_data{nullptr};
+    uint64_t _capacity{0};
+    bool _multiple{false};
+
+    // The offset of the data within the section, which must be a valid map offset
+    static size_type _control_size() noexcept
+    {
+#ifdef _WIN32
+      return 65536;
+#else
+      return utils::page_size();
+#endif
+    }
+
+    // Map capacity bytes of the section at offset twice back to back
+    static result<void> _map_twice(section_handle &section, size_type capacity, map_handle &firsth, map_handle &secondh) noexcept
+    {
+      // On Windows another thread may take the released reservation before we map into it, so retry a few times
+      for(size_t n = 0; n < 16; n++)
+      {
+        OUTCOME_TRY(auto &&reservation, map_handle::reserve(capacity * 2));
+        byte *addr = reservation.address();
+#ifdef _WIN32
+        // Windows cannot map a view over part of a reservation, so release it first
+        OUTCOME_TRYV(reservation.close());
+#endif
+        auto first = map_handle::map_at(addr, section, capacity, _control_size());
+        if(!first)
+        {
+#ifdef _WIN32
+          continue;
+#else
+          return std::move(first).error();
+#endif
+        }
+        auto second = map_handle::map_at(addr + capacity, section, capacity, _control_size());
+        if(!second)
+        {
+#ifdef _WIN32
+          continue;
+#else
+          return std::move(second).error();
+#endif
+        }
+#ifndef _WIN32
+        // The two views now occupy all of the reservation, and will unmap it
+        reservation.release();
+#endif
+        firsth = std::move(first).value();
+        secondh = std::move(second).value();
+        return success();
+      }
+      return errc::not_enough_memory;
+    }
+
+    static result<mapped_ring_buffer> _open(section_handle &section, std::unique_ptr<section_handle> sectionh, producers *init) noexcept
+    {
+      LLFIO_LOG_FUNCTION_CALL(0);
+      OUTCOME_TRY(auto &&length, section.length());
+      if(length < _control_size() * 2)
+      {
+        return errc::invalid_argument;
+      }
+      mapped_ring_buffer ret;
+      OUTCOME_TRY(auto &&controlh, map_handle::map(section, sizeof(_control_block_t), 0));
+      ret._controlh = std::move(controlh);
+      ret._control = reinterpret_cast<_control_block_t *>(ret._controlh.address());
+      if(init != nullptr)
+      {
+        ret._control->magic = 0;
+        ret._control->capacity = (length - _control_size()) / _control_size() * _control_size();
+        ret._control->producer_kind = *init;
+        new(&ret._control->head) std::atomic<uint64_t>(0);
+        new(&ret._control->reserve) std::atomic<uint64_t>(0);
+        new(&ret._control->tail) std::atomic<uint64_t>(0);
+        std::atomic_thread_fence(std::memory_order_release);
+        ret._control->magic = _magic;
+      }
+      else
+      {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(ret._control->magic != _magic || ret._control->capacity == 0 || ret._control->capacity > length - _control_size() || ret._control->capacity % _control_size() != 0)
+        {
+          return errc::invalid_argument;
+        }
+      }
+      ret._capacity = ret._control->capacity;
+      ret._multiple = (ret._control->producer_kind == producers::multiple);
+      OUTCOME_TRYV(_map_twice(section, static_cast<size_type>(ret._capacity), ret._firsth, ret._secondh));
+      ret._data = ret._firsth.address();
+      ret._sectionh = std::move(sectionh);
+      return {std::move(ret)};
+    }
+
+  public:
+    //! Default constructor
+    constexpr mapped_ring_buffer() {}  // NOLINT
+    //! No copy construction
+    mapped_ring_buffer(const mapped_ring_buffer &) = delete;
+    //! Move constructor
+    mapped_ring_buffer(mapped_ring_buffer &&o) noexcept
+        : _sectionh(std::move(o._sectionh))
+        , _controlh(std::move(o._controlh))
+        , _firsth(std::move(o._firsth))
+        , _secondh(std::move(o._secondh))
+        , _control(o._control)
+        , _data(o._data)
+        , _capacity(o._capacity)
+        , _multiple(o._multiple)
+    {
+      o._control = nullptr;
+      o._data = nullptr;
+      o._capacity = 0;
+    }
+    //! No copy assignment
+    mapped_ring_buffer &operator=(const mapped_ring_buffer &) = delete;
+    //! Move assignment
+    mapped_ring_buffer &operator=(mapped_ring_buffer &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~mapped_ring_buffer();
+      new(this) mapped_ring_buffer(std::move(o));
+      return *this;
+    }
+    ~mapped_ring_buffer()
+    {
+      // The maps must go before any section they use
+      _secondh = {};
+      _firsth = {};
+      _controlh = {};
+    }
+
+    /*! Create a ring buffer of at least `capacity` bytes for use within this process, backed by
+    a newly created anonymous section.
+    */
+    static result<mapped_ring_buffer> ring_buffer(size_type capacity, producers producer_kind = producers::single) noexcept
+    {
+      if(capacity == 0)
+      {
+        return errc::invalid_argument;
+      }
+      try
+      {
+        capacity = utils::round_up_to_page_size(capacity, _control_size());
+        OUTCOME_TRY(auto &&section, section_handle::anonymous_section(_control_size() + capacity));
+        auto sectionh = std::make_unique<section_handle>(std::move(section));
+        auto &sh = *sectionh;
+        return _open(sh, std::move(sectionh), &producer_kind);
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+    /*! Create a ring buffer in an existing section, initialising its control block. The capacity
+    will be the length of the section less the size of the control block, rounded down to the page
+    size. The section must outlive the ring buffer.
+    */
+    static result<mapped_ring_buffer> ring_buffer(section_handle &section, producers producer_kind = producers::single) noexcept { return _open(section, {}, &producer_kind); }
+    /*! Open a ring buffer previously created in a section by `ring_buffer(section_handle &, producers)`,
+    typically by another process. The section must outlive the ring buffer.
+    */
+    static result<mapped_ring_buffer> attach(section_handle &section) noexcept { return _open(section, {}, nullptr); }
+
+    //! True if this ring buffer is valid
+    bool is_valid() const noexcept { return _data != nullptr; }
+    //! The capacity of the ring buffer in bytes
+    size_type capacity() const noexcept { return static_cast<size_type>(_capacity); }
+    //! The kind of producers this ring buffer was created for
+    producers producer_kind() const noexcept { return _multiple ? producers::multiple : producers::single; }
+    //! The number of bytes published and not yet consumed. Only a snapshot if there are concurrent users.
+    size_type size() const noexcept { return static_cast<size_type>(_control->head.load(std::memory_order_acquire) - _control->tail.load(std::memory_order_acquire)); }
+    //! True if there are no bytes to read. Only a snapshot if there are concurrent users.
+    bool empty() const noexcept { return size() == 0; }
+
+    /*! Claim `bytes` of contiguous space to write into, returning an empty span if there is
+    insufficient free space. The space must be published with `end_write()`, after which the consumer
+    can read it.
+    */
+    buffer_type begin_write(size_type bytes) noexcept
+    {
+      if(bytes == 0 || bytes > _capacity)
+      {
+        return {};
+      }
+      if(!_multiple)
+      {
+        const uint64_t head = _control->head.load(std::memory_order_relaxed);
+        if(head + bytes - _control->tail.load(std::memory_order_acquire) > _capacity)
+        {
+          return {};
+        }
+        return {_data + head % _capacity, bytes};
+      }
+      uint64_t reserve = _control->reserve.load(std::memory_order_relaxed);
+      do
+      {
+        if(reserve + bytes - _control->tail.load(std::memory_order_acquire) > _capacity)
+        {
+          return {};
+        }
+      } while(!_control->reserve.compare_exchange_weak(reserve, reserve + bytes, std::memory_order_relaxed, std::memory_order_relaxed));
+      return {_data + reserve % _capacity, bytes};
+    }
+    /*! Publish space previously claimed by `begin_write()`. With multiple producers, this waits until
+    all space claimed before this space has been published.
+    */
+    void end_write(buffer_type claimed) noexcept
+    {
+      const uint64_t pos = static_cast<uint64_t>(claimed.data() - _data);
+      uint64_t head = _control->head.load(std::memory_order_acquire);
+      if(_multiple)
+      {
+        // The claimed space begins at the only index in [head, head + capacity) congruent to pos
+        while(head % _capacity != pos)
+        {
+          std::this_thread::yield();
+          head = _control->head.load(std::memory_order_acquire);
+        }
+      }
+      _control->head.store(head + claimed.size(), std::memory_order_release);
+    }
+    //! Copy `data` into the ring buffer, returning false if there is insufficient free space.
+    bool write(const_buffer_type data) noexcept
+    {
+      auto b = begin_write(data.size());
+      if(b.size() == 0)
+      {
+        return false;
+      }
+      memcpy(b.data(), data.data(), data.size());
+      end_write(b);
+      return true;
+    }
+
+    /*! Returns all the published data not yet consumed as a single contiguous span, which may be empty.
+    Call `end_read()` to consume some or all of it. There can be only one consumer.
+    */
+    const_buffer_type begin_read() const noexcept
+    {
+      const uint64_t tail = _control->tail.load(std::memory_order_relaxed);
+      const uint64_t head = _control->head.load(std::memory_order_acquire);
+      return {_data + tail % _capacity, static_cast<size_type>(head - tail)};
+    }
+    //! Consume `bytes` from the front of the published data, making that space available to producers.
+    void end_read(size_type bytes) noexcept
+    {
+      const uint64_t tail = _control->tail.load(std::memory_order_relaxed);
+      _control->tail.store(tail + bytes, std::memory_order_release);
+    }
+    //! Copy up to `buffer.size()` bytes out of the ring buffer, returning the number of bytes copied.
+    size_type read(buffer_type buffer) noexcept
+    {
+      auto b = begin_read();
+      const size_type bytes = (b.size() < buffer.size()) ? b.size() : buffer.size();
+      if(bytes > 0)
+      {
+        memcpy(buffer.data(), b.data(), bytes);
+        end_read(bytes);
+      }
+      return bytes;
+    }
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
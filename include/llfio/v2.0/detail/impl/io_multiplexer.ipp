@@ -24,7 +24,27 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "../../io_multiplexer.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef _WIN32
+#include "windows/import.hpp"
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 LLFIO_V2_NAMESPACE_BEGIN
 
@@ -35,6 +55,408 @@ namespace this_thread
   LLFIO_HEADERS_ONLY_FUNC_SPEC void set_multiplexer(io_multiplexer *ctx) noexcept { _thread_multiplexer = ctx; }
 }  // namespace this_thread
 
+namespace detail
+{
+  /* Aligned allocation for io_multiplexer::state_pool. Over-aligned operator new is
+  C++17 only, so over-allocate and align by hand, keeping the pointer actually
+  allocated just before the block returned.
+  */
+  inline void *io_multiplexer_state_pool_allocate(size_t bytes, size_t align) noexcept
+  {
+    if(align < alignof(void *))
+    {
+      align = alignof(void *);
+    }
+    void *raw = ::operator new(bytes + align - 1 + sizeof(void *), std::nothrow);
+    if(raw == nullptr)
+    {
+      return nullptr;
+    }
+    const uintptr_t addr = (reinterpret_cast<uintptr_t>(raw) + sizeof(void *) + align - 1) & ~static_cast<uintptr_t>(align - 1);
+    void *ret = reinterpret_cast<void *>(addr);
+    static_cast<void **>(ret)[-1] = raw;
+    return ret;
+  }
+  inline void io_multiplexer_state_pool_deallocate(void *p) noexcept
+  {
+    if(p != nullptr)
+    {
+      ::operator delete(static_cast<void **>(p)[-1]);
+    }
+  }
+
+  // The per thread free lists of io_multiplexer::state_pool, one per block size
+  struct io_multiplexer_state_pool_cache
+  {
+    struct free_list
+    {
+      size_t bytes{0}, align{0}, count{0};
+      void *head{nullptr};
+    };
+    free_list lists[4];
+
+    ~io_multiplexer_state_pool_cache()
+    {
+      for(auto &l : lists)
+      {
+        while(l.head != nullptr)
+        {
+          void *next = *static_cast<void **>(l.head);
+          io_multiplexer_state_pool_deallocate(l.head);
+          l.head = next;
+        }
+      }
+    }
+    // Returns the free list for the block size, or null if all lists are in use by other sizes
+    free_list *find(size_t bytes, size_t align) noexcept
+    {
+      for(auto &l : lists)
+      {
+        if(l.bytes == bytes && l.align == align)
+        {
+          return &l;
+        }
+        if(l.bytes == 0)
+        {
+          l.bytes = bytes;
+          l.align = align;
+          return &l;
+        }
+      }
+      return nullptr;
+    }
+  };
+  inline io_multiplexer_state_pool_cache &io_multiplexer_state_pool_cache_for_this_thread() noexcept
+  {
+    static thread_local io_multiplexer_state_pool_cache cache;
+    return cache;
+  }
+
+  /* The completions generation at which each thread last returned from a threadsafe
+  multiplexer's check_for_any_completed_io(). A thread which reads a stale i/o status,
+  and then calls check_for_any_completed_io() after another thread has reaped and
+  completed that i/o, would otherwise sleep upon a completion which has already been
+  consumed. Comparing generations lets it return immediately instead.
+
+  This lives in each multiplexer rather than in each thread, as a thread may pump any
+  number of multiplexers (e.g. stealing from every member of a group). Not thread safe,
+  callers hold the multiplexer's lock.
+  */
+  class io_multiplexer_completions_seen
+  {
+    struct entry
+    {
+      std::thread::id thread;
+      uint64_t generation{0};
+    };
+    // Threads come and go, so bound the memory of ones which have gone
+    static constexpr size_t _max_entries = 256;
+    std::vector<entry> _entries;
+
+  public:
+    // True if this thread has seen `generation`, or has never been seen at all
+    bool seen(uint64_t generation) const noexcept
+    {
+      const auto id = std::this_thread::get_id();
+      for(const auto &e : _entries)
+      {
+        if(e.thread == id)
+        {
+          return e.generation == generation;
+        }
+      }
+      return true;
+    }
+    void record(uint64_t generation) noexcept
+    {
+      const auto id = std::this_thread::get_id();
+      for(auto &e : _entries)
+      {
+        if(e.thread == id)
+        {
+          e.generation = generation;
+          return;
+        }
+      }
+      if(_entries.size() >= _max_entries)
+      {
+        // Forget the thread which has gone longest without checking, which is most likely to have exited
+        auto it = std::min_element(_entries.begin(), _entries.end(), [](const entry &a, const entry &b) { return a.generation < b.generation; });
+        *it = {id, generation};
+        return;
+      }
+      try
+      {
+        _entries.push_back({id, generation});
+      }
+      catch(...)
+      {
+        // Being unseen only costs this thread the early return
+      }
+    }
+  };
+
+  /* A hierarchical timer wheel of i/o operation deadlines, as per Varghese & Lauck.
+  Each level has 64 slots, each slot of level N spanning 64^N ticks of roughly one
+  millisecond. Insertion and removal are O(1), and expiry is amortised O(1) per entry,
+  as an entry cascades down at most once per level. Not thread safe, callers serialise.
+  */
+  class io_multiplexer_deadline_wheel
+  {
+  public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    // Embedded into each i/o operation state which can have a deadline
+    struct node
+    {
+      node *_wheel_prev{nullptr}, *_wheel_next{nullptr};
+      uint64_t _wheel_expiry{0};  // in ticks
+      uint8_t _wheel_level{0}, _wheel_slot{0};
+      bool _wheel_linked{false};
+
+      bool is_in_deadline_wheel() const noexcept { return _wheel_linked; }
+    };
+
+  private:
+    static constexpr unsigned _tick_shift = 20;  // 2^20 nanoseconds per tick
+    static constexpr unsigned _slot_bits = 6, _slots = 1U << _slot_bits, _levels = 4;
+
+    node *_wheel[_levels][_slots]{};
+    uint64_t _occupied[_levels]{};  // bitmap of non-empty slots per level
+    uint64_t _now{0};               // the next tick to be expired
+    size_t _count{0};
+
+    // Expiries round up and the present rounds down, so nothing ever expires early
+    static uint64_t _to_ticks(time_point tp, bool round_up) noexcept
+    {
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+      return (ns <= 0) ? 0 : (((uint64_t) ns + (round_up ? (1ULL << _tick_shift) - 1 : 0)) >> _tick_shift);
+    }
+    // Index of the lowest set bit, which must exist
+    static unsigned _lowest_bit(uint64_t v) noexcept
+    {
+#ifdef _MSC_VER
+      unsigned long ret;
+      _BitScanForward64(&ret, v);
+      return (unsigned) ret;
+#else
+      return (unsigned) __builtin_ctzll(v);
+#endif
+    }
+    static time_point _from_ticks(uint64_t ticks) noexcept
+    {
+      return time_point(std::chrono::duration_cast<time_point::duration>(std::chrono::nanoseconds(ticks << _tick_shift)));
+    }
+    void _link(node *n) noexcept
+    {
+      uint64_t expiry = n->_wheel_expiry;
+      if(expiry < _now)
+      {
+        expiry = _now;
+      }
+      unsigned level = 0;
+      while(level < _levels - 1 && (expiry >> (level * _slot_bits)) - (_now >> (level * _slot_bits)) >= _slots)
+      {
+        ++level;
+      }
+      uint64_t idx = expiry >> (level * _slot_bits);
+      if(idx - (_now >> (level * _slot_bits)) >= _slots)
+      {
+        // Beyond the range of the wheel, park it in the furthest slot to be recascaded later
+        idx = (_now >> (level * _slot_bits)) + _slots - 1;
+      }
+      const unsigned slot = (unsigned) (idx & (_slots - 1));
+      n->_wheel_prev = nullptr;
+      n->_wheel_next = _wheel[level][slot];
+      if(n->_wheel_next != nullptr)
+      {
+        n->_wheel_next->_wheel_prev = n;
+      }
+      _wheel[level][slot] = n;
+      _occupied[level] |= 1ULL << slot;
+      n->_wheel_level = (uint8_t) level;
+      n->_wheel_slot = (uint8_t) slot;
+      n->_wheel_linked = true;
+    }
+    void _unlink(node *n) noexcept
+    {
+      if(n->_wheel_prev != nullptr)
+      {
+        n->_wheel_prev->_wheel_next = n->_wheel_next;
+      }
+      else
+      {
+        _wheel[n->_wheel_level][n->_wheel_slot] = n->_wheel_next;
+        if(n->_wheel_next == nullptr)
+        {
+          _occupied[n->_wheel_level] &= ~(1ULL << n->_wheel_slot);
+        }
+      }
+      if(n->_wheel_next != nullptr)
+      {
+        n->_wheel_next->_wheel_prev = n->_wheel_prev;
+      }
+      n->_wheel_prev = n->_wheel_next = nullptr;
+      n->_wheel_linked = false;
+    }
+    // Moves everything in a higher level slot into lower levels
+    void _cascade(unsigned level) noexcept
+    {
+      const unsigned slot = (unsigned) ((_now >> (level * _slot_bits)) & (_slots - 1));
+      node *n = _wheel[level][slot];
+      _wheel[level][slot] = nullptr;
+      _occupied[level] &= ~(1ULL << slot);
+      while(n != nullptr)
+      {
+        node *next = n->_wheel_next;
+        _link(n);
+        n = next;
+      }
+    }
+
+  public:
+    // Converts a deadline into a steady clock time point, time_point::max() if infinite
+    static time_point to_time_point(deadline d) noexcept
+    {
+      if(!d)
+      {
+        return time_point::max();
+      }
+      const auto now = std::chrono::steady_clock::now();
+      if(d.steady)
+      {
+        if(d.nsecs >= (unsigned long long) (time_point::max() - now).count())
+        {
+          return time_point::max();
+        }
+        return now + std::chrono::duration_cast<time_point::duration>(std::chrono::nanoseconds(d.nsecs));
+      }
+      return now + std::chrono::duration_cast<time_point::duration>(d.to_time_point() - std::chrono::system_clock::now());
+    }
+
+    bool empty() const noexcept { return _count == 0; }
+    size_t size() const noexcept { return _count; }
+
+    // Adds an entry which expires at the time point
+    void insert(node *n, time_point expiry) noexcept
+    {
+      assert(!n->_wheel_linked);
+      if(_count == 0)
+      {
+        // Nothing can be pending, so skip straight to the present
+        _now = _to_ticks(std::chrono::steady_clock::now(), false);
+      }
+      n->_wheel_expiry = _to_ticks(expiry, true);
+      _link(n);
+      ++_count;
+    }
+    // Removes an entry before it expires. Does nothing if not in the wheel.
+    void remove(node *n) noexcept
+    {
+      if(n->_wheel_linked)
+      {
+        _unlink(n);
+        --_count;
+      }
+    }
+    // Removes all entries expiring at or before the time point, calling f(node *) upon each
+    template <class F> void expire(time_point now, F &&f)
+    {
+      const uint64_t target = _to_ticks(now, false);
+      while(_count > 0 && _now <= target)
+      {
+        for(unsigned level = _levels - 1; level > 0; level--)
+        {
+          if((_now & ((1ULL << (level * _slot_bits)) - 1)) == 0)
+          {
+            _cascade(level);
+          }
+        }
+        const unsigned slot = (unsigned) (_now & (_slots - 1));
+        while(_wheel[0][slot] != nullptr)
+        {
+          node *n = _wheel[0][slot];
+          _unlink(n);
+          --_count;
+          f(n);
+        }
+        // Skip empty ticks until the next occupied level 0 slot or cascade boundary
+        const uint64_t boundary = (_now | (_slots - 1)) + 1;
+        uint64_t next = boundary;
+        const uint64_t ahead = (slot + 1 < _slots) ? (_occupied[0] & ~((2ULL << slot) - 1)) : 0;
+        if(ahead != 0)
+        {
+          next = (_now & ~(uint64_t) (_slots - 1)) + (uint64_t) _lowest_bit(ahead);
+        }
+        _now = (next > target + 1) ? target + 1 : next;
+      }
+      if(_count == 0 && _now <= target)
+      {
+        _now = target + 1;
+      }
+    }
+    // The earliest time at which expire() may have something to do, or time_point::max() if empty
+    time_point next_expiry() const noexcept
+    {
+      if(_count == 0)
+      {
+        return time_point::max();
+      }
+      uint64_t ret = (uint64_t) -1;
+      for(unsigned level = 0; level < _levels; level++)
+      {
+        if(_occupied[level] == 0)
+        {
+          continue;
+        }
+        // Rotate the bitmap so bit 0 is the slot currently due at this level
+        const unsigned shift = level * _slot_bits;
+        const unsigned cur = (unsigned) ((_now >> shift) & (_slots - 1));
+        const uint64_t rotated = (cur == 0) ? _occupied[level] : ((_occupied[level] >> cur) | (_occupied[level] << (_slots - cur)));
+        const uint64_t distance = (uint64_t) _lowest_bit(rotated);
+        const uint64_t when = (level == 0) ? (_now + distance) : (((_now >> shift) + distance) << shift);
+        ret = std::min(ret, std::max(when, _now));
+      }
+      return _from_ticks(ret);
+    }
+  };
+}  // namespace detail
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC span<byte> io_multiplexer::state_pool::acquire() noexcept
+{
+  auto *l = detail::io_multiplexer_state_pool_cache_for_this_thread().find(_bytes, _align);
+  if(l != nullptr && l->head != nullptr)
+  {
+    void *ret = l->head;
+    l->head = *static_cast<void **>(ret);
+    --l->count;
+    return {static_cast<byte *>(ret), _bytes};
+  }
+  void *ret = detail::io_multiplexer_state_pool_allocate(_bytes, _align);
+  if(ret == nullptr)
+  {
+    return {};
+  }
+  return {static_cast<byte *>(ret), _bytes};
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void io_multiplexer::state_pool::release(byte *block) noexcept
+{
+  if(block == nullptr)
+  {
+    return;
+  }
+  auto *l = detail::io_multiplexer_state_pool_cache_for_this_thread().find(_bytes, _align);
+  if(l != nullptr && l->count < max_cached)
+  {
+    *reinterpret_cast<void **>(block) = l->head;
+    l->head = block;
+    ++l->count;
+    return;
+  }
+  detail::io_multiplexer_state_pool_deallocate(block);
+}
+
 template <bool is_threadsafe> struct io_multiplexer_impl : io_multiplexer
 {
   struct _lock_impl_type
@@ -44,12 +466,331 @@ template <bool is_threadsafe> struct io_multiplexer_impl : io_multiplexer
   };
   _lock_impl_type _lock;
   using _lock_guard = std::unique_lock<_lock_impl_type>;
+  detail::io_multiplexer_deadline_wheel _deadlines;  // of i/o not yet handed to the kernel
+
+  // Only one thread ever checks, so it cannot miss completions invoked by another
+  void _completions_invoked() noexcept {}
+  bool _may_sleep() const noexcept { return true; }
+  void _checked() noexcept {}
 };
 template <> struct io_multiplexer_impl<true> : io_multiplexer
 {
   using _lock_impl_type = std::mutex;
   _lock_impl_type _lock;
   using _lock_guard = std::unique_lock<_lock_impl_type>;
+  detail::io_multiplexer_deadline_wheel _deadlines;  // of i/o not yet handed to the kernel
+  uint64_t _completions_generation{0};  // bumped under the lock after completions are invoked
+  detail::io_multiplexer_completions_seen _completions_seen;
+
+  // Call under the lock after invoking completions
+  void _completions_invoked() noexcept { ++_completions_generation; }
+  // Call under the lock before sleeping. False if completions may have been invoked since this thread last checked.
+  bool _may_sleep() const noexcept { return _completions_seen.seen(_completions_generation); }
+  // Call under the lock when returning from check_for_any_completed_io()
+  void _checked() noexcept { _completions_seen.record(_completions_generation); }
 };
 
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t io_multiplexer_group::current_index() const noexcept
+{
+#ifdef _WIN32
+  const size_t cpu = GetCurrentProcessorNumber();
+#elif defined(__linux__)
+  const int ret = sched_getcpu();
+  const size_t cpu = (ret < 0) ? 0 : (size_t) ret;
+#else
+  // No portable way of asking which CPU we are on, so spread threads round robin
+  static std::atomic<size_t> next{0};
+  static LLFIO_THREAD_LOCAL size_t cpu_ = (size_t) -1;
+  if(cpu_ == (size_t) -1)
+  {
+    cpu_ = next.fetch_add(1, std::memory_order_relaxed);
+  }
+  const size_t cpu = cpu_;
+#endif
+  return cpu % _multiplexers.size();
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<io_multiplexer_group::check_for_any_completed_io_statistics>
+io_multiplexer_group::check_for_any_completed_io(deadline d, size_t max_completions) noexcept
+{
+  LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+  const size_t mine = current_index();
+  for(;;)
+  {
+    OUTCOME_TRY(auto &&ret, _multiplexers[mine]->check_for_any_completed_io(std::chrono::seconds(0), max_completions));
+    if(ret.initiated_ios_completed > 0 || ret.initiated_ios_finished > 0)
+    {
+      return ret;
+    }
+    // Steal, starting somewhere different each time so thieves spread themselves out
+    const size_t start = _steal_cursor.fetch_add(1, std::memory_order_relaxed);
+    for(size_t n = 0; n < _multiplexers.size(); n++)
+    {
+      const size_t idx = (start + n) % _multiplexers.size();
+      if(idx == mine)
+      {
+        continue;
+      }
+      OUTCOME_TRY(ret, _multiplexers[idx]->check_for_any_completed_io(std::chrono::seconds(0), max_completions));
+      if(ret.initiated_ios_completed > 0 || ret.initiated_ios_finished > 0)
+      {
+        return ret;
+      }
+    }
+    // Nothing anywhere, so sleep upon my own multiplexer for a while
+    std::chrono::microseconds timeout;
+    LLFIO_DEADLINE_TO_PARTIAL_TIMEOUT(timeout, d);
+    if(d && timeout.count() == 0)
+    {
+      return ret;
+    }
+    if(!d || timeout > _steal_interval)
+    {
+      timeout = _steal_interval;
+    }
+    OUTCOME_TRY(ret, _multiplexers[mine]->check_for_any_completed_io(timeout, max_completions));
+    if(ret.initiated_ios_completed > 0 || ret.initiated_ios_finished > 0)
+    {
+      return ret;
+    }
+  }
+}
+
+#ifdef __linux__
+namespace detail
+{
+  /* Performs the filesystem syscalls which a multiplexer cannot have the kernel perform
+  asynchronously, such as getdents64() for which io_uring has no opcode, upon a small pool
+  of threads launched upon first use. The list of completions is nonempty if and only if
+  the eventfd is signalled, which the multiplexer sleeps upon with its other kernel objects.
+  */
+  class io_multiplexer_syscall_worker
+  {
+    using syscall_operation_kind = io_multiplexer::syscall_operation_kind;
+    using syscall_operation_state = io_multiplexer::syscall_operation_state;
+    // Enough to overlap the latencies of a networked filesystem without many idle threads
+    static constexpr size_t _max_threads = 4;
+
+    std::mutex _lock;
+    std::condition_variable _cond;
+    syscall_operation_state *_queued_first{nullptr}, *_queued_last{nullptr};
+    size_t _queued{0}, _idle{0};
+    std::atomic<syscall_operation_state *> _completed{nullptr};  // most recent first, only written with the lock held
+    std::vector<std::thread> _threads;
+    bool _stopping{false};
+    int _eventfd{-1};
+    int _notifyfd{-1};  // an additional eventfd to signal upon completion, only accessed with the lock held
+
+    static int _perform(syscall_operation_state *op) noexcept
+    {
+      if(op->lock != nullptr)
+      {
+        while(op->lock->exchange(1, std::memory_order_acquire) != 0)
+        {
+          std::this_thread::yield();
+        }
+      }
+      long ret = -1;
+      switch(op->kind)
+      {
+      case syscall_operation_kind::openat:
+        ret = ::openat(op->fd, op->path, op->flags, (mode_t) op->mode);
+        break;
+      case syscall_operation_kind::close:
+        ret = ::close(op->fd);
+        break;
+      case syscall_operation_kind::statx:
+#ifdef SYS_statx
+        ret = ::syscall(SYS_statx, op->fd, op->path, op->flags, op->mode, op->buffer);
+#else
+        errno = ENOSYS;
+#endif
+        break;
+      case syscall_operation_kind::getdents:
+        if(-1 != ::lseek64(op->fd, 0, SEEK_SET))
+        {
+          ret = ::syscall(SYS_getdents64, op->fd, op->buffer, op->mode);
+        }
+        break;
+      }
+      const int errcode = errno;
+      if(op->lock != nullptr)
+      {
+        op->lock->store(0, std::memory_order_release);
+      }
+      return (ret < 0) ? -errcode : (int) ret;
+    }
+
+    void _run() noexcept
+    {
+      std::unique_lock<std::mutex> g(_lock);
+      for(;;)
+      {
+        while(_queued_first == nullptr && !_stopping)
+        {
+          ++_idle;
+          _cond.wait(g);
+          --_idle;
+        }
+        // Anything queued is performed before stopping, so file descriptors are closed
+        if(_queued_first == nullptr)
+        {
+          return;
+        }
+        auto *op = _queued_first;
+        _queued_first = op->_next;
+        if(_queued_first == nullptr)
+        {
+          _queued_last = nullptr;
+        }
+        --_queued;
+        g.unlock();
+        op->result = _perform(op);
+        g.lock();
+        op->_next = _completed.load(std::memory_order_relaxed);
+        _completed.store(op, std::memory_order_relaxed);
+        (void) ::eventfd_write(_eventfd, 1);
+        if(_notifyfd != -1)
+        {
+          (void) ::eventfd_write(_notifyfd, 1);
+        }
+      }
+    }
+
+  public:
+    io_multiplexer_syscall_worker() = default;
+    io_multiplexer_syscall_worker(const io_multiplexer_syscall_worker &) = delete;
+    io_multiplexer_syscall_worker(io_multiplexer_syscall_worker &&) = delete;
+    io_multiplexer_syscall_worker &operator=(const io_multiplexer_syscall_worker &) = delete;
+    io_multiplexer_syscall_worker &operator=(io_multiplexer_syscall_worker &&) = delete;
+    ~io_multiplexer_syscall_worker()
+    {
+      {
+        std::lock_guard<std::mutex> g(_lock);
+        _stopping = true;
+      }
+      _cond.notify_all();
+      for(auto &t : _threads)
+      {
+        t.join();
+      }
+      if(_eventfd != -1)
+      {
+        ::close(_eventfd);
+      }
+    }
+    result<void> init() noexcept
+    {
+      _eventfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if(-1 == _eventfd)
+      {
+        return posix_error();
+      }
+      return success();
+    }
+    // The eventfd signalled when syscalls have completed
+    int fd() const noexcept { return _eventfd; }
+    // Sets an additional eventfd to signal when syscalls have completed, or -1 for none.
+    // Upon return the previous one will not be signalled again, so it can be closed.
+    void set_notify_fd(int fd) noexcept
+    {
+      std::lock_guard<std::mutex> g(_lock);
+      _notifyfd = fd;
+    }
+    // True if syscalls have completed which have yet to be reaped
+    bool has_completed() const noexcept { return _completed.load(std::memory_order_relaxed) != nullptr; }
+
+    result<void> submit(syscall_operation_state *op) noexcept
+    {
+      std::lock_guard<std::mutex> g(_lock);
+      if(_queued >= _idle && _threads.size() < _max_threads)
+      {
+        try
+        {
+          _threads.emplace_back([this] { _run(); });
+        }
+        catch(...)
+        {
+          // Any existing threads will get to it eventually
+          if(_threads.empty())
+          {
+            return error_from_exception();
+          }
+        }
+      }
+      op->_next = nullptr;
+      if(_queued_last == nullptr)
+      {
+        _queued_first = op;
+      }
+      else
+      {
+        _queued_last->_next = op;
+      }
+      _queued_last = op;
+      ++_queued;
+      _cond.notify_one();
+      return success();
+    }
+
+    // Returns the syscalls completed since the last call, most recent first. Performs no
+    // syscall if there are none.
+    syscall_operation_state *reap() noexcept
+    {
+      if(_completed.load(std::memory_order_relaxed) == nullptr)
+      {
+        return nullptr;
+      }
+      std::lock_guard<std::mutex> g(_lock);
+      eventfd_t v;
+      (void) ::eventfd_read(_eventfd, &v);
+      auto *ret = _completed.load(std::memory_order_relaxed);
+      _completed.store(nullptr, std::memory_order_relaxed);
+      return ret;
+    }
+  };
+
+  template <class F> inline result<io_multiplexer_group_ptr> make_io_multiplexer_group(size_t cpus, F &&make) noexcept
+  {
+    try
+    {
+      if(cpus == 0)
+      {
+        cpus = std::max(1U, std::thread::hardware_concurrency());
+      }
+      std::vector<io_multiplexer_ptr> multiplexers;
+      multiplexers.reserve(cpus);
+      for(size_t n = 0; n < cpus; n++)
+      {
+        // Other threads steal, so each multiplexer must be threadsafe
+        OUTCOME_TRY(auto &&m, make());
+        multiplexers.push_back(std::move(m));
+      }
+      return io_multiplexer_group_ptr(new io_multiplexer_group(std::move(multiplexers)));
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+}  // namespace detail
+
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_group_ptr> multiplexer_group_linux_io_uring(size_t cpus, bool is_polling) noexcept
+{
+  return detail::make_io_multiplexer_group(cpus, [&] { return multiplexer_linux_io_uring(2, is_polling); });
+}
+
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_group_ptr> multiplexer_group_linux_io_uring(size_t cpus, const multiplexer_linux_io_uring_config &config) noexcept
+{
+  auto config_ = config;
+  config_.threads = std::max(config_.threads, (size_t) 2);
+  return detail::make_io_multiplexer_group(cpus, [&] { return multiplexer_linux_io_uring(config_); });
+}
+
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_group_ptr> multiplexer_group_linux_epoll(size_t cpus) noexcept
+{
+  return detail::make_io_multiplexer_group(cpus, [&] { return multiplexer_linux_epoll(2); });
+}
+#endif
+
 LLFIO_V2_NAMESPACE_END
@@ -0,0 +1,269 @@
+/* A background prefetcher for a mapped handle to a file
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../mapped_file_handle.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace detail
+{
+  struct mapped_file_handle_prefetcher
+  {
+    using extent_type = mapped_file_handle::extent_type;
+    using size_type = mapped_file_handle::size_type;
+    using buffer_type = map_handle::buffer_type;
+
+    const mapped_file_handle::prefetcher_config config;
+
+    // The access pattern state, guarded by state_lock as read() may be called concurrently
+    std::mutex state_lock;
+    enum class pattern_t
+    {
+      unknown,
+      sequential,
+      strided
+    } pattern{pattern_t::unknown};
+    extent_type last_offset{0}, last_end{0}, stride{0};
+    size_type hits{0};
+    extent_type prefetched_to{0};  // everything before this has been prefetched
+    extent_type dropped_to{0};     // everything before this has been dropped
+    mapped_file_handle::prefetcher_stats stats;
+
+    // Shared with the helper thread. Regions are addresses into the map at the time of
+    // queuing, and may be stale by the time the helper thread gets to them. As prefetch is
+    // only ever a hint which cannot alter memory contents, that is harmless.
+    std::mutex lock;
+    std::condition_variable changed;
+    std::vector<buffer_type> pending;
+    bool done{false};
+    std::thread thread;
+
+    explicit mapped_file_handle_prefetcher(mapped_file_handle::prefetcher_config _config)
+        : config(_config)
+    {
+      pending.reserve(64);
+      thread = std::thread([this] { run(); });
+    }
+    mapped_file_handle_prefetcher(const mapped_file_handle_prefetcher &) = delete;
+    mapped_file_handle_prefetcher(mapped_file_handle_prefetcher &&) = delete;
+    mapped_file_handle_prefetcher &operator=(const mapped_file_handle_prefetcher &) = delete;
+    mapped_file_handle_prefetcher &operator=(mapped_file_handle_prefetcher &&) = delete;
+    ~mapped_file_handle_prefetcher()
+    {
+      {
+        std::lock_guard<std::mutex> g(lock);
+        done = true;
+      }
+      changed.notify_all();
+      thread.join();
+    }
+
+    void run() noexcept
+    {
+      std::vector<buffer_type> todo;
+      todo.reserve(64);
+      std::unique_lock<std::mutex> g(lock);
+      for(;;)
+      {
+        changed.wait(g, [this] { return done || !pending.empty(); });
+        if(done)
+        {
+          return;
+        }
+        todo.swap(pending);
+        g.unlock();
+        for(auto &region : todo)
+        {
+          (void) map_handle::prefetch(region);
+        }
+        todo.clear();
+        g.lock();
+      }
+    }
+
+    void post(byte *addr, extent_type offset, size_type bytes) noexcept
+    {
+      {
+        std::lock_guard<std::mutex> g(lock);
+        if(pending.size() == pending.capacity())
+        {
+          // The helper thread is falling behind, so the oldest windows are probably already consumed
+          pending.erase(pending.begin());
+        }
+        pending.push_back({addr + offset, bytes});
+      }
+      changed.notify_one();
+      stats.windows_prefetched++;
+      stats.bytes_prefetched += bytes;
+    }
+  };
+
+  void mapped_file_handle_prefetcher_deleter::operator()(mapped_file_handle_prefetcher *p) const noexcept { delete p; }
+}  // namespace detail
+
+result<void> mapped_file_handle::enable_prefetcher(prefetcher_config config) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(config.window == 0 || config.windows_ahead == 0)
+  {
+    return errc::invalid_argument;
+  }
+  config.window = utils::round_up_to_page_size(config.window, utils::page_size());
+  try
+  {
+    _prefetcher.reset();
+    _prefetcher.reset(new detail::mapped_file_handle_prefetcher(config));
+    return success();
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
+void mapped_file_handle::disable_prefetcher() noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  _prefetcher.reset();
+}
+
+mapped_file_handle::prefetcher_stats mapped_file_handle::prefetcher_statistics() const noexcept
+{
+  if(!_prefetcher)
+  {
+    return {};
+  }
+  std::lock_guard<std::mutex> g(_prefetcher->state_lock);
+  return _prefetcher->stats;
+}
+
+void mapped_file_handle::touch(extent_type offset, size_type bytes) noexcept
+{
+  if(!_prefetcher || bytes == 0)
+  {
+    return;
+  }
+  auto &p = *_prefetcher;
+  std::lock_guard<std::mutex> g(p.state_lock);
+  using pattern_t = detail::mapped_file_handle_prefetcher::pattern_t;
+  const extent_type end = offset + bytes;
+  if(offset >= p.last_offset && offset <= p.last_end)
+  {
+    // Contiguous with, or overlapping, the previous access
+    if(p.pattern != pattern_t::sequential)
+    {
+      p.pattern = pattern_t::sequential;
+      p.hits = 0;
+      p.prefetched_to = 0;
+    }
+    p.hits++;
+  }
+  else if(offset > p.last_end)
+  {
+    const extent_type stride = offset - p.last_offset;
+    if(p.pattern != pattern_t::strided || stride != p.stride)
+    {
+      p.pattern = pattern_t::strided;
+      p.stride = stride;
+      p.hits = 0;
+      p.prefetched_to = 0;
+    }
+    p.hits++;
+  }
+  else
+  {
+    // Backwards, so random as far as we are concerned
+    p.pattern = pattern_t::unknown;
+    p.hits = 0;
+    p.prefetched_to = 0;
+    p.dropped_to = offset;
+  }
+  p.last_offset = offset;
+  p.last_end = end;
+  const extent_type length = _mh.length();
+  if(p.hits < p.config.trigger || end >= length)
+  {
+    return;
+  }
+  byte *addr = _mh.address();
+  if(addr == nullptr)
+  {
+    return;
+  }
+  const extent_type window = p.config.window;
+  if(p.pattern == pattern_t::sequential)
+  {
+    if(p.prefetched_to < end)
+    {
+      // Either just triggered, or the scan has overtaken the prefetched windows
+      p.prefetched_to = utils::round_down_to_page_size(end, utils::page_size());
+    }
+    const extent_type want = std::min(end + p.config.windows_ahead * window, length);
+    while(p.prefetched_to < want)
+    {
+      const size_type thiswindow = static_cast<size_type>(std::min(window, length - p.prefetched_to));
+      p.post(addr, p.prefetched_to, thiswindow);
+      p.prefetched_to += thiswindow;
+    }
+    if(p.config.drop_consumed && offset >= p.dropped_to + 2 * window)
+    {
+      // Keep one window behind the scan in case the caller looks back a little
+      const extent_type dropto = utils::round_down_to_page_size(offset - window, utils::page_size());
+      _prefetcher_drop(p.dropped_to, static_cast<size_type>(dropto - p.dropped_to));
+      p.stats.bytes_dropped += static_cast<size_type>(dropto - p.dropped_to);
+      p.dropped_to = dropto;
+    }
+  }
+  else if(p.pattern == pattern_t::strided)
+  {
+    // Prefetch the next few records, each rounded out to whole pages
+    if(p.prefetched_to < end)
+    {
+      p.prefetched_to = end;
+    }
+    for(size_type n = 1; n <= p.config.windows_ahead; n++)
+    {
+      const extent_type next = offset + n * p.stride;
+      if(next + bytes > length)
+      {
+        break;
+      }
+      if(next + bytes <= p.prefetched_to)
+      {
+        continue;
+      }
+      const extent_type start = utils::round_down_to_page_size(next, utils::page_size());
+      const extent_type stop = std::min(utils::round_up_to_page_size(next + bytes, utils::page_size()), length);
+      p.post(addr, start, static_cast<size_type>(stop - start));
+      p.prefetched_to = next + bytes;
+    }
+  }
+}
+
+LLFIO_V2_NAMESPACE_END
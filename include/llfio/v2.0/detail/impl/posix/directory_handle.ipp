@@ -175,6 +175,77 @@ opened:
   return ret;
 }
 
+bool directory_handle::_co_directory_op::prepare(io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if(_creation != creation::open_existing || (flags & flag::unlink_on_first_close))
+  {
+    // Creating directories takes further syscalls, and directory() reports the failure
+    return false;
+  }
+  nativeh.behaviour |= native_handle_type::disposition::directory;
+  // POSIX does not permit directory opens with O_RDWR like Windows, so silently convert to read
+  if(_mode == mode::attr_write)
+  {
+    _mode = mode::attr_read;
+  }
+  else if(_mode == mode::write || _mode == mode::append)
+  {
+    _mode = mode::read;
+  }
+  auto attribs = attribs_from_handle_mode_caching_and_flags(nativeh, _mode, _creation, _caching, flags);
+  if(!attribs)
+  {
+    return false;
+  }
+  nativeh.behaviour &= ~native_handle_type::disposition::nonblocking;
+  nativeh.behaviour &= ~native_handle_type::disposition::seekable;  // not seekable
+  int oflags = attribs.value() & ~O_NONBLOCK;
+#ifdef O_DIRECTORY
+  oflags |= O_DIRECTORY;
+#endif
+#ifdef O_SEARCH
+  oflags |= O_SEARCH;
+#endif
+  zpath.emplace((base->is_valid() && path.empty()) ? path_view_type(".") : path, path_view::zero_terminated);
+  s.kind = io_multiplexer::syscall_operation_kind::openat;
+  s.fd = base->is_valid() ? base->native_handle().fd : AT_FDCWD;
+  s.path = zpath->buffer;
+  s.flags = oflags;
+  s.mode = 0;
+  return true;
+}
+
+result<directory_handle> directory_handle::_co_directory_op::finish(const io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if(s.result < 0)
+  {
+    return posix_error(-s.result);
+  }
+  nativeh.fd = s.result;
+  result<directory_handle> ret(directory_handle(nativeh, 0, 0, _caching, flags));
+  if(!(flags & flag::disable_safety_unlinks))
+  {
+    if(!ret.value()._fetch_inode())
+    {
+      // If fetching inode failed e.g. were opening device, disable safety unlinks
+      ret.value()._flags &= ~flag::disable_safety_unlinks;
+    }
+  }
+  if(ret.value().are_safety_barriers_issued())
+  {
+    fsync(nativeh.fd);
+  }
+  return ret;
+}
+
+void directory_handle::_co_directory_op::discard(const io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if(s.result >= 0)
+  {
+    ::close(s.result);
+  }
+}
+
 result<directory_handle> directory_handle::reopen(mode mode_, caching caching_, deadline d) const noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
@@ -358,7 +429,6 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
     req.buffers._kernel_buffer = std::unique_ptr<char[]>(mem);
     req.buffers._kernel_buffer_size = toallocate;
   }
-  stat_t::want default_stat_contents = stat_t::want::ino | stat_t::want::type;
   dirent *buffer;
   size_t bytesavailable;
   int bytes;
@@ -405,6 +475,15 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
       done = true;
     }
   } while(!done);
+  return _fill_buffers(req, zglob.buffer, buffer, bytes);
+}
+
+result<directory_handle::buffers_type> directory_handle::_fill_buffers(io_request<buffers_type> &req, const char *zglob, const void *dirents, int bytes) noexcept
+{
+#ifdef __linux__
+  using dirent = dirent64;
+#endif
+  stat_t::want default_stat_contents = stat_t::want::ino | stat_t::want::type;
   if(bytes == 0)
   {
     req.buffers._resize(0);
@@ -412,9 +491,10 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
     req.buffers._done = true;
     return std::move(req.buffers);
   }
+  auto *buffer = static_cast<const dirent *>(dirents);
   LLFIO_VALGRIND_MAKE_MEM_DEFINED_IF_ADDRESSABLE(buffer, bytes);  // NOLINT
   size_t n = 0;
-  for(dirent *dent = buffer;; dent = reinterpret_cast<dirent *>(reinterpret_cast<uintptr_t>(dent) + dent->d_reclen))
+  for(const dirent *dent = buffer;; dent = reinterpret_cast<const dirent *>(reinterpret_cast<uintptr_t>(dent) + dent->d_reclen))
   {
     if(dent->d_ino != 0u)
     {
@@ -426,7 +506,7 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
           goto cont;
         }
       }
-      if(!req.glob.empty() && fnmatch(zglob.buffer, dent->d_name, 0) != 0)
+      if(!req.glob.empty() && fnmatch(zglob, dent->d_name, 0) != 0)
       {
         goto cont;
       }
@@ -484,4 +564,51 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
   }
 }
 
+bool directory_handle::_co_read_op::prepare(io_multiplexer::syscall_operation_state &s) noexcept
+{
+#ifdef __linux__
+  if(req.buffers.empty() || (!req.glob.empty() && !req.glob.contains_glob()))
+  {
+    // Nothing to do, or really a stat call, which read() does
+    return false;
+  }
+  if(!req.buffers._kernel_buffer && req.kernelbuffer.empty())
+  {
+    // As read(), let's assume the average leafname will be 64 characters long.
+    size_t toallocate = (sizeof(dirent64) + 64) * req.buffers.size();
+    auto *mem = (char *) operator new[](toallocate, std::nothrow);  // don't initialise
+    if(mem == nullptr)
+    {
+      return false;
+    }
+    req.buffers._kernel_buffer = std::unique_ptr<char[]>(mem);
+    req.buffers._kernel_buffer_size = toallocate;
+  }
+  s.kind = io_multiplexer::syscall_operation_kind::getdents;
+  s.fd = h->native_handle().fd;
+  s.buffer = req.kernelbuffer.empty() ? static_cast<void *>(req.buffers._kernel_buffer.get()) : static_cast<void *>(req.kernelbuffer.data());
+  s.mode = (unsigned) (req.kernelbuffer.empty() ? req.buffers._kernel_buffer_size : req.kernelbuffer.size());
+  s.lock = &h->_lock;
+  return true;
+#else
+  (void) s;
+  return false;
+#endif
+}
+
+result<directory_handle::buffers_type> directory_handle::_co_read_op::finish(const io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if(s.result < 0)
+  {
+    if(-EINVAL == s.result && req.kernelbuffer.empty())
+    {
+      // The kernel buffer is too small for even one entry, which read() enlarges until it is not
+      return synchronous();
+    }
+    return posix_error(-s.result);
+  }
+  path_view_type::c_str<> zglob(req.glob, path_view::zero_terminated);
+  return _fill_buffers(req, zglob.buffer, s.buffer, s.result);
+}
+
 LLFIO_V2_NAMESPACE_END
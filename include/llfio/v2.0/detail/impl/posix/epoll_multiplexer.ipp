@@ -0,0 +1,1033 @@
+/* Multiplex file i/o
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../../io_handle.hpp"
+
+#if !LLFIO_INCLUDED_BY_HEADER || !defined(LLFIO_IO_HANDLE_H)
+#error This file should never be included directly
+#endif
+
+#ifndef __linux__
+#error This implementation file is for Linux only
+#endif
+
+#include <algorithm>
+#include <climits>  // for IOV_MAX
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "quickcpplib/signal_guard.hpp"
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+/* epoll is a readiness notification API, not a completion notification API, so
+this i/o multiplexer emulates completions on top of readiness:
+
+- Handles are registered edge triggered for both input and output readiness, once
+for their lifetime within the multiplexer. There are thus no `epoll_ctl()` calls
+per i/o, which is the main cost of level triggered or one shot designs.
+
+- Upon initiation, the i/o is attempted immediately. If it does not return EAGAIN,
+the i/o is complete and finished before initiation returns.
+
+- Otherwise the i/o is appended to a per-handle queue of reads or writes, unless it
+has `io_flag::nowait`, in which case it completes with EAGAIN. When epoll
+reports an edge on the handle, the appropriate queue is drained in order until either
+it is empty, or the kernel returns EAGAIN, which rearms the edge.
+
+- Reads of scatter-gather lists longer than IOV_MAX fill only the first IOV_MAX buffers.
+Writes of them are attempted in batches of IOV_MAX buffers, and complete with a short write
+if a later batch would block.
+
+- epoll cannot be used with regular files or directories, and those handles never
+block in the sense of returning EAGAIN anyway. So seekable handles, handles without
+a kernel file descriptor, and handles which do their i/o in user space, have their
+i/o performed synchronously upon initiation, as does blocking i/o. This is the same
+as the io_uring multiplexer does for user space handles.
+
+- An eventfd registered level triggered within the epoll set implements
+`wake_check_for_any_completed_io()`, and waking any other threads sleeping within
+`check_for_any_completed_io()` when a thread completes i/o upon which they may be
+waiting.
+
+- epoll cannot perform filesystem syscalls, so those of `init_syscall_operation()` are
+performed upon the threads of a syscall worker, whose eventfd is also registered level
+triggered within the epoll set.
+
+- `completion_notification_handle()` returns the epoll set itself, as it is readable
+exactly when it has readiness to report. Readiness consumed but left unprocessed due to
+`max_completions` keeps the eventfd signalled. Deadlines are otherwise enforced only by
+the timeout of a sleeping check, so a timerfd armed to the earliest deadline is added
+to the epoll set level triggered.
+*/
+template <bool is_threadsafe> class linux_epoll_multiplexer final : public io_multiplexer_impl<is_threadsafe>
+{
+  using _base = io_multiplexer_impl<is_threadsafe>;
+  using _multiplexer_lock_guard = typename _base::_lock_guard;
+
+  using path_type = typename _base::path_type;
+  using extent_type = typename _base::extent_type;
+  using size_type = typename _base::size_type;
+  using mode = typename _base::mode;
+  using creation = typename _base::creation;
+  using caching = typename _base::caching;
+  using flag = typename _base::flag;
+  using barrier_kind = typename _base::barrier_kind;
+  using const_buffers_type = typename _base::const_buffers_type;
+  using buffers_type = typename _base::buffers_type;
+  using registered_buffer_type = typename _base::registered_buffer_type;
+  template <class T> using io_request = typename _base::template io_request<T>;
+  using io_flag = typename _base::io_flag;
+  template <class T> using io_result = typename _base::template io_result<T>;
+  using io_operation_state = typename _base::io_operation_state;
+  using io_operation_state_visitor = typename _base::io_operation_state_visitor;
+  using check_for_any_completed_io_statistics = typename _base::check_for_any_completed_io_statistics;
+  using syscall_operation_state = typename _base::syscall_operation_state;
+
+  struct _epoll_operation_state final : public std::conditional_t<is_threadsafe, typename _base::_synchronised_io_operation_state, typename _base::_unsynchronised_io_operation_state>,
+                                        public detail::io_multiplexer_deadline_wheel::node
+  {
+    using _impl = std::conditional_t<is_threadsafe, typename _base::_synchronised_io_operation_state, typename _base::_unsynchronised_io_operation_state>;
+
+    _epoll_operation_state *prev{nullptr}, *next{nullptr};
+    ssize_t res{0};  // bytes transferred, or negative errno
+    io_operation_state_type initiated{io_operation_state_type::unknown};
+    bool is_queued{false};
+    bool cancel_requested{false};  // cancelled while initiated but not yet queued
+
+    _epoll_operation_state() = default;
+    // Construct implicitly from the base implementation, see relocate_to()
+    explicit _epoll_operation_state(_impl &&o) noexcept
+        : _impl(std::move(o))
+    {
+    }
+    using _impl::_impl;
+
+    virtual io_operation_state *relocate_to(byte *to_) noexcept override
+    {
+      auto *to = _impl::relocate_to(to_);
+      // restamp the vptr with my own
+      auto _to = new(to) _epoll_operation_state(std::move(*static_cast<_impl *>(to)));
+      _to->res = res;
+      _to->initiated = initiated;
+      return _to;
+    }
+  };
+  // An intrusive list of i/o operation states
+  struct _queue_t
+  {
+    _epoll_operation_state *first{nullptr}, *last{nullptr};
+
+    void push_back(_epoll_operation_state *state) noexcept
+    {
+      assert(state->prev == nullptr);
+      assert(state->next == nullptr);
+      state->prev = last;
+      if(last == nullptr)
+      {
+        first = state;
+      }
+      else
+      {
+        last->next = state;
+      }
+      last = state;
+    }
+    void remove(_epoll_operation_state *state) noexcept
+    {
+      if(state->prev == nullptr)
+      {
+        assert(first == state);
+        first = state->next;
+      }
+      else
+      {
+        state->prev->next = state->next;
+      }
+      if(state->next == nullptr)
+      {
+        assert(last == state);
+        last = state->prev;
+      }
+      else
+      {
+        state->next->prev = state->prev;
+      }
+      state->next = state->prev = nullptr;
+    }
+  };
+  // Per registered handle state, implementing the per-handle queues
+  struct _registered_fd
+  {
+    int fd{-1};
+    _queue_t reads, writes;
+    // Readiness reported by epoll but not yet consumed due to max_completions
+    bool read_ready{false}, write_ready{false};
+
+    explicit _registered_fd(int _fd)
+        : fd(_fd)
+    {
+    }
+  };
+
+  int _eventfd{-1};
+  detail::io_multiplexer_syscall_worker _syscall_worker;
+  std::vector<_registered_fd> _registered_fds;  // sorted by fd
+  std::vector<int> _ready_fds;                  // fds with unconsumed readiness
+  int _wakecount{0};
+  size_t _sleepers{0};      // threads sleeping within check_for_any_completed_io()
+  bool _eventfd_set{false};  // the eventfd is signalled
+  int _timerfd{-1};          // if completion_notification_handle() was called
+  std::chrono::steady_clock::time_point _timerfd_expiry{std::chrono::steady_clock::time_point::max()};
+
+  typename std::vector<_registered_fd>::iterator _registered_fd_lower_bound(int fd) noexcept
+  {
+    return std::lower_bound(_registered_fds.begin(), _registered_fds.end(), fd, [](const _registered_fd &a, int b) { return a.fd < b; });
+  }
+  _registered_fd *_find_registered_fd(int fd) noexcept
+  {
+    auto it = _registered_fd_lower_bound(fd);
+    if(it == _registered_fds.end() || it->fd != fd)
+    {
+      return nullptr;
+    }
+    return &*it;
+  }
+
+  // Signals the eventfd, waking anybody sleeping in epoll_wait(). Must be called with the lock held.
+  result<void> _signal_eventfd() noexcept
+  {
+    if(!_eventfd_set)
+    {
+      if(-1 == ::eventfd_write(_eventfd, 1))
+      {
+        return posix_error();
+      }
+      _eventfd_set = true;
+    }
+    return success();
+  }
+  // Resets the eventfd. Must be called with the lock held.
+  void _reset_eventfd() noexcept
+  {
+    if(_eventfd_set)
+    {
+      eventfd_t v;
+      (void) ::eventfd_read(_eventfd, &v);
+      _eventfd_set = false;
+    }
+  }
+  // Signals the eventfd if readiness was consumed but not processed, or wakes are owed,
+  // so the epoll set remains readable. Must be called with the lock held.
+  result<void> _renotify_if_unprocessed() noexcept
+  {
+    if(!_ready_fds.empty() || _wakecount > 0)
+    {
+      return _signal_eventfd();
+    }
+    return success();
+  }
+
+  // Arms the timerfd to just after the earliest deadline in the timer wheel, as per the
+  // timeout of a sleeping check. Rearming also resets an expired timerfd. Must be called
+  // with the lock held.
+  void _arm_timerfd(std::chrono::steady_clock::time_point now) noexcept
+  {
+    auto next = this->_deadlines.next_expiry();
+    if(next != std::chrono::steady_clock::time_point::max())
+    {
+      next += std::chrono::milliseconds(1);
+    }
+    if(next == _timerfd_expiry && next > now)
+    {
+      return;
+    }
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if(next != std::chrono::steady_clock::time_point::max())
+    {
+      // steady_clock is CLOCK_MONOTONIC
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(next.time_since_epoch()).count();
+      its.it_value.tv_sec = (time_t)(ns / 1000000000);
+      its.it_value.tv_nsec = (long) (ns % 1000000000);
+    }
+    (void) ::timerfd_settime(_timerfd, TFD_TIMER_ABSTIME, &its, nullptr);
+    _timerfd_expiry = next;
+  }
+
+  // Attempts the i/o. Returns false if the handle is not ready.
+  static bool _attempt(_epoll_operation_state *state) noexcept
+  {
+    auto &nc = state->payload.noncompleted;
+    const int fd = state->h->native_handle().fd;
+    ssize_t ret = 0;
+    switch(state->initiated)
+    {
+    case io_operation_state_type::read_initiated:
+    case io_operation_state_type::read_initialised:
+      // A short read is legitimate, so buffers beyond IOV_MAX are left unfilled
+      ret = ::readv(fd, reinterpret_cast<struct iovec *>(nc.params.read.reqs.buffers.data()), (int) std::min(nc.params.read.reqs.buffers.size(), (size_t) IOV_MAX));
+      break;
+    default:
+    {
+      // Lists longer than IOV_MAX are written in batches, for so long as each batch is written entirely
+      const auto *iov = reinterpret_cast<const struct iovec *>(nc.params.write.reqs.buffers.data());
+      const size_t iovcnt = nc.params.write.reqs.buffers.size();
+      for(size_t done = 0;;)
+      {
+        const size_t count = std::min(iovcnt - done, (size_t) IOV_MAX);
+        // Can't guarantee that user code hasn't enabled SIGPIPE
+        const ssize_t written = QUICKCPPLIB_NAMESPACE::signal_guard::signal_guard(
+        QUICKCPPLIB_NAMESPACE::signal_guard::signalc_set::broken_pipe, [&] { return ::writev(fd, iov + done, (int) count); },
+        [&](const QUICKCPPLIB_NAMESPACE::signal_guard::raised_signal_info * /*unused*/) {
+          errno = EPIPE;
+          return (ssize_t) -1;
+        });
+        if(written < 0)
+        {
+          // Report what the earlier batches wrote
+          ret = (ret > 0) ? ret : written;
+          break;
+        }
+        ret += written;
+        size_t bytes = 0;
+        for(size_t n = done; n < done + count; n++)
+        {
+          bytes += iov[n].iov_len;
+        }
+        done += count;
+        if(done >= iovcnt || (size_t) written < bytes)
+        {
+          break;
+        }
+      }
+      break;
+    }
+    }
+    if(ret < 0)
+    {
+      if(EAGAIN == errno || EWOULDBLOCK == errno)
+      {
+        return false;
+      }
+      ret = -errno;
+    }
+    state->res = ret;
+    return true;
+  }
+  // Completes queued i/o in order until the handle is not ready. Returns false if out of completions budget.
+  bool _drain(_queue_t &q, _epoll_operation_state **out, size_t &count, size_t max) noexcept
+  {
+    while(q.first != nullptr)
+    {
+      if(count == max)
+      {
+        return false;
+      }
+      auto *state = q.first;
+      if(!_attempt(state))
+      {
+        break;
+      }
+      q.remove(state);
+      state->is_queued = false;
+      this->_deadlines.remove(state);
+      out[count++] = state;
+    }
+    return true;
+  }
+  // Drains any readiness for the handle. Must be called with the lock held.
+  void _process_ready(_registered_fd *rfd, _epoll_operation_state **out, size_t &count, size_t max) noexcept
+  {
+    if(rfd->read_ready)
+    {
+      rfd->read_ready = !_drain(rfd->reads, out, count, max);
+    }
+    if(rfd->write_ready)
+    {
+      rfd->write_ready = !_drain(rfd->writes, out, count, max);
+    }
+    if(rfd->read_ready || rfd->write_ready)
+    {
+      if(std::find(_ready_fds.begin(), _ready_fds.end(), rfd->fd) == _ready_fds.end())
+      {
+        // Reserved upon registration, so cannot throw
+        _ready_fds.push_back(rfd->fd);
+      }
+    }
+  }
+
+  template <class BuffersType> static io_result<BuffersType> _result_from_bytes(BuffersType buffers, ssize_t res) noexcept
+  {
+    if(res < 0)
+    {
+      return posix_error((int) -res);
+    }
+    auto bytes = static_cast<size_type>(res);
+    for(size_t i = 0; i < buffers.size(); i++)
+    {
+      auto &buffer = buffers[i];
+      if(buffer.size() <= bytes)
+      {
+        bytes -= buffer.size();
+      }
+      else
+      {
+        buffer = {buffer.data(), bytes};
+        buffers = {buffers.data(), i + 1};
+        break;
+      }
+    }
+    return {buffers};
+  }
+  static io_operation_state_type _read_finish(_epoll_operation_state *state, io_result<buffers_type> &&res) noexcept
+  {
+    state->read_completed(std::move(res));
+    state->read_finished();
+    return io_operation_state_type::read_finished;
+  }
+  static io_operation_state_type _write_finish(_epoll_operation_state *state, io_result<const_buffers_type> &&res) noexcept
+  {
+    state->write_completed(std::move(res));
+    state->write_or_barrier_finished();
+    return io_operation_state_type::write_or_barrier_finished;
+  }
+  static io_operation_state_type _barrier_finish(_epoll_operation_state *state, io_result<const_buffers_type> &&res) noexcept
+  {
+    state->barrier_completed(std::move(res));
+    state->write_or_barrier_finished();
+    return io_operation_state_type::write_or_barrier_finished;
+  }
+  // Invokes the visitor with the result of the i/o. Must be called without the lock held.
+  static io_operation_state_type _complete(_epoll_operation_state *state) noexcept
+  {
+    auto &nc = state->payload.noncompleted;
+    if(state->initiated == io_operation_state_type::read_initiated)
+    {
+      return _read_finish(state, _result_from_bytes(nc.params.read.reqs.buffers, state->res));
+    }
+    return _write_finish(state, _result_from_bytes(nc.params.write.reqs.buffers, state->res));
+  }
+
+public:
+  constexpr linux_epoll_multiplexer() {}
+  linux_epoll_multiplexer(const linux_epoll_multiplexer &) = delete;
+  linux_epoll_multiplexer(linux_epoll_multiplexer &&) = delete;
+  linux_epoll_multiplexer &operator=(const linux_epoll_multiplexer &) = delete;
+  linux_epoll_multiplexer &operator=(linux_epoll_multiplexer &&) = delete;
+  virtual ~linux_epoll_multiplexer()
+  {
+    if(this->_v)
+    {
+      (void) linux_epoll_multiplexer::close();
+    }
+  }
+  result<void> init(size_t threads)
+  {
+    (void) threads;
+    this->_v.fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if(-1 == this->_v.fd)
+    {
+      return posix_error();
+    }
+    this->_v.behaviour |= native_handle_type::disposition::multiplexer;
+    _eventfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(-1 == _eventfd)
+    {
+      auto ret = posix_error();
+      (void) close();
+      return ret;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;  // level triggered
+    ev.data.fd = _eventfd;
+    if(-1 == ::epoll_ctl(this->_v.fd, EPOLL_CTL_ADD, _eventfd, &ev))
+    {
+      auto ret = posix_error();
+      (void) close();
+      return ret;
+    }
+    auto r = _syscall_worker.init();
+    if(!r)
+    {
+      (void) close();
+      return r;
+    }
+    ev.data.fd = _syscall_worker.fd();
+    if(-1 == ::epoll_ctl(this->_v.fd, EPOLL_CTL_ADD, _syscall_worker.fd(), &ev))
+    {
+      auto ret = posix_error();
+      (void) close();
+      return ret;
+    }
+    return success();
+  }
+
+  // These functions are inherited from handle
+  virtual result<path_type> current_path() const noexcept override
+  {
+    return success();  // empty path, means it has been deleted
+  }
+  virtual result<void> close() noexcept override
+  {
+    // handle::close() would refuse to close a multiplexer
+    if(_eventfd != -1)
+    {
+      ::close(_eventfd);
+      _eventfd = -1;
+    }
+    if(_timerfd != -1)
+    {
+      ::close(_timerfd);
+      _timerfd = -1;
+    }
+    if(this->_v.fd != -1)
+    {
+      if(-1 == ::close(this->_v.fd))
+      {
+        return posix_error();
+      }
+    }
+    this->_v = native_handle_type();
+    _registered_fds.clear();
+    _ready_fds.clear();
+    return success();
+  }
+
+  virtual result<uint8_t> do_io_handle_register(io_handle *h) noexcept override
+  {
+    const auto nativeh = h->native_handle();
+    // Handles which epoll cannot or need not wait upon get their i/o performed
+    // synchronously upon initiation. We flag these using _multiplexer_state_bit0.
+    if(nativeh.fd == -1 || nativeh.is_seekable() || !nativeh.is_nonblocking() || this->do_io_handle_max_buffers(h) == 0)
+    {
+      return (uint8_t) 1;
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    try
+    {
+      auto it = _registered_fd_lower_bound(nativeh.fd);
+      if(it != _registered_fds.end() && it->fd == nativeh.fd)
+      {
+        return errc::device_or_resource_busy;
+      }
+      _ready_fds.reserve(_registered_fds.size() + 1);
+      struct epoll_event ev;
+      memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+      ev.data.fd = nativeh.fd;
+      if(-1 == ::epoll_ctl(this->_v.fd, EPOLL_CTL_ADD, nativeh.fd, &ev))
+      {
+        return posix_error();
+      }
+      _registered_fds.insert(it, _registered_fd(nativeh.fd));
+    }
+    catch(...)
+    {
+      (void) ::epoll_ctl(this->_v.fd, EPOLL_CTL_DEL, nativeh.fd, nullptr);
+      return error_from_exception();
+    }
+    return (uint8_t) 0;
+  }
+  virtual result<void> do_io_handle_deregister(io_handle *h) noexcept override
+  {
+    const auto nativeh = h->native_handle();
+    if((nativeh.behaviour & native_handle_type::disposition::_multiplexer_state_bit0) != 0)
+    {
+      return success();
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    auto it = _registered_fd_lower_bound(nativeh.fd);
+    if(it != _registered_fds.end() && it->fd == nativeh.fd)
+    {
+      if(it->reads.first != nullptr || it->writes.first != nullptr)
+      {
+        return errc::operation_in_progress;
+      }
+      if(-1 == ::epoll_ctl(this->_v.fd, EPOLL_CTL_DEL, nativeh.fd, nullptr))
+      {
+        return posix_error();
+      }
+      _registered_fds.erase(it);
+      auto it2 = std::find(_ready_fds.begin(), _ready_fds.end(), nativeh.fd);
+      if(it2 != _ready_fds.end())
+      {
+        _ready_fds.erase(it2);
+      }
+    }
+    return success();
+  }
+
+  virtual std::pair<size_t, size_t> io_state_requirements() noexcept override { return {sizeof(_epoll_operation_state), alignof(_epoll_operation_state)}; }
+
+  virtual io_operation_state *construct(span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor, registered_buffer_type &&b, deadline d, io_request<buffers_type> reqs) noexcept override
+  {
+    assert(storage.size() >= sizeof(_epoll_operation_state));
+    assert(((uintptr_t) storage.data() % alignof(_epoll_operation_state)) == 0);
+    if(storage.size() < sizeof(_epoll_operation_state) || ((uintptr_t) storage.data() % alignof(_epoll_operation_state)) != 0)
+    {
+      return nullptr;
+    }
+    return new(storage.data()) _epoll_operation_state(_h, _visitor, std::move(b), d, std::move(reqs));
+  }
+  virtual io_operation_state *construct(span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor, registered_buffer_type &&b, deadline d, io_request<const_buffers_type> reqs) noexcept override
+  {
+    assert(storage.size() >= sizeof(_epoll_operation_state));
+    assert(((uintptr_t) storage.data() % alignof(_epoll_operation_state)) == 0);
+    if(storage.size() < sizeof(_epoll_operation_state) || ((uintptr_t) storage.data() % alignof(_epoll_operation_state)) != 0)
+    {
+      return nullptr;
+    }
+    return new(storage.data()) _epoll_operation_state(_h, _visitor, std::move(b), d, std::move(reqs));
+  }
+  virtual io_operation_state *construct(span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor, registered_buffer_type &&b, deadline d, io_request<const_buffers_type> reqs, barrier_kind kind) noexcept override
+  {
+    assert(storage.size() >= sizeof(_epoll_operation_state));
+    assert(((uintptr_t) storage.data() % alignof(_epoll_operation_state)) == 0);
+    if(storage.size() < sizeof(_epoll_operation_state) || ((uintptr_t) storage.data() % alignof(_epoll_operation_state)) != 0)
+    {
+      return nullptr;
+    }
+    return new(storage.data()) _epoll_operation_state(_h, _visitor, std::move(b), d, std::move(reqs), kind);
+  }
+
+  virtual io_operation_state_type init_io_operation(io_operation_state *_op) noexcept override
+  {
+    auto *state = static_cast<_epoll_operation_state *>(_op);
+    auto s = state->current_state();
+    auto &nc = state->payload.noncompleted;
+    const auto nativeh = state->h->native_handle();
+    if((nativeh.behaviour & native_handle_type::disposition::_multiplexer_state_bit0) != 0)
+    {
+      // This handle cannot be usefully multiplexed, so do the i/o synchronously now
+      switch(s)
+      {
+      case io_operation_state_type::read_initialised:
+        return _read_finish(state, _base::_do_io_handle_read(state->h, std::move(nc.base), nc.params.read.reqs, nc.d));
+      case io_operation_state_type::write_initialised:
+        return _write_finish(state, _base::_do_io_handle_write(state->h, std::move(nc.base), nc.params.write.reqs, nc.d));
+      case io_operation_state_type::barrier_initialised:
+        return _barrier_finish(state, _base::_do_io_handle_barrier(state->h, nc.params.barrier.reqs, nc.params.barrier.kind, nc.d));
+      default:
+        assert(false);
+        return s;
+      }
+    }
+    bool is_read;
+    switch(s)
+    {
+    case io_operation_state_type::read_initialised:
+      is_read = true;
+      break;
+    case io_operation_state_type::write_initialised:
+      is_read = false;
+      break;
+    case io_operation_state_type::barrier_initialised:
+      return _barrier_finish(state, io_result<const_buffers_type>(const_buffers_type()));  // nothing was flushed
+    default:
+      assert(false);
+      return s;
+    }
+    state->initiated = is_read ? io_operation_state_type::read_initiated : io_operation_state_type::write_initiated;
+    state->cancel_requested = false;
+    const auto expiry = detail::io_multiplexer_deadline_wheel::to_time_point(nc.d);
+    {
+      _multiplexer_lock_guard g(this->_lock);
+      auto *rfd = _find_registered_fd(nativeh.fd);
+      assert(rfd != nullptr);
+      // Only attempt the i/o if it would not overtake i/o already queued
+      if((is_read ? rfd->reads : rfd->writes).first == nullptr && _attempt(state))
+      {
+        g.unlock();
+        return _complete(state);
+      }
+      if((is_read ? nc.params.read.reqs.flags : nc.params.write.reqs.flags) & io_flag::nowait)
+      {
+        // The i/o would block, or would have to wait behind i/o which would
+        state->res = -EAGAIN;
+        g.unlock();
+        return _complete(state);
+      }
+    }
+    // Invoke the visitor before taking the multiplexer lock, as it may call into the multiplexer
+    if(is_read)
+    {
+      state->read_initiated();
+    }
+    else
+    {
+      state->write_initiated();
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    if(state->cancel_requested)
+    {
+      // Cancelled after the visitor was invoked above, but before the i/o could be queued
+      g.unlock();
+      if(is_read)
+      {
+        return _read_finish(state, io_result<buffers_type>(errc::operation_canceled));
+      }
+      return _write_finish(state, io_result<const_buffers_type>(errc::operation_canceled));
+    }
+    auto *rfd = _find_registered_fd(nativeh.fd);
+    auto &q = is_read ? rfd->reads : rfd->writes;
+    q.push_back(state);
+    state->is_queued = true;
+    // The edge may have fired after the attempt above, in which case nobody will drain
+    // this queue, so retry now that the i/o is visible to epoll processing
+    if(q.first == state && _attempt(state))
+    {
+      q.remove(state);
+      state->is_queued = false;
+      g.unlock();
+      return _complete(state);
+    }
+    if(expiry != std::chrono::steady_clock::time_point::max())
+    {
+      this->_deadlines.insert(state, expiry);
+      if(_timerfd != -1 && expiry + std::chrono::milliseconds(1) < _timerfd_expiry)
+      {
+        _arm_timerfd(std::chrono::steady_clock::now());
+      }
+    }
+    return state->initiated;
+  }
+
+  virtual result<void> flush_inited_io_operations() noexcept override
+  {
+    // All i/o is initiated immediately
+    return success();
+  }
+
+  virtual io_operation_state_type check_io_operation(io_operation_state *_op) noexcept override
+  {
+    auto s = _op->current_state();
+    if(is_initiated(s))
+    {
+      (void) check_for_any_completed_io(std::chrono::seconds(0));
+      s = _op->current_state();
+    }
+    return s;
+  }
+
+  virtual result<io_operation_state_type> cancel_io_operation(io_operation_state *_op, deadline d = {}) noexcept override
+  {
+    (void) d;
+    auto *state = static_cast<_epoll_operation_state *>(_op);
+    // Read the state before taking the multiplexer lock, as visitors can call into
+    // the multiplexer with the state lock held
+    const auto s = state->current_state();
+    if(!is_initiated(s))
+    {
+      return s;
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    if(!state->is_queued)
+    {
+      // Either being completed by another thread right now, or init_io_operation() has
+      // invoked the visitor but not yet queued the i/o. In the latter case, it will see
+      // this and complete the i/o as cancelled instead of queuing it.
+      state->cancel_requested = true;
+      return s;
+    }
+    auto *rfd = _find_registered_fd(state->h->native_handle().fd);
+    assert(rfd != nullptr);
+    (s == io_operation_state_type::read_initiated ? rfd->reads : rfd->writes).remove(state);
+    state->is_queued = false;
+    this->_deadlines.remove(state);
+    g.unlock();
+    if(s == io_operation_state_type::read_initiated)
+    {
+      return _read_finish(state, io_result<buffers_type>(errc::operation_canceled));
+    }
+    return _write_finish(state, io_result<const_buffers_type>(errc::operation_canceled));
+  }
+
+  virtual result<void> init_syscall_operation(syscall_operation_state *op) noexcept override { return _syscall_worker.submit(op); }
+
+  virtual result<check_for_any_completed_io_statistics> check_for_any_completed_io(deadline d = std::chrono::seconds(0), size_t max_completions = (size_t) -1) noexcept override
+  {
+    LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+    check_for_any_completed_io_statistics ret;
+    _epoll_operation_state *completed[64];
+    struct epoll_event events[64];
+    bool slept = false;
+    while(max_completions > 0)
+    {
+      // How long to sleep for if nothing has completed, zero means don't sleep
+      int mstimeout = -1;
+      if(d)
+      {
+        std::chrono::microseconds timeout;
+        LLFIO_DEADLINE_TO_PARTIAL_TIMEOUT(timeout, d);
+        mstimeout = (int) ((timeout.count() + 999) / 1000);
+      }
+      const size_t max = std::min(max_completions, (size_t) 64);
+      size_t count = 0;
+      _queue_t timedout;
+      syscall_operation_state *syscalls = nullptr;
+      bool may_sleep;
+      {
+        _multiplexer_lock_guard g(this->_lock);
+        if(slept)
+        {
+          --_sleepers;
+        }
+        may_sleep = this->_may_sleep();
+        this->_checked();
+        // If another kernel thread woke me, exit the loop
+        if(_wakecount > 0)
+        {
+          --_wakecount;
+          break;
+        }
+        if(_timerfd != -1 && _sleepers == 0)
+        {
+          // Nobody needs the eventfd to wake them, so clear any leftover readiness it notified
+          _reset_eventfd();
+        }
+        syscalls = _syscall_worker.reap();
+        // Readiness left over from last time takes priority
+        for(size_t n = 0; n < _ready_fds.size() && count < max;)
+        {
+          auto *rfd = _find_registered_fd(_ready_fds[n]);
+          _ready_fds.erase(_ready_fds.begin() + n);
+          if(rfd != nullptr)
+          {
+            _process_ready(rfd, completed, count, max);
+          }
+        }
+        if(!this->_deadlines.empty())
+        {
+          // Queued i/o past its deadline is removed from its queue, and fails
+          const auto now = std::chrono::steady_clock::now();
+          this->_deadlines.expire(now, [&](detail::io_multiplexer_deadline_wheel::node *n) {
+            auto *state = static_cast<_epoll_operation_state *>(n);
+            auto *rfd = _find_registered_fd(state->h->native_handle().fd);
+            assert(rfd != nullptr);
+            (state->initiated == io_operation_state_type::read_initiated ? rfd->reads : rfd->writes).remove(state);
+            state->is_queued = false;
+            state->res = -ETIMEDOUT;
+            timedout.push_back(state);
+          });
+          const auto next = this->_deadlines.next_expiry();
+          if(next != std::chrono::steady_clock::time_point::max())
+          {
+            const int wheelms = (int) std::min<int64_t>(INT_MAX, std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1));
+            if(mstimeout < 0 || wheelms < mstimeout)
+            {
+              mstimeout = wheelms;
+            }
+          }
+        }
+        if(_timerfd != -1)
+        {
+          _arm_timerfd(std::chrono::steady_clock::now());
+          if(count > 0)
+          {
+            OUTCOME_TRY(_renotify_if_unprocessed());
+          }
+        }
+      }
+      if(count == 0)
+      {
+        const int nevents = ::epoll_wait(this->_v.fd, events, (int) max, 0);
+        if(-1 == nevents && EINTR != errno)
+        {
+          return posix_error();
+        }
+        _multiplexer_lock_guard g(this->_lock);
+        for(int n = 0; n < nevents; n++)
+        {
+          auto *rfd = _find_registered_fd(events[n].data.fd);
+          if(rfd == nullptr)
+          {
+            continue;  // an eventfd, or a handle just deregistered
+          }
+          if((events[n].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0)
+          {
+            rfd->read_ready = true;
+          }
+          if((events[n].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0)
+          {
+            rfd->write_ready = true;
+          }
+          _process_ready(rfd, completed, count, max);
+        }
+        if(!may_sleep || !this->_may_sleep())
+        {
+          // Another thread may have completed what my caller is waiting upon since it last
+          // looked, and that completion has been consumed, so return for it to recheck
+          mstimeout = 0;
+        }
+        this->_checked();
+        if(_timerfd != -1)
+        {
+          OUTCOME_TRY(_renotify_if_unprocessed());
+        }
+        if(count == 0 && timedout.first == nullptr && syscalls == nullptr && !slept && mstimeout != 0)
+        {
+          // Anybody woken for whom the eventfd was signalled has now woken, so reset it
+          if(_sleepers == 0)
+          {
+            _reset_eventfd();
+          }
+          ++_sleepers;
+        }
+      }
+      for(size_t n = 0; n < count; n++)
+      {
+        (void) _complete(completed[n]);
+        ++ret.initiated_ios_finished;
+      }
+      while(timedout.first != nullptr)
+      {
+        auto *state = timedout.first;
+        timedout.remove(state);
+        (void) _complete(state);
+        ++ret.initiated_ios_finished;
+        ++count;
+      }
+      while(syscalls != nullptr)
+      {
+        auto *op = syscalls;
+        syscalls = op->_next;
+        op->_next = nullptr;
+        op->completed(op);  // may destroy op
+        ++ret.initiated_ios_finished;
+        ++count;
+      }
+      if(count > 0)
+      {
+        if(is_threadsafe)
+        {
+          // Any i/o just completed may be what another thread is sleeping upon, and
+          // we consumed the readiness which would have woken it, so wake it
+          _multiplexer_lock_guard g(this->_lock);
+          this->_completions_invoked();
+          this->_checked();
+          if(_sleepers > 0)
+          {
+            OUTCOME_TRY(_signal_eventfd());
+          }
+        }
+        break;
+      }
+      // Having slept once, return so the caller can recheck whatever it is waiting upon
+      if(slept || mstimeout == 0)
+      {
+        break;
+      }
+      // Sleep until epoll has readiness to report. Readiness is consumed upon the next loop.
+      const int nevents = ::epoll_wait(this->_v.fd, events, 1, mstimeout);
+      slept = true;
+      if(1 == nevents && events[0].data.fd != _eventfd)
+      {
+        // Edge triggered readiness is reported only once, so don't lose it
+        _multiplexer_lock_guard g(this->_lock);
+        auto *rfd = _find_registered_fd(events[0].data.fd);
+        if(rfd != nullptr)
+        {
+          rfd->read_ready |= ((events[0].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0);
+          rfd->write_ready |= ((events[0].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0);
+          if(std::find(_ready_fds.begin(), _ready_fds.end(), rfd->fd) == _ready_fds.end())
+          {
+            _ready_fds.push_back(rfd->fd);
+          }
+        }
+      }
+      else if(-1 == nevents && EINTR != errno)
+      {
+        const auto errcode = errno;
+        _multiplexer_lock_guard g(this->_lock);
+        --_sleepers;
+        return posix_error(errcode);
+      }
+    }
+    return ret;
+  }
+
+  virtual result<void> wake_check_for_any_completed_io() noexcept override
+  {
+    _multiplexer_lock_guard g(this->_lock);
+    ++_wakecount;
+    return _signal_eventfd();
+  }
+
+  virtual result<native_handle_type> completion_notification_handle() noexcept override
+  {
+    _multiplexer_lock_guard g(this->_lock);
+    if(_timerfd == -1)
+    {
+      const int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+      if(-1 == fd)
+      {
+        return posix_error();
+      }
+      struct epoll_event ev;
+      memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN;  // level triggered
+      ev.data.fd = fd;
+      if(-1 == ::epoll_ctl(this->_v.fd, EPOLL_CTL_ADD, fd, &ev))
+      {
+        auto ret = posix_error();
+        ::close(fd);
+        return ret;
+      }
+      _timerfd = fd;
+      _arm_timerfd(std::chrono::steady_clock::now());
+      // Readiness already consumed would otherwise never be notified
+      OUTCOME_TRY(_renotify_if_unprocessed());
+    }
+    return native_handle_type(native_handle_type::disposition::readable | native_handle_type::disposition::multiplexer, this->_v.fd);
+  }
+};
+
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_epoll(size_t threads) noexcept
+{
+  try
+  {
+    if(1 == threads)
+    {
+      auto ret = std::make_unique<linux_epoll_multiplexer<false>>();
+      OUTCOME_TRY(ret->init(1));
+      return io_multiplexer_ptr(ret.release());
+    }
+    auto ret = std::make_unique<linux_epoll_multiplexer<true>>();
+    OUTCOME_TRY(ret->init(threads));
+    return io_multiplexer_ptr(ret.release());
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
+LLFIO_V2_NAMESPACE_END
@@ -26,6 +26,8 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "import.hpp"
 
+#include <sys/mman.h>
+
 #if defined(__FreeBSD__) || defined(__APPLE__)
 #include <sys/socket.h>
 #include <sys/syscall.h>
@@ -41,6 +43,33 @@ Distributed under the Boost Software License, Version 1.0.
 
 LLFIO_V2_NAMESPACE_BEGIN
 
+// Applies those flags which take effect after the open, common to file() and co_file()
+static inline result<void> file_handle_opened(file_handle &fh, file_handle::creation _creation, file_handle::flag flags) noexcept
+{
+  const int fd = fh.native_handle().fd;
+  if((flags & file_handle::flag::disable_prefetching) || (flags & file_handle::flag::maximum_prefetching))
+  {
+#ifdef POSIX_FADV_SEQUENTIAL
+    int advice = (flags & file_handle::flag::disable_prefetching) ? POSIX_FADV_RANDOM : (POSIX_FADV_SEQUENTIAL | POSIX_FADV_WILLNEED);
+    if(-1 == ::posix_fadvise(fd, 0, 0, advice))
+    {
+      return posix_error();
+    }
+#elif __APPLE__
+    int advice = (flags & file_handle::flag::disable_prefetching) ? 0 : 1;
+    if(-1 == ::fcntl(fd, F_RDAHEAD, advice))
+    {
+      return posix_error();
+    }
+#endif
+  }
+  if(_creation == file_handle::creation::truncate_existing && fh.are_safety_barriers_issued())
+  {
+    fsync(fd);
+  }
+  return success();
+}
+
 result<file_handle> file_handle::file(const path_handle &base, file_handle::path_view_type path, file_handle::mode _mode, file_handle::creation _creation,
                                       file_handle::caching _caching, file_handle::flag flags) noexcept
 {
@@ -90,29 +119,79 @@ result<file_handle> file_handle::file(const path_handle &base, file_handle::path
     }
     return posix_error();
   }
-  if((flags & flag::disable_prefetching) || (flags & flag::maximum_prefetching))
+  OUTCOME_TRY(file_handle_opened(ret.value(), _creation, flags));
+  return ret;
+}
+
+bool file_handle::_co_file_op::prepare(io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if((mode::write == _mode || mode::append == _mode) && creation::always_new == _creation)
   {
-#ifdef POSIX_FADV_SEQUENTIAL
-    int advice = (flags & flag::disable_prefetching) ? POSIX_FADV_RANDOM : (POSIX_FADV_SEQUENTIAL | POSIX_FADV_WILLNEED);
-    if(-1 == ::posix_fadvise(nativeh.fd, 0, 0, advice))
-    {
-      return posix_error();
-    }
-#elif __APPLE__
-    int advice = (flags & flag::disable_prefetching) ? 0 : 1;
-    if(-1 == ::fcntl(nativeh.fd, F_RDAHEAD, advice))
-    {
-      return posix_error();
-    }
-#endif
+    // Replacing an existing file takes many syscalls
+    return false;
   }
-  if(_creation == creation::truncate_existing && ret.value().are_safety_barriers_issued())
+  nativeh.behaviour |= native_handle_type::disposition::file;
+  auto attribs = attribs_from_handle_mode_caching_and_flags(nativeh, _mode, _creation, _caching, flags);
+  if(!attribs)
   {
-    fsync(nativeh.fd);
+    // Have synchronous() report the failure
+    return false;
   }
+  nativeh.behaviour &= ~native_handle_type::disposition::nonblocking;
+  zpath.emplace(path, path_view::zero_terminated);
+  s.kind = io_multiplexer::syscall_operation_kind::openat;
+  s.fd = base->is_valid() ? base->native_handle().fd : AT_FDCWD;
+  s.path = zpath->buffer;
+  s.flags = attribs.value() & ~O_NONBLOCK;
+  s.mode = 0x1b0 /*660*/;
+  return true;
+}
+
+result<file_handle> file_handle::_co_file_op::finish(const io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if(s.result < 0)
+  {
+    return posix_error(-s.result);
+  }
+  nativeh.fd = s.result;
+  result<file_handle> ret(file_handle(nativeh, 0, 0, _caching, flags, nullptr));
+  OUTCOME_TRY(file_handle_opened(ret.value(), _creation, flags));
   return ret;
 }
 
+void file_handle::_co_file_op::discard(const io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if(s.result >= 0)
+  {
+    ::close(s.result);
+  }
+}
+
+bool file_handle::_co_close_op::prepare(io_multiplexer::syscall_operation_state &s) noexcept
+{
+  // Unlinking and safety barriers take further syscalls
+  if(!h->is_valid() || (h->_flags & flag::unlink_on_first_close) || (h->are_safety_barriers_issued() && h->is_writable()))
+  {
+    return false;
+  }
+  if(h->_ctx != nullptr && !h->set_multiplexer(nullptr))
+  {
+    return false;
+  }
+  s.kind = io_multiplexer::syscall_operation_kind::close;
+  s.fd = h->release().fd;
+  return true;
+}
+
+result<void> file_handle::_co_close_op::finish(const io_multiplexer::syscall_operation_state &s) noexcept
+{
+  if(s.result < 0)
+  {
+    return posix_error(-s.result);
+  }
+  return success();
+}
+
 result<file_handle> file_handle::temp_inode(const path_handle &dirh, mode _mode, flag flags) noexcept
 {
   caching _caching = caching::temporary;
@@ -433,6 +512,132 @@ result<std::vector<file_handle::extent_pair>> file_handle::extents() const noexc
   }
 }
 
+result<std::vector<file_handle::extent_pair>> file_handle::cached_extents(extent_pair extent) const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  try
+  {
+    std::vector<file_handle::extent_pair> out;
+    OUTCOME_TRY(auto &&length, file_handle::maximum_extent());
+    if(extent.offset == (extent_type) -1 && extent.length == (extent_type) -1)
+    {
+      extent.offset = 0;
+      extent.length = length;
+    }
+    if(extent.offset >= length)
+    {
+      return out;
+    }
+    const size_t pagesize = utils::page_size();
+    extent_type start = utils::round_down_to_page_size(extent.offset, pagesize);
+    // Results are whole pages, except that none may extend past the extent asked for, or the end of the file
+    const extent_type stop = (extent.length > length - extent.offset) ? length : extent.offset + extent.length;
+    const extent_type end = utils::round_up_to_page_size(stop, pagesize);
+    if(start >= end)
+    {
+      return out;
+    }
+#ifdef __linux__
+    {
+      // cachestat() (Linux 6.5 onwards) cheaply answers the common cases of all or nothing cached
+      struct cachestat_range_t
+      {
+        uint64_t off, len;
+      } range{start, end - start};
+      struct cachestat_t
+      {
+        uint64_t nr_cache, nr_dirty, nr_writeback, nr_evicted, nr_recently_evicted;
+      } cs{};
+#ifdef __alpha__
+      const long ret = syscall(561 /*__NR_cachestat*/, _v.fd, &range, &cs, 0);
+#else
+      const long ret = syscall(451 /*__NR_cachestat*/, _v.fd, &range, &cs, 0);
+#endif
+      if(ret == 0)
+      {
+        if(cs.nr_cache == 0)
+        {
+          return out;
+        }
+        if(cs.nr_cache >= (end - start) / pagesize)
+        {
+          out.emplace_back(start, stop - start);
+          return out;
+        }
+      }
+    }
+    if(!is_writable())
+    {
+      // Since Linux 5.0, mincore() only reports page cache residency for files we own or could
+      // write, otherwise it reports only pages mapped into this process, which would be none
+      struct stat s
+      {
+      };
+      if(-1 == ::fstat(_v.fd, &s))
+      {
+        return posix_error();
+      }
+      const uid_t euid = ::geteuid();
+      if(euid != 0 && s.st_uid != euid)
+      {
+        return errc::permission_denied;
+      }
+    }
+#endif
+    // Map the file without access permissions a chunk at a time, and ask which pages are resident
+    static constexpr extent_type chunk = 256 * 1024 * 1024;
+#ifdef __linux__
+    unsigned char vec[4096];
+#else
+    char vec[4096];
+#endif
+    for(extent_type offset = start; offset < end; offset += chunk)
+    {
+      const size_t thischunk = static_cast<size_t>(std::min(chunk, end - offset));
+      void *addr = ::mmap(nullptr, thischunk, PROT_NONE, MAP_SHARED, _v.fd, offset);
+      if(MAP_FAILED == addr)
+      {
+        return posix_error();
+      }
+      for(size_t n = 0; n < thischunk; n += sizeof(vec) * pagesize)
+      {
+        const size_t thisbytes = std::min(thischunk - n, sizeof(vec) * pagesize);
+        if(-1 == ::mincore(static_cast<char *>(addr) + n, thisbytes, vec))
+        {
+          auto ret = posix_error();
+          ::munmap(addr, thischunk);
+          return ret;
+        }
+        for(size_t i = 0; i < thisbytes / pagesize; i++)
+        {
+          if(vec[i] & 1)
+          {
+            const extent_type pageoffset = offset + n + i * pagesize;
+            if(!out.empty() && out.back().offset + out.back().length == pageoffset)
+            {
+              out.back().length += pagesize;
+            }
+            else
+            {
+              out.emplace_back(pageoffset, pagesize);
+            }
+          }
+        }
+      }
+      ::munmap(addr, thischunk);
+    }
+    if(!out.empty() && out.back().offset + out.back().length > stop)
+    {
+      out.back().length = stop - out.back().offset;
+    }
+    return out;
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
 result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::extent_pair extent, io_handle &dest_, io_handle::extent_type destoffset, deadline d,
                                                                bool force_copy_now, bool emulate_if_unsupported) noexcept
 {
@@ -367,4 +367,36 @@ result<void> fs_handle::unlink(deadline d) noexcept
   return success();
 }
 
+bool fs_handle::_co_stat_op::prepare(io_multiplexer::syscall_operation_state &s) noexcept
+{
+#ifdef __linux__
+  s.kind = io_multiplexer::syscall_operation_kind::statx;
+  s.fd = h->native_handle().fd;
+  s.path = "";
+  s.flags = AT_EMPTY_PATH | AT_NO_AUTOMOUNT | AT_SYMLINK_NOFOLLOW;
+  s.mode = stat_t::_statx_mask(wanted);
+  s.buffer = statxbuf;
+  return true;
+#else
+  (void) s;
+  return false;
+#endif
+}
+
+result<stat_t> fs_handle::_co_stat_op::finish(const io_multiplexer::syscall_operation_state &s) noexcept
+{
+#ifdef __linux__
+  if(s.result >= 0)
+  {
+    stat_t ret(nullptr);
+    (void) ret._fill_from_statx(statxbuf, wanted);
+    return ret;
+  }
+#else
+  (void) s;
+#endif
+  // stat_t::fill() falls back onto fstat() where statx() fails
+  return synchronous();
+}
+
 LLFIO_V2_NAMESPACE_END
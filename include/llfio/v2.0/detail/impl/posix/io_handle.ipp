@@ -43,6 +43,166 @@ constexpr inline void _check_iovec_match()
   static_assert(offsetof(io_handle::buffer_type, _len) == offsetof(iovec, iov_len), "buffer_type and struct iovec do not have same offset of len member");
 }
 
+namespace detail
+{
+  // The preadv2()/pwritev2() flags an i/o request needs, of those this platform knows about
+  inline int io_handle_rwf_flags(io_handle::io_priority priority, io_handle::io_flag flags, bool is_write) noexcept
+  {
+    (void) priority;
+    (void) flags;
+    (void) is_write;
+    int ret = 0;
+#ifdef RWF_HIPRI
+    if(priority.is_high())
+    {
+      // Polls for the completion of uncached i/o if the device supports it, else has no effect
+      ret |= RWF_HIPRI;
+    }
+#endif
+#ifdef RWF_NOWAIT
+    if(flags & io_handle::io_flag::nowait)
+    {
+      ret |= RWF_NOWAIT;
+    }
+#endif
+    if(is_write)
+    {
+#ifdef RWF_DSYNC
+      if(flags & io_handle::io_flag::data_sync)
+      {
+        ret |= RWF_DSYNC;
+      }
+#endif
+#ifdef RWF_SYNC
+      if(flags & io_handle::io_flag::sync)
+      {
+        ret |= RWF_SYNC;
+      }
+#endif
+#ifdef RWF_APPEND
+      if(flags & io_handle::io_flag::append)
+      {
+        ret |= RWF_APPEND;
+      }
+#endif
+    }
+    return ret;
+  }
+#if defined(__linux__) && defined(RWF_HIPRI)
+  // True if preadv2()/pwritev2() failed due to the kernel not knowing the syscall or a flag
+  inline bool io_handle_rwf_unsupported(ssize_t ret) noexcept { return ret < 0 && (ENOSYS == errno || EOPNOTSUPP == errno); }
+#endif
+  // preadv() honouring the flags of the request, emulating any the kernel cannot honour
+  inline ssize_t io_handle_preadv(int fd, const struct iovec *iov, int iovcnt, off_t offset, io_handle::io_priority priority, io_handle::io_flag flags) noexcept
+  {
+#if defined(__linux__) && defined(RWF_HIPRI)
+    const int rwf = io_handle_rwf_flags(priority, flags, false);
+    if(rwf != 0)
+    {
+      const ssize_t ret = ::preadv2(fd, iov, iovcnt, offset, rwf);
+      if(!io_handle_rwf_unsupported(ret))
+      {
+        return ret;
+      }
+    }
+#else
+    (void) priority;
+#endif
+    if(flags & io_handle::io_flag::nowait)
+    {
+      // There is no way of knowing if the read would block without doing it
+      errno = EAGAIN;
+      return -1;
+    }
+    return ::preadv(fd, iov, iovcnt, offset);
+  }
+  // pwritev() honouring the flags of the request, emulating any the kernel cannot honour
+  inline ssize_t io_handle_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t offset, io_handle::io_priority priority, io_handle::io_flag flags) noexcept
+  {
+#if defined(__linux__) && defined(RWF_HIPRI)
+    const int rwf = io_handle_rwf_flags(priority, flags, true);
+    if(rwf != 0)
+    {
+      const ssize_t ret = ::pwritev2(fd, iov, iovcnt, offset, rwf);
+      if(!io_handle_rwf_unsupported(ret))
+      {
+        return ret;
+      }
+    }
+#else
+    (void) priority;
+#endif
+    if(flags & io_handle::io_flag::nowait)
+    {
+      errno = EAGAIN;
+      return -1;
+    }
+    if(flags & io_handle::io_flag::append)
+    {
+      // Emulation could not be atomic with respect to other appends
+      errno = EOPNOTSUPP;
+      return -1;
+    }
+    const ssize_t ret = ::pwritev(fd, iov, iovcnt, offset);
+    if(ret >= 0 && ((flags & io_handle::io_flag::data_sync) || (flags & io_handle::io_flag::sync)))
+    {
+#if !defined(__FreeBSD__) && !defined(__APPLE__)  // neither of these have fdatasync()
+      if(!(flags & io_handle::io_flag::sync))
+      {
+        return (-1 == ::fdatasync(fd)) ? -1 : ret;
+      }
+#endif
+      return (-1 == ::fsync(fd)) ? -1 : ret;
+    }
+    return ret;
+  }
+  // Returns one if a non-seekable handle is ready for i/o of the kind so the i/o won't block,
+  // zero if it is not, and -1 with errno set upon failure
+  inline int io_handle_is_ready(int fd, short events) noexcept
+  {
+    pollfd p;
+    memset(&p, 0, sizeof(p));
+    p.fd = fd;
+    p.events = events | POLLERR;
+    return ::poll(&p, 1, 0);
+  }
+  // The number of bytes a scatter-gather list would transfer
+  inline size_t io_handle_bytes(const struct iovec *iov, size_t iovcnt) noexcept
+  {
+    size_t ret = 0;
+    for(size_t n = 0; n < iovcnt; n++)
+    {
+      ret += iov[n].iov_len;
+    }
+    return ret;
+  }
+  // Issues seekable i/o upon a scatter-gather list of any length as a sequence of batches of at
+  // most IOV_MAX buffers, stopping at the first batch transferring less than it asked for.
+  // f(iov, iovcnt, transferred) issues one batch, where transferred is the bytes transferred so far.
+  // A failure after some batches succeeded is reported as a short transfer.
+  template <class F> inline ssize_t io_handle_batched(const struct iovec *iov, size_t iovcnt, F &&f) noexcept
+  {
+    ssize_t ret = 0;
+    size_t done = 0;
+    do
+    {
+      const size_t count = std::min(iovcnt - done, static_cast<size_t>(IOV_MAX));
+      const ssize_t bytes = f(iov + done, static_cast<int>(count), ret);
+      if(bytes < 0)
+      {
+        return (ret > 0) ? ret : bytes;
+      }
+      ret += bytes;
+      if(static_cast<size_t>(bytes) < io_handle_bytes(iov + done, count))
+      {
+        break;
+      }
+      done += count;
+    } while(done < iovcnt);
+    return ret;
+  }
+}  // namespace detail
+
 size_t io_handle::_do_max_buffers() const noexcept
 {
   static size_t v;
@@ -73,10 +233,6 @@ io_handle::io_result<io_handle::buffers_type> io_handle::_do_read(io_handle::io_
   {
     return errc::not_supported;
   }
-  if(reqs.buffers.size() > IOV_MAX)
-  {
-    return errc::argument_list_too_long;
-  }
   LLFIO_POSIX_DEADLINE_TO_SLEEP_INIT(d);
 #if 0
   struct iovec *iov = (struct iovec *) alloca(reqs.buffers.size() * sizeof(struct iovec));
@@ -110,7 +266,9 @@ io_handle::io_result<io_handle::buffers_type> io_handle::_do_read(io_handle::io_
       offset += iov[n].iov_len;
     }
 #else
-    bytesread = ::preadv(_v.fd, iov, reqs.buffers.size(), reqs.offset);
+    bytesread = detail::io_handle_batched(iov, reqs.buffers.size(), [&](const struct iovec *batch, int count, ssize_t transferred) {
+      return detail::io_handle_preadv(_v.fd, batch, count, reqs.offset + transferred, reqs.priority, reqs.flags);
+    });
 #endif
     if(bytesread < 0)
     {
@@ -119,12 +277,25 @@ io_handle::io_result<io_handle::buffers_type> io_handle::_do_read(io_handle::io_
   }
   else
   {
+    if((reqs.flags & io_flag::nowait) && !_v.is_nonblocking())
+    {
+      const int ready = detail::io_handle_is_ready(_v.fd, POLLIN);
+      if(ready < 0)
+      {
+        return posix_error();
+      }
+      if(ready == 0)
+      {
+        return errc::resource_unavailable_try_again;
+      }
+    }
     do
     {
-      bytesread = ::readv(_v.fd, iov, reqs.buffers.size());
+      // A short read is legitimate for non-seekable handles, so buffers beyond IOV_MAX are left unfilled
+      bytesread = ::readv(_v.fd, iov, static_cast<int>(std::min(reqs.buffers.size(), static_cast<size_t>(IOV_MAX))));
       if(bytesread <= 0)
       {
-        if(bytesread < 0 && EWOULDBLOCK != errno && EAGAIN != errno)
+        if(bytesread < 0 && ((EWOULDBLOCK != errno && EAGAIN != errno) || (reqs.flags & io_flag::nowait)))
         {
           return posix_error();
         }
@@ -169,10 +340,6 @@ io_handle::io_result<io_handle::const_buffers_type> io_handle::_do_write(io_hand
   {
     return errc::not_supported;
   }
-  if(reqs.buffers.size() > IOV_MAX)
-  {
-    return errc::argument_list_too_long;
-  }
   LLFIO_POSIX_DEADLINE_TO_SLEEP_INIT(d);
 #if 0
   struct iovec *iov = (struct iovec *) alloca(reqs.buffers.size() * sizeof(struct iovec));
@@ -206,7 +373,9 @@ io_handle::io_result<io_handle::const_buffers_type> io_handle::_do_write(io_hand
       offset += iov[n].iov_len;
     }
 #else
-    byteswritten = ::pwritev(_v.fd, iov, reqs.buffers.size(), reqs.offset);
+    byteswritten = detail::io_handle_batched(iov, reqs.buffers.size(), [&](const struct iovec *batch, int count, ssize_t transferred) {
+      return detail::io_handle_pwritev(_v.fd, batch, count, reqs.offset + transferred, reqs.priority, reqs.flags);
+    });
 #endif
     if(byteswritten < 0)
     {
@@ -215,37 +384,70 @@ io_handle::io_result<io_handle::const_buffers_type> io_handle::_do_write(io_hand
   }
   else
   {
-    do
+    if((reqs.flags & io_flag::nowait) && !_v.is_nonblocking())
     {
-      // Can't guarantee that user code hasn't enabled SIGPIPE
-      byteswritten = QUICKCPPLIB_NAMESPACE::signal_guard::signal_guard(
-      QUICKCPPLIB_NAMESPACE::signal_guard::signalc_set::broken_pipe, [&] { return ::writev(_v.fd, iov, reqs.buffers.size()); },
-      [&](const QUICKCPPLIB_NAMESPACE::signal_guard::raised_signal_info * /*unused*/) {
-        errno = EPIPE;
-        return -1;
-      });
-      if(byteswritten <= 0)
+      const int ready = detail::io_handle_is_ready(_v.fd, POLLOUT);
+      if(ready < 0)
       {
-        if(byteswritten < 0 && EWOULDBLOCK != errno && EAGAIN != errno)
-        {
-          return posix_error();
-        }
-        if(!d || !d.steady || d.nsecs != 0)
+        return posix_error();
+      }
+      if(ready == 0)
+      {
+        return errc::resource_unavailable_try_again;
+      }
+    }
+    // Lists longer than IOV_MAX are written in batches, for so long as each batch is written entirely
+    for(size_t done = 0;;)
+    {
+      const size_t count = std::min(reqs.buffers.size() - done, static_cast<size_t>(IOV_MAX));
+      ssize_t written = 0;
+      do
+      {
+        // Can't guarantee that user code hasn't enabled SIGPIPE
+        written = QUICKCPPLIB_NAMESPACE::signal_guard::signal_guard(
+        QUICKCPPLIB_NAMESPACE::signal_guard::signalc_set::broken_pipe, [&] { return ::writev(_v.fd, iov + done, static_cast<int>(count)); },
+        [&](const QUICKCPPLIB_NAMESPACE::signal_guard::raised_signal_info * /*unused*/) {
+          errno = EPIPE;
+          return -1;
+        });
+        if(written <= 0)
         {
-          LLFIO_POSIX_DEADLINE_TO_SLEEP_LOOP(d);
-          int mstimeout = (timeout == nullptr) ? -1 : (timeout->tv_sec * 1000 + timeout->tv_nsec / 1000000LL);
-          pollfd p;
-          memset(&p, 0, sizeof(p));
-          p.fd = _v.fd;
-          p.events = POLLOUT | POLLERR;
-          if(-1 == ::poll(&p, 1, mstimeout))
+          if(written < 0 && byteswritten > 0)
+          {
+            // Report what the earlier batches wrote
+            break;
+          }
+          if(written < 0 && ((EWOULDBLOCK != errno && EAGAIN != errno) || (reqs.flags & io_flag::nowait)))
           {
             return posix_error();
           }
+          if(!d || !d.steady || d.nsecs != 0)
+          {
+            LLFIO_POSIX_DEADLINE_TO_SLEEP_LOOP(d);
+            int mstimeout = (timeout == nullptr) ? -1 : (timeout->tv_sec * 1000 + timeout->tv_nsec / 1000000LL);
+            pollfd p;
+            memset(&p, 0, sizeof(p));
+            p.fd = _v.fd;
+            p.events = POLLOUT | POLLERR;
+            if(-1 == ::poll(&p, 1, mstimeout))
+            {
+              return posix_error();
+            }
+          }
+          LLFIO_POSIX_DEADLINE_TO_TIMEOUT_LOOP(d);
         }
-        LLFIO_POSIX_DEADLINE_TO_TIMEOUT_LOOP(d);
+      } while(written <= 0);
+      if(written < 0)
+      {
+        break;
       }
-    } while(byteswritten <= 0);
+      byteswritten += written;
+      done += count;
+      if(done >= reqs.buffers.size() || static_cast<size_t>(written) < detail::io_handle_bytes(iov + done - count, count))
+      {
+        break;
+      }
+    }
   }
   for(size_t i = 0; i < reqs.buffers.size(); i++)
   {
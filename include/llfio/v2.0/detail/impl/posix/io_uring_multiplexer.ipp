@@ -0,0 +1,2942 @@
+/* Multiplex file i/o
+(C) 2020 Niall Douglas <http://www.nedproductions.biz/> (9 commits)
+File Created: May 2019
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../../io_handle.hpp"
+
+#if !LLFIO_INCLUDED_BY_HEADER || !defined(LLFIO_IO_HANDLE_H)
+#error This file should never be included directly
+#endif
+
+#ifndef __linux__
+#error This implementation file is for Linux only
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <climits>  // for IOV_MAX
+#include <map>
+#include <vector>
+
+#include <linux/fs.h>
+#include <linux/types.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "../../../utils.hpp"
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+/* io_uring is a bit of an interesting design, so we've ended up with a rather
+unusual i/o multiplexer design, which wasn't anticipated when we began this.
+
+POSIX provides strong read/write concurrency guarantees which are valuable, and
+more importantly, lots of file i/o code hard-assumes (often unintentionally) that
+there is an implicit sequencing of all i/o issued against each inode. This arose,
+historically speaking, because each inode has a read-write mutex, and i/o upon
+that inode therefore was serialised by that mutex in the kernel.
+
+Just to be clear, POSIX's guarantees are weaker than this - i/o upon non-overlapping
+regions can parallelise embarrassingly. However, if concurrent i/o upon the same
+inode overlaps a region, each i/o must complete as an atomic operation with
+respect to other i/o operations. And given how fast i/o can be, spending CPU on
+figuring out if regions overlap is usually more expensive than just using a per-inode
+read-write mutex.
+
+Conformance to POSIX read/write concurrency guarantees is excellent on Windows and
+all POSIX, except for Linux ext4 without O_DIRECT. However, io_uring doesn't
+expose any of this for file i/o - i/o submitted is immediately initiated, and no
+ordering is implemented at all. i.e. it's on you, the io_uring user, to not submit
+i/o the concurrency of which would be problematic. This even extends to IORING_OP_FSYNC,
+which will complete without reordering constraints to any i/o initiated beforehand
+or afterwards.
+
+io_uring *does* provide completion ordering *per-queue* via the IOSQE_IO_DRAIN and
+the IOSQE_IO_LINK flags. The former allows reordering of all i/o before the drain,
+but all that i/o must complete before the IOSQE_IO_DRAIN flagged submission can
+begin (this equals fence semantics). The latter imposes sequentially consistent
+ordering in that each item in the chain must complete before the next item,
+however individual chains can be reordered against one another.
+
+If one wishes to implement POSIX read/write concurrency guarantees,
+then one needs to enforce an ordering per-inode, which because io_uring only offers
+ordering at a per-queue level, implies that there must be either a queue per inode,
+or all file i/o must be sequentially orderered to all other file i/o i.e. you use
+a fully sequentially ordered queue for file i/o, and a separate freely reordered
+queue for non-file i/o.
+
+What we've thus done for this i/o multiplexer is this:
+
+- If the handle type is seekable, all initiated i/o enters an interval index per
+inode (not per handle, as many handles may refer to the same inode), and leaves it
+upon completion. I/o is held back from submission whilst it overlaps any i/o
+initiated earlier upon that inode, and either of them is a write or a barrier.
+Barriers overlap their range, or the whole file if their range is empty. Each i/o
+counts those earlier overlapping i/o when initiated, and only becomes pending
+submission when that count falls to zero. This implements POSIX read/write
+concurrency guarantees without serialising non-overlapping i/o, which
+IOSQE_IO_DRAIN on each write would do for the whole io_uring.
+
+- If the handle type is not seekable, all initiated i/o enters a queue per handle.
+As each i/o completes, the next i/o from the queue is submitted. Only one read and
+one write can be in flight per non-seekable handle at a time.
+
+- Two io_uring instances are used, one for seekable i/o, the other for non-seekable
+i/o. This prevents writes to seekable handles blocking until non-seekable i/o completes.
+If completion polling is configured, a third io_uring created with IORING_SETUP_IOPOLL
+takes the reads and writes without a deadline of seekable handles opened O_DIRECT. Only
+reads and writes can be submitted to such an io_uring, and nothing signals their completion,
+so whilst any are in flight checking for completions spins rather than sleeps. The
+ordering per inode above spans both seekable io_urings, as it is done before submission.
+
+- Handles which have no kernel file descriptor, or which perform their i/o entirely
+in user space (e.g. `mapped_file_handle`, whose `max_buffers()` is zero), are not
+submitted to io_uring at all. Their i/o is performed synchronously upon initiation,
+and is therefore always immediately finished.
+
+- Older kernels return EAGAIN for i/o upon non-blocking file descriptors which are
+not ready. If that occurs, the i/o is resubmitted linked after an IORING_OP_POLL_ADD
+for the appropriate readiness.
+
+- I/o waiting for room in an io_uring is pending in one of two lists, and high priority
+i/o (see `io_priority`) is submitted from its list before any ordinary i/o. The ordering
+per inode and per non-seekable handle above still applies, so high priority i/o never
+overtakes i/o which it must follow. The class and level of reads and writes are also
+set as `ioprio` in the submission, so the kernel's i/o scheduler can reorder i/o already
+submitted. Realtime i/o failing with EPERM is resubmitted as the highest best effort.
+
+- The flags of reads and writes (see `io_flag`) are set as `rw_flags` in the submission.
+I/o with `io_flag::nowait` completes with EAGAIN if it would block, rather than being
+resubmitted after a linked poll. Appends are ordered as if they overlap the whole inode.
+
+- Scatter-gather lists longer than IOV_MAX are submitted one batch of IOV_MAX buffers at
+a time. Each batch transferring all of its bytes resubmits the i/o for the next batch
+ahead of any later i/o, so the i/o completes once, with the sum of the batches. A linked
+chain of submissions is not used, as a short transfer within a chain would not stop the
+batches after it. Short reads from non-seekable handles complete the i/o.
+
+- Upon the first `allocate_registered_buffer()` by a handle whose i/o goes to io_uring,
+a slab of (large page backed if possible) memory is registered with both io_urings
+using IORING_REGISTER_BUFFERS. Registered buffers are runs of pages within that slab,
+and are returned to the slab when their last reference goes away. Single buffer i/o
+upon a registered buffer is issued as IORING_OP_READ_FIXED/IORING_OP_WRITE_FIXED,
+which avoids the kernel pinning the pages for every i/o. If the slab cannot be
+registered (e.g. RLIMIT_MEMLOCK is too low on older kernels), or is exhausted,
+registered buffers are allocated as if no multiplexer were set.
+
+- Buffer groups from `allocate_buffer_group()` are provided to the non-seekable io_uring
+using IORING_OP_PROVIDE_BUFFERS, under a group id not used by any other live group. Reads
+into a group are submitted as IORING_OP_READ with IOSQE_BUFFER_SELECT, always linked
+after an IORING_OP_POLL_ADD so a buffer is only consumed once there is data. Released
+buffers are marked in a bitmap, and provided again in runs upon the next submission.
+
+- `completion_notification_handle()` creates an eventfd, registers it with both io_urings
+using IORING_REGISTER_EVENTFD, and has the syscall worker signal it too. Each check resets
+it before reaping, and signals it again if completions were left unreaped.
+*/
+template <bool is_threadsafe> class linux_io_uring_multiplexer final : public io_multiplexer_impl<is_threadsafe>
+{
+  using _base = io_multiplexer_impl<is_threadsafe>;
+  using _multiplexer_lock_guard = typename _base::_lock_guard;
+
+  using path_type = typename _base::path_type;
+  using extent_type = typename _base::extent_type;
+  using size_type = typename _base::size_type;
+  using mode = typename _base::mode;
+  using creation = typename _base::creation;
+  using caching = typename _base::caching;
+  using flag = typename _base::flag;
+  using barrier_kind = typename _base::barrier_kind;
+  using const_buffers_type = typename _base::const_buffers_type;
+  using buffer_type = typename _base::buffer_type;
+  using buffers_type = typename _base::buffers_type;
+  using registered_buffer_type = typename _base::registered_buffer_type;
+  using io_priority_class = typename _base::io_priority_class;
+  using io_priority = typename _base::io_priority;
+  using io_flag = typename _base::io_flag;
+  template <class T> using io_request = typename _base::template io_request<T>;
+  template <class T> using io_result = typename _base::template io_result<T>;
+  using io_operation_state = typename _base::io_operation_state;
+  using io_operation_state_visitor = typename _base::io_operation_state_visitor;
+  using check_for_any_completed_io_statistics = typename _base::check_for_any_completed_io_statistics;
+  using syscall_operation_kind = typename _base::syscall_operation_kind;
+  using syscall_operation_state = typename _base::syscall_operation_state;
+
+  // The io_uring kernel submission structure
+  struct _io_uring_sqe
+  {
+    uint8_t opcode;  /* type of operation for this sqe */
+    uint8_t flags;   /* IOSQE_ flags */
+    uint16_t ioprio; /* ioprio for the request */
+    int32_t fd;      /* file descriptor to do IO on */
+    union {
+      uint64_t off; /* offset into file */
+      uint64_t addr2;
+    };
+    union {
+      uint64_t addr; /* pointer to buffer or iovecs */
+      uint64_t splice_off_in;
+    };
+    uint32_t len; /* buffer size or number of iovecs */
+    union {
+      __kernel_rwf_t rw_flags;
+      uint32_t fsync_flags;
+      uint16_t poll_events;
+      uint32_t sync_range_flags;
+      uint32_t msg_flags;
+      uint32_t timeout_flags;
+      uint32_t accept_flags;
+      uint32_t cancel_flags;
+      uint32_t open_flags;
+      uint32_t statx_flags;
+      uint32_t fadvise_advice;
+      uint32_t splice_flags;
+    };
+    uint64_t user_data; /* data to be passed back at completion time */
+    union {
+      struct
+      {
+        /* pack this to avoid bogus arm OABI complaints */
+        union {
+          /* index into fixed buffers, if used */
+          uint16_t buf_index;
+          /* for grouped buffer selection */
+          uint16_t buf_group;
+        } __attribute__((packed));
+        /* personality to use, if used */
+        uint16_t personality;
+        int32_t splice_fd_in;
+      };
+      uint64_t __pad2[3];
+    };
+  };
+
+  // sqe->flags
+  /* use fixed fileset */
+  static constexpr uint32_t _IOSQE_FIXED_FILE = (1U << 0);
+  /* issue after inflight IO */
+  static constexpr uint32_t _IOSQE_IO_DRAIN = (1U << 1);
+  /* links next sqe */
+  static constexpr uint32_t _IOSQE_IO_LINK = (1U << 2);
+  /* like LINK, but stronger */
+  static constexpr uint32_t _IOSQE_IO_HARDLINK = (1U << 3);
+  /* always go async */
+  static constexpr uint32_t _IOSQE_ASYNC = (1U << 4);
+  /* select buffer from sqe->buf_group */
+  static constexpr uint32_t _IOSQE_BUFFER_SELECT = (1U << 5);
+
+  // io_uring_setup() flags
+  static constexpr uint32_t _IORING_SETUP_IOPOLL = (1U << 0);    /* io_context is polled */
+  static constexpr uint32_t _IORING_SETUP_SQPOLL = (1U << 1);    /* SQ poll thread */
+  static constexpr uint32_t _IORING_SETUP_SQ_AFF = (1U << 2);    /* sq_thread_cpu is valid */
+  static constexpr uint32_t _IORING_SETUP_CQSIZE = (1U << 3);    /* app defines CQ size */
+  static constexpr uint32_t _IORING_SETUP_CLAMP = (1U << 4);     /* clamp SQ/CQ ring sizes */
+  static constexpr uint32_t _IORING_SETUP_ATTACH_WQ = (1U << 5); /* attach to existing wq */
+
+  // sqe->opcode
+  enum
+  {
+    _IORING_OP_NOP,
+    _IORING_OP_READV,
+    _IORING_OP_WRITEV,
+    _IORING_OP_FSYNC,
+    _IORING_OP_READ_FIXED,
+    _IORING_OP_WRITE_FIXED,
+    _IORING_OP_POLL_ADD,
+    _IORING_OP_POLL_REMOVE,
+    _IORING_OP_SYNC_FILE_RANGE,
+    _IORING_OP_SENDMSG,
+    _IORING_OP_RECVMSG,
+    _IORING_OP_TIMEOUT,
+    _IORING_OP_TIMEOUT_REMOVE,
+    _IORING_OP_ACCEPT,
+    _IORING_OP_ASYNC_CANCEL,
+    _IORING_OP_LINK_TIMEOUT,
+    _IORING_OP_CONNECT,
+    _IORING_OP_FALLOCATE,
+    _IORING_OP_OPENAT,
+    _IORING_OP_CLOSE,
+    _IORING_OP_FILES_UPDATE,
+    _IORING_OP_STATX,
+    _IORING_OP_READ,
+    _IORING_OP_WRITE,
+    _IORING_OP_FADVISE,
+    _IORING_OP_MADVISE,
+    _IORING_OP_SEND,
+    _IORING_OP_RECV,
+    _IORING_OP_OPENAT2,
+    _IORING_OP_EPOLL_CTL,
+    _IORING_OP_SPLICE,
+    _IORING_OP_PROVIDE_BUFFERS,
+    _IORING_OP_REMOVE_BUFFERS,
+
+    /* this goes last, obviously */
+    _IORING_OP_LAST,
+  };
+
+  // sqe->fsync_flags
+  static constexpr uint32_t _IORING_FSYNC_DATASYNC = (1U << 0);
+  static constexpr uint32_t _SYNC_FILE_RANGE_WAIT_BEFORE = 1;
+  static constexpr uint32_t _SYNC_FILE_RANGE_WRITE = 2;
+  static constexpr uint32_t _SYNC_FILE_RANGE_WAIT_AFTER = 4;
+
+  // sqe->rw_flags
+  static constexpr uint32_t _RWF_DSYNC = 0x2;
+  static constexpr uint32_t _RWF_SYNC = 0x4;
+  static constexpr uint32_t _RWF_NOWAIT = 0x8;
+  static constexpr uint32_t _RWF_APPEND = 0x10;
+
+  // sqe->timeout_flags
+  static constexpr uint32_t _IORING_TIMEOUT_ABS = (1U << 0);
+
+  /*
+   * sqe->splice_flags
+   * extends splice(2) flags
+   */
+  static constexpr uint32_t _SPLICE_F_FD_IN_FIXED = (1U << 31); /* the last bit of uint32_t */
+
+
+  // The io_uring kernel completion structure
+  struct _io_uring_cqe
+  {
+    uint64_t user_data; /* sqe->data submission passed back */
+    int32_t res;        /* result code for this event */
+    uint32_t flags;
+  };
+
+  // cqe->flags
+  // IORING_CQE_F_BUFFER	If set, the upper 16 bits are the buffer ID
+  static constexpr uint32_t _IORING_CQE_F_BUFFER = (1U << 0);
+
+  static constexpr uint32_t _IORING_CQE_BUFFER_SHIFT = 16;
+
+  // Magic offsets for the application to mmap the data it needs
+  static constexpr size_t _IORING_OFF_SQ_RING = (size_t) 0;
+  static constexpr size_t _IORING_OFF_CQ_RING = (size_t) 0x8000000;
+  static constexpr size_t _IORING_OFF_SQES = (size_t) 0x10000000;
+
+  // Filled with the offset for mmap(2)
+  struct _io_sqring_offsets
+  {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t ring_mask;
+    uint32_t ring_entries;
+    uint32_t flags;
+    uint32_t dropped;
+    uint32_t array;
+    uint32_t resv1;
+    uint64_t resv2;
+  };
+
+  // sq_ring->flags
+  static constexpr uint32_t _IORING_SQ_NEED_WAKEUP = (1U << 0); /* needs io_uring_enter wakeup */
+
+  struct _io_cqring_offsets
+  {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t ring_mask;
+    uint32_t ring_entries;
+    uint32_t overflow;
+    uint32_t cqes;
+    uint64_t resv[2];
+  };
+
+  // io_uring_enter(2) flags
+  static constexpr uint32_t _IORING_ENTER_GETEVENTS = (1U << 0);
+  static constexpr uint32_t _IORING_ENTER_SQ_WAKEUP = (1U << 1);
+
+  // Passed in for io_uring_setup(2). Copied back with updated info on success
+  struct _io_uring_params
+  {
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+    uint32_t flags;
+    uint32_t sq_thread_cpu;
+    uint32_t sq_thread_idle;
+    uint32_t features;
+    uint32_t wq_fd;
+    uint32_t resv[3];
+    struct _io_sqring_offsets sq_off;
+    struct _io_cqring_offsets cq_off;
+  };
+
+  // io_uring_params->features flags
+  static constexpr uint32_t _IORING_FEAT_SINGLE_MMAP = (1U << 0);
+  static constexpr uint32_t _IORING_FEAT_NODROP = (1U << 1);
+  static constexpr uint32_t _IORING_FEAT_SUBMIT_STABLE = (1U << 2);
+  static constexpr uint32_t _IORING_FEAT_RW_CUR_POS = (1U << 3);
+  static constexpr uint32_t _IORING_FEAT_CUR_PERSONALITY = (1U << 4);
+  static constexpr uint32_t _IORING_FEAT_FAST_POLL = (1U << 5);
+
+  // io_uring_register(2) opcodes and arguments
+  enum
+  {
+    _IORING_REGISTER_BUFFERS,
+    _IORING_UNREGISTER_BUFFERS,
+    _IORING_REGISTER_FILES,
+    _IORING_UNREGISTER_FILES,
+    _IORING_REGISTER_EVENTFD,
+    _IORING_UNREGISTER_EVENTFD,
+    _IORING_REGISTER_FILES_UPDATE,
+    _IORING_REGISTER_EVENTFD_ASYNC,
+    _IORING_REGISTER_PROBE,
+    _IORING_REGISTER_PERSONALITY,
+    _IORING_UNREGISTER_PERSONALITY
+  };
+
+  struct _io_uring_files_update
+  {
+    uint32_t offset;
+    uint32_t resv;
+    __aligned_u64 /* int32_t * */ fds;
+  };
+
+  static constexpr uint32_t _IO_URING_OP_SUPPORTED = (1U << 0);
+
+  struct _io_uring_probe_op
+  {
+    uint8_t op;
+    uint8_t resv;
+    uint16_t flags; /* IO_URING_OP_* flags */
+    uint32_t resv2;
+  };
+
+  struct _io_uring_probe
+  {
+    uint8_t last_op; /* last opcode supported */
+    uint8_t ops_len; /* length of ops[] array below */
+    uint16_t resv;
+    uint32_t resv2[3];
+    struct _io_uring_probe_op ops[0];
+  };
+
+  template <class T> static T _io_uring_smp_load_acquire(const T &_v) noexcept
+  {
+    auto *v = (const std::atomic<T> *) &_v;
+    return v->load(std::memory_order_acquire);
+  }
+  template <class T> static void _io_uring_smp_store_release(T &_v, T x) noexcept
+  {
+    auto *v = (std::atomic<T> *) &_v;
+    v->store(x, std::memory_order_release);
+  }
+  static int _io_uring_setup(unsigned entries, struct _io_uring_params *p)
+  {
+#ifdef __alpha__
+    return syscall(535 /*__NR_io_uring_setup*/, entries, p);
+#else
+    return syscall(425 /*__NR_io_uring_setup*/, entries, p);
+#endif
+  }
+  static int _io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+  {
+#ifdef __alpha__
+    return syscall(537 /*__NR_io_uring_register*/, fd, opcode, arg, nr_args);
+#else
+    return syscall(427 /*__NR_io_uring_register*/, fd, opcode, arg, nr_args);
+#endif
+  }
+  static int _io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, sigset_t *sig)
+  {
+#ifdef __alpha__
+    return syscall(536 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, sig, _NSIG / 8);
+#else
+    return syscall(426 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, sig, _NSIG / 8);
+#endif
+  }
+  static int _io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+  {
+#ifdef __alpha__
+    return syscall(536 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, nullptr, 0);
+#else
+    return syscall(426 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, nullptr, 0);
+#endif
+  }
+
+  static_assert(sizeof(_io_uring_sqe) == 64, "_io_uring_sqe is not 64 bytes in size!");
+  static_assert(sizeof(_io_uring_cqe) == 16, "_io_uring_cqe is not 16 bytes in size!");
+
+  // An io_uring instance, with its mapped submission and completion rings
+  struct _ring_t
+  {
+    int fd{-1};
+    bool is_polling{false};  // the kernel has a thread polling the submission queue
+    struct submission_t
+    {
+      uint32_t *head{nullptr}, *tail{nullptr}, *flags{nullptr}, *array{nullptr};
+      uint32_t ring_mask{0}, ring_entries{0};
+      uint32_t local_tail{0};  // entries up to here have been filled, but not necessarily published to the kernel
+      _io_uring_sqe *entries{nullptr};
+      span<byte> ring, entries_map;
+    } submission;
+    struct completion_t
+    {
+      uint32_t *head{nullptr}, *tail{nullptr};
+      uint32_t ring_mask{0}, ring_entries{0};
+      _io_uring_cqe *entries{nullptr};
+      span<byte> ring;
+    } completion;
+    // Submissions whose completions have not been reaped yet. Never exceeds the
+    // completion ring size, so the completion ring can never overflow.
+    uint32_t inflight{0};
+
+    bool has_room(uint32_t count) const noexcept
+    {
+      const uint32_t used = submission.local_tail - _io_uring_smp_load_acquire(*submission.head);
+      return used + count <= submission.ring_entries && inflight + count <= completion.ring_entries;
+    }
+    _io_uring_sqe *get_sqe() noexcept
+    {
+      const uint32_t idx = submission.local_tail & submission.ring_mask;
+      submission.array[idx] = idx;
+      ++submission.local_tail;
+      ++inflight;
+      auto *sqe = submission.entries + idx;
+      memset(sqe, 0, sizeof(_io_uring_sqe));
+      return sqe;
+    }
+    void publish() noexcept { _io_uring_smp_store_release(*submission.tail, submission.local_tail); }
+  };
+
+  // The kernel's timespec for timeouts, which is 64 bit on all architectures
+  struct _kernel_timespec
+  {
+    int64_t tv_sec;
+    long long tv_nsec;
+  };
+
+  struct _inode_t;
+  struct _buffer_group;
+  struct alignas(8) _io_uring_operation_state final : public std::conditional_t<is_threadsafe, typename _base::_synchronised_io_operation_state, typename _base::_unsynchronised_io_operation_state>,
+                                                   public detail::io_multiplexer_deadline_wheel::node
+  {
+    using _impl = std::conditional_t<is_threadsafe, typename _base::_synchronised_io_operation_state, typename _base::_unsynchronised_io_operation_state>;
+
+    // Where this operation currently is within the multiplexer
+    enum class location_t : uint8_t
+    {
+      none,
+      queued,      // waiting behind the preceding i/o of its kind upon its handle
+      blocked,     // waiting for earlier overlapping i/o upon its inode to complete
+      pending,     // waiting to be submitted to io_uring
+      submitted,   // submitted to io_uring, completion not reaped yet
+      completing,  // completion reaped, visitor about to be invoked
+    };
+
+    _io_uring_operation_state *prev{nullptr}, *next{nullptr};
+    int fd{-1};
+    int res{0};          // the result from the completion of the i/o
+    int poll_result{0};  // negative if the linked poll failed
+    io_operation_state_type initiated{io_operation_state_type::unknown};
+    location_t location{location_t::none};
+    uint8_t cqes_outstanding{0};  // completions to reap before this operation can complete
+    uint32_t iov_done{0};         // buffers of a list longer than IOV_MAX transferred by earlier submissions
+    uint32_t inode_blockers{0};   // earlier overlapping i/o upon the inode which has yet to complete
+    _inode_t *inode{nullptr};         // for seekable i/o, the inode it is ordered upon
+    extent_type io_offset{0}, io_end{0};  // the region of the inode the i/o affects
+    _io_uring_operation_state *tree_left{nullptr}, *tree_right{nullptr};  // within the inode's interval treap
+    extent_type tree_max_end{0};  // the greatest io_end within this subtree of the inode's interval treap
+    uint64_t inode_seq{0};        // initiation order upon the inode
+    extent_type bytes_done{0};            // bytes transferred by earlier submissions
+    bool is_seekable{false};
+    bool is_polled{false};        // i/o is submitted to the completion polled io_uring
+    bool is_high_priority{false};  // i/o is submitted ahead of ordinary pending i/o
+    uint16_t ioprio{0};            // the kernel i/o priority of a read or write, zero for unchanged
+    bool is_nowait{false};         // fails with EAGAIN rather than waiting for readiness
+    bool is_fixed_buffer{false};  // i/o is upon the registered buffer slab
+    _buffer_group *buffer_group{nullptr};  // read selects its buffer from this group
+    int selected_buffer{-1};               // the buffer the kernel selected from the group
+    bool needs_poll{false};      // next submission needs to be preceded by a linked poll
+    bool is_poll_linked{false};  // current submission was preceded by a linked poll
+    bool cancelled{false};
+    bool timed_out{false};  // the linked timeout fired
+    std::chrono::steady_clock::time_point expiry{std::chrono::steady_clock::time_point::max()};
+    _kernel_timespec timeout{0, 0};  // read by the kernel when the linked timeout is submitted
+
+    bool has_deadline() const noexcept { return expiry != std::chrono::steady_clock::time_point::max(); }
+
+    _io_uring_operation_state() = default;
+    // Construct implicitly from the base implementation, see relocate_to()
+    explicit _io_uring_operation_state(_impl &&o) noexcept
+        : _impl(std::move(o))
+    {
+    }
+    using _impl::_impl;
+
+    virtual io_operation_state *relocate_to(byte *to_) noexcept override
+    {
+      auto *to = _impl::relocate_to(to_);
+      // restamp the vptr with my own
+      auto _to = new(to) _io_uring_operation_state(std::move(*static_cast<_impl *>(to)));
+      _to->fd = fd;
+      _to->is_seekable = is_seekable;
+      _to->is_polled = is_polled;
+      _to->is_high_priority = is_high_priority;
+      _to->ioprio = ioprio;
+      _to->is_nowait = is_nowait;
+      _to->is_fixed_buffer = is_fixed_buffer;
+      _to->iov_done = iov_done;
+      _to->bytes_done = bytes_done;
+      _to->buffer_group = buffer_group;
+      _to->inode = inode;
+      _to->io_offset = io_offset;
+      _to->io_end = io_end;
+      _to->expiry = expiry;
+      return _to;
+    }
+  };
+  // An intrusive list of i/o operation states
+  struct _queue_t
+  {
+    _io_uring_operation_state *first{nullptr}, *last{nullptr};
+
+    void push_back(_io_uring_operation_state *state) noexcept
+    {
+      assert(state->prev == nullptr);
+      assert(state->next == nullptr);
+      state->prev = last;
+      if(last == nullptr)
+      {
+        first = state;
+      }
+      else
+      {
+        last->next = state;
+      }
+      last = state;
+    }
+    void push_front(_io_uring_operation_state *state) noexcept
+    {
+      assert(state->prev == nullptr);
+      assert(state->next == nullptr);
+      state->next = first;
+      if(first == nullptr)
+      {
+        last = state;
+      }
+      else
+      {
+        first->prev = state;
+      }
+      first = state;
+    }
+    void remove(_io_uring_operation_state *state) noexcept
+    {
+      if(state->prev == nullptr)
+      {
+        assert(first == state);
+        first = state->next;
+      }
+      else
+      {
+        state->prev->next = state->next;
+      }
+      if(state->next == nullptr)
+      {
+        assert(last == state);
+        last = state->prev;
+      }
+      else
+      {
+        state->next->prev = state->prev;
+      }
+      state->next = state->prev = nullptr;
+    }
+  };
+  /* Per inode state, indexing all uncompleted seekable i/o upon the inode by the region of
+  the inode it affects. This is a treap ordered by offset then initiation order, where each
+  node records the greatest end of any region in its subtree, so all the i/o overlapping a
+  region is found in O(log n + overlaps). Each i/o counts the earlier i/o it overlaps as it
+  is added, and each i/o removed decrements the count of the later i/o it overlaps. I/o
+  with a nonzero count is blocked, and is released when its count falls to zero.
+  */
+  struct _inode_t
+  {
+    size_t handles{0};  // registered handles referring to this inode
+    uint64_t seq{0};    // initiation order of the most recently added i/o
+    _io_uring_operation_state *root{nullptr};  // the interval treap
+
+    // True if the two i/o overlap, and either of them is a write or a barrier
+    static bool _conflicts(const _io_uring_operation_state *a, const _io_uring_operation_state *b) noexcept
+    {
+      return (a->initiated != io_operation_state_type::read_initiated || b->initiated != io_operation_state_type::read_initiated) && a->io_offset < b->io_end &&
+             b->io_offset < a->io_end;
+    }
+    static bool _tree_less(const _io_uring_operation_state *a, const _io_uring_operation_state *b) noexcept
+    {
+      return a->io_offset < b->io_offset || (a->io_offset == b->io_offset && a->inode_seq < b->inode_seq);
+    }
+    // Treap priorities are a Fibonacci hash of the initiation order, which is as good as random
+    static uint32_t _tree_priority(const _io_uring_operation_state *a) noexcept { return (uint32_t) ((a->inode_seq * 0x9E3779B97F4A7C15ULL) >> 32); }
+    static void _tree_update(_io_uring_operation_state *t) noexcept
+    {
+      t->tree_max_end = t->io_end;
+      if(t->tree_left != nullptr && t->tree_left->tree_max_end > t->tree_max_end)
+      {
+        t->tree_max_end = t->tree_left->tree_max_end;
+      }
+      if(t->tree_right != nullptr && t->tree_right->tree_max_end > t->tree_max_end)
+      {
+        t->tree_max_end = t->tree_right->tree_max_end;
+      }
+    }
+    // Splits t into those ordered before x, and the rest
+    static void _tree_split(_io_uring_operation_state *t, const _io_uring_operation_state *x, _io_uring_operation_state *&l, _io_uring_operation_state *&r) noexcept
+    {
+      if(t == nullptr)
+      {
+        l = r = nullptr;
+      }
+      else if(_tree_less(t, x))
+      {
+        _tree_split(t->tree_right, x, t->tree_right, r);
+        l = t;
+        _tree_update(t);
+      }
+      else
+      {
+        _tree_split(t->tree_left, x, l, t->tree_left);
+        r = t;
+        _tree_update(t);
+      }
+    }
+    static _io_uring_operation_state *_tree_merge(_io_uring_operation_state *l, _io_uring_operation_state *r) noexcept
+    {
+      if(l == nullptr)
+      {
+        return r;
+      }
+      if(r == nullptr)
+      {
+        return l;
+      }
+      if(_tree_priority(l) > _tree_priority(r))
+      {
+        l->tree_right = _tree_merge(l->tree_right, r);
+        _tree_update(l);
+        return l;
+      }
+      r->tree_left = _tree_merge(l, r->tree_left);
+      _tree_update(r);
+      return r;
+    }
+    static _io_uring_operation_state *_tree_insert(_io_uring_operation_state *t, _io_uring_operation_state *x) noexcept
+    {
+      if(t == nullptr)
+      {
+        return x;
+      }
+      if(_tree_priority(x) > _tree_priority(t))
+      {
+        _tree_split(t, x, x->tree_left, x->tree_right);
+        _tree_update(x);
+        return x;
+      }
+      if(_tree_less(x, t))
+      {
+        t->tree_left = _tree_insert(t->tree_left, x);
+      }
+      else
+      {
+        t->tree_right = _tree_insert(t->tree_right, x);
+      }
+      _tree_update(t);
+      return t;
+    }
+    static _io_uring_operation_state *_tree_remove(_io_uring_operation_state *t, _io_uring_operation_state *x) noexcept
+    {
+      assert(t != nullptr);
+      if(t == x)
+      {
+        auto *ret = _tree_merge(t->tree_left, t->tree_right);
+        x->tree_left = x->tree_right = nullptr;
+        return ret;
+      }
+      if(_tree_less(x, t))
+      {
+        t->tree_left = _tree_remove(t->tree_left, x);
+      }
+      else
+      {
+        t->tree_right = _tree_remove(t->tree_right, x);
+      }
+      _tree_update(t);
+      return t;
+    }
+    // Calls f for every i/o in the treap whose region overlaps [offset, end)
+    template <class F> static void _tree_visit(_io_uring_operation_state *t, extent_type offset, extent_type end, F &f) noexcept
+    {
+      while(t != nullptr && t->tree_max_end > offset)
+      {
+        _tree_visit(t->tree_left, offset, end, f);
+        if(t->io_offset >= end)
+        {
+          return;
+        }
+        if(t->io_end > offset)
+        {
+          f(t);
+        }
+        t = t->tree_right;
+      }
+    }
+    // True if any i/o in the treap satisfies f
+    template <class F> static bool _tree_any(const _io_uring_operation_state *t, F &f) noexcept
+    {
+      for(; t != nullptr; t = t->tree_right)
+      {
+        if(f(t) || _tree_any(t->tree_left, f))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void add(_io_uring_operation_state *state) noexcept
+    {
+      state->inode_seq = ++seq;
+      state->inode_blockers = 0;
+      auto count = [state](_io_uring_operation_state *i) {
+        if(_conflicts(i, state))
+        {
+          ++state->inode_blockers;
+        }
+      };
+      _tree_visit(root, state->io_offset, state->io_end, count);
+      state->tree_left = state->tree_right = nullptr;
+      state->tree_max_end = state->io_end;
+      root = _tree_insert(root, state);
+    }
+    // Calls released for each blocked i/o which no longer waits upon anything
+    template <class F> void remove(_io_uring_operation_state *state, F &&released) noexcept
+    {
+      root = _tree_remove(root, state);
+      // Later overlapping i/o no longer waits upon this i/o. Earlier i/o never did.
+      auto release = [state, &released](_io_uring_operation_state *i) {
+        if(i->inode_seq > state->inode_seq && _conflicts(i, state))
+        {
+          assert(i->inode_blockers > 0);
+          if(--i->inode_blockers == 0)
+          {
+            released(i);
+          }
+        }
+      };
+      _tree_visit(root, state->io_offset, state->io_end, release);
+    }
+  };
+  // Per registered handle state. For non-seekable handles, implements the per-handle queue.
+  struct _registered_fd
+  {
+    int fd{-1};
+    // The read and write either pending or submitted. Later i/o queues behind them.
+    _io_uring_operation_state *inprogress_read{nullptr}, *inprogress_write{nullptr};
+    _queue_t queued_reads, queued_writes;
+    _inode_t *inode{nullptr};  // seekable handles only
+    bool not_pollable{false};  // the completion polled io_uring refused its i/o
+
+    explicit _registered_fd(int _fd)
+        : fd(_fd)
+    {
+    }
+  };
+
+  // A slab of memory registered with both io_urings, handed out as runs of pages.
+  // Registered buffers keep this alive, as they can outlive the multiplexer.
+  struct _registered_buffer_pool
+  {
+    span<byte> slab;
+    size_t page_size{0};
+    spinlock lock;
+    std::vector<uint64_t> used;  // bitmap of pages handed out
+
+    _registered_buffer_pool() = default;
+    _registered_buffer_pool(const _registered_buffer_pool &) = delete;
+    _registered_buffer_pool &operator=(const _registered_buffer_pool &) = delete;
+    ~_registered_buffer_pool()
+    {
+      if(!slab.empty())
+      {
+        ::munmap(slab.data(), slab.size());
+      }
+    }
+
+    bool contains(const byte *p, size_t len) const noexcept { return p >= slab.data() && p + len <= slab.data() + slab.size(); }
+    // Returns the first page of a run of free pages, or -1 if there is no such run
+    size_t allocate(size_t pages) noexcept
+    {
+      const size_t total = slab.size() / page_size;
+      lock_guard<spinlock> g(lock);
+      size_t run = 0;
+      for(size_t n = 0; n < total; n++)
+      {
+        const uint64_t word = used[n / 64];
+        if(word == ~(uint64_t) 0)
+        {
+          run = 0;
+          n |= 63;
+          continue;
+        }
+        if((word & ((uint64_t) 1 << (n % 64))) != 0)
+        {
+          run = 0;
+        }
+        else if(++run == pages)
+        {
+          const size_t first = n + 1 - pages;
+          for(size_t i = first; i <= n; i++)
+          {
+            used[i / 64] |= (uint64_t) 1 << (i % 64);
+          }
+          return first;
+        }
+      }
+      return (size_t) -1;
+    }
+    void release(size_t first, size_t pages) noexcept
+    {
+      lock_guard<spinlock> g(lock);
+      for(size_t i = first; i < first + pages; i++)
+      {
+        used[i / 64] &= ~((uint64_t) 1 << (i % 64));
+      }
+    }
+  };
+  struct _registered_buffer final : io_multiplexer::_registered_buffer_type
+  {
+    std::shared_ptr<_registered_buffer_pool> pool;
+
+    _registered_buffer(std::shared_ptr<_registered_buffer_pool> _pool, span<byte> s)
+        : io_multiplexer::_registered_buffer_type(s)
+        , pool(std::move(_pool))
+    {
+    }
+    _registered_buffer(const _registered_buffer &) = delete;
+    _registered_buffer &operator=(const _registered_buffer &) = delete;
+    ~_registered_buffer() { pool->release((data() - pool->slab.data()) / pool->page_size, size() / pool->page_size); }
+  };
+  static constexpr size_t _registered_buffer_pool_size = 2 * 1024 * 1024;  // counts twice against RLIMIT_MEMLOCK
+
+  // A group of equally sized buffers provided to the non-seekable io_uring, from which reads
+  // select a buffer upon completion. Its bookkeeping is protected by the multiplexer lock.
+  struct _buffer_group final : io_multiplexer::_registered_buffer_type
+  {
+    linux_io_uring_multiplexer *parent;  // reset if the multiplexer is closed first
+    size_t buffer_size;
+    uint32_t count;
+    uint16_t gid;
+    bool any_returned{false};
+    std::vector<uint64_t> returned;  // bitmap of buffers yet to be provided to the kernel
+    std::vector<uint64_t> selected;  // bitmap of buffers selected by reads, and not yet released
+
+    _buffer_group(linux_io_uring_multiplexer *_parent, span<byte> s, size_t _buffer_size, uint32_t _count, uint16_t _gid)
+        : io_multiplexer::_registered_buffer_type(s)
+        , parent(_parent)
+        , buffer_size(_buffer_size)
+        , count(_count)
+        , gid(_gid)
+        , returned((_count + 63) / 64)
+        , selected((_count + 63) / 64)
+    {
+    }
+    _buffer_group(const _buffer_group &) = delete;
+    _buffer_group &operator=(const _buffer_group &) = delete;
+    ~_buffer_group()
+    {
+      if(parent != nullptr)
+      {
+        parent->_remove_buffer_group(this);
+      }
+      ::munmap(data(), (size() + utils::page_size() - 1) & ~(utils::page_size() - 1));
+    }
+  };
+
+  _ring_t _nonseekable, _seekable;
+  _ring_t _polled;  // if completion polling, for the reads and writes of O_DIRECT seekable handles
+  _queue_t _pending;
+  _queue_t _pending_high_priority;  // submitted before _pending
+  std::vector<_registered_fd> _registered_fds;  // sorted by fd
+  std::map<std::pair<dev_t, ino_t>, _inode_t> _inodes;
+  std::vector<_io_uring_operation_state *> _deferred_cancels;
+  std::shared_ptr<_registered_buffer_pool> _buffer_pool;
+  bool _buffer_pool_failed{false};  // don't retry a registration which failed
+  bool _has_sync_file_range{false};  // the kernel supports IORING_OP_SYNC_FILE_RANGE
+  bool _has_openat{false}, _has_close{false}, _has_statx{false};
+  bool _has_provide_buffers{false};  // the kernel supports IORING_OP_PROVIDE_BUFFERS and IORING_OP_READ
+  std::vector<_buffer_group *> _buffer_groups;
+  // Buffer groups destroyed whose buffers are yet to be removed from the kernel. Has capacity
+  // reserved for every group, so destruction never allocates.
+  std::vector<std::pair<uint16_t, uint32_t>> _removed_buffer_groups;
+  // Syscalls not yet submitted, in order of initiation
+  syscall_operation_state *_pending_syscalls_first{nullptr}, *_pending_syscalls_last{nullptr};
+  detail::io_multiplexer_syscall_worker _syscall_worker;  // performs the syscalls io_uring cannot
+  int _wakefd{-1};  // an eventfd waking threads sleeping within check_for_any_completed_io()
+  int _wakecount{0};
+  size_t _sleepers{0};      // threads sleeping within check_for_any_completed_io()
+  bool _wakefd_set{false};  // the eventfd is signalled
+  int _notifyfd{-1};        // the eventfd registered with both io_urings, if completion_notification_handle() was called
+
+  _ring_t &_ring_for(_io_uring_operation_state *state) noexcept { return state->is_polled ? _polled : (state->is_seekable ? _seekable : _nonseekable); }
+  typename std::vector<_registered_fd>::iterator _registered_fd_lower_bound(int fd) noexcept
+  {
+    return std::lower_bound(_registered_fds.begin(), _registered_fds.end(), fd, [](const _registered_fd &a, int b) { return a.fd < b; });
+  }
+  _registered_fd *_find_registered_fd(int fd) noexcept
+  {
+    auto it = _registered_fd_lower_bound(fd);
+    if(it == _registered_fds.end() || it->fd != fd)
+    {
+      return nullptr;
+    }
+    return &*it;
+  }
+
+  // Allocates the registered buffer slab and registers it with both io_urings. Must be
+  // called with the lock held, and with no i/o in flight as registration quiesces the
+  // io_uring on older kernels.
+  result<void> _init_buffer_pool() noexcept
+  {
+    try
+    {
+      auto pool = std::make_shared<_registered_buffer_pool>();
+      pool->page_size = utils::page_size();
+      const auto &page_sizes = utils::page_sizes(true);
+      void *p = MAP_FAILED;
+      if(page_sizes.size() > 1 && (_registered_buffer_pool_size % page_sizes[1]) == 0)
+      {
+        p = ::mmap(nullptr, _registered_buffer_pool_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      }
+      if(MAP_FAILED == p)
+      {
+        p = ::mmap(nullptr, _registered_buffer_pool_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(MAP_FAILED == p)
+        {
+          return posix_error();
+        }
+        (void) ::madvise(p, _registered_buffer_pool_size, MADV_HUGEPAGE);
+      }
+      pool->slab = {(byte *) p, _registered_buffer_pool_size};
+      pool->used.resize((_registered_buffer_pool_size / pool->page_size + 63) / 64);
+      struct iovec iov;
+      iov.iov_base = p;
+      iov.iov_len = _registered_buffer_pool_size;
+      if(_io_uring_register(_nonseekable.fd, _IORING_REGISTER_BUFFERS, &iov, 1) < 0)
+      {
+        return posix_error();
+      }
+      if(_io_uring_register(_seekable.fd, _IORING_REGISTER_BUFFERS, &iov, 1) < 0)
+      {
+        auto ret = posix_error();
+        (void) _io_uring_register(_nonseekable.fd, _IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        return ret;
+      }
+      if(_polled.fd != -1 && _io_uring_register(_polled.fd, _IORING_REGISTER_BUFFERS, &iov, 1) < 0)
+      {
+        auto ret = posix_error();
+        (void) _io_uring_register(_seekable.fd, _IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        (void) _io_uring_register(_nonseekable.fd, _IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        return ret;
+      }
+      _buffer_pool = std::move(pool);
+      return success();
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+  template <class BuffersType> bool _is_fixed_buffer(const registered_buffer_type &base, BuffersType buffers) const noexcept
+  {
+    // The fixed opcodes take a single buffer
+    return base && _buffer_pool && buffers.size() == 1 && _buffer_pool->contains((const byte *) buffers[0].data(), buffers[0].size());
+  }
+
+  // Returns the buffer group of this multiplexer which is base, if any. Must be called with the lock held.
+  _buffer_group *_find_buffer_group(const io_multiplexer::_registered_buffer_type *base) const noexcept
+  {
+    for(auto *group : _buffer_groups)
+    {
+      if(static_cast<const io_multiplexer::_registered_buffer_type *>(group) == base)
+      {
+        return group;
+      }
+    }
+    return nullptr;
+  }
+  // Called by a buffer group being destroyed. Its buffers can no longer be selected, as any
+  // read which could select them kept it alive.
+  void _remove_buffer_group(_buffer_group *group) noexcept
+  {
+    _multiplexer_lock_guard g(this->_lock);
+    _buffer_groups.erase(std::find(_buffer_groups.begin(), _buffer_groups.end(), group));
+    _removed_buffer_groups.emplace_back(group->gid, group->count);
+  }
+  // Marks a buffer to be provided to the kernel again. Must be called with the lock held.
+  static void _return_selected_buffer(_buffer_group *group, uint32_t bid) noexcept
+  {
+    group->returned[bid / 64] |= (uint64_t) 1 << (bid % 64);
+    group->any_returned = true;
+  }
+  // Fills submission queue entries providing returned buffers to the kernel, one per run of
+  // consecutive buffers. Returns false if the ring filled first. Must be called with the lock held.
+  bool _prep_provide_buffers(_buffer_group *group) noexcept
+  {
+    for(uint32_t bid = 0; bid < group->count;)
+    {
+      if((group->returned[bid / 64] & ((uint64_t) 1 << (bid % 64))) == 0)
+      {
+        ++bid;
+        continue;
+      }
+      if(!_nonseekable.has_room(1))
+      {
+        return false;
+      }
+      uint32_t end = bid + 1;
+      while(end < group->count && (group->returned[end / 64] & ((uint64_t) 1 << (end % 64))) != 0)
+      {
+        ++end;
+      }
+      auto *sqe = _nonseekable.get_sqe();
+      sqe->opcode = _IORING_OP_PROVIDE_BUFFERS;
+      sqe->fd = (int32_t)(end - bid);
+      sqe->addr = (uint64_t)(uintptr_t)(group->data() + bid * group->buffer_size);
+      sqe->len = (uint32_t) group->buffer_size;
+      sqe->off = bid;
+      sqe->buf_group = group->gid;
+      sqe->user_data = 0;  // ignored upon completion, if it failed reads fail with ENOBUFS
+      for(; bid < end; bid++)
+      {
+        group->returned[bid / 64] &= ~((uint64_t) 1 << (bid % 64));
+      }
+    }
+    group->any_returned = false;
+    return true;
+  }
+
+  static result<void> _init_ring(_ring_t &ring, const multiplexer_linux_io_uring_config &config, uint32_t flags, int wq_fd) noexcept
+  {
+    _io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = flags;
+    if(config.completion_entries > 0)
+    {
+      params.flags |= _IORING_SETUP_CQSIZE;
+      params.cq_entries = config.completion_entries;
+    }
+    if(wq_fd != -1)
+    {
+      params.flags |= _IORING_SETUP_ATTACH_WQ;
+      params.wq_fd = (uint32_t) wq_fd;
+    }
+    if(config.submission_polling)
+    {
+      params.flags |= _IORING_SETUP_SQPOLL;
+      params.sq_thread_idle = config.submission_polling_idle_ms;  // milliseconds before the kernel thread sleeps
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      if(config.submission_polling_cpu >= 0)
+      {
+        params.flags |= _IORING_SETUP_SQ_AFF;
+        params.sq_thread_cpu = (uint32_t) config.submission_polling_cpu;
+      }
+      // If this thread is pinned to a single CPU, pin the kernel submission thread there too
+      else if(-1 != ::sched_getaffinity(0, sizeof(cpus), &cpus) && CPU_COUNT(&cpus) == 1)
+      {
+        for(int n = 0; n < CPU_SETSIZE; n++)
+        {
+          if(CPU_ISSET(n, &cpus))
+          {
+            params.flags |= _IORING_SETUP_SQ_AFF;
+            params.sq_thread_cpu = n;
+            break;
+          }
+        }
+      }
+    }
+    ring.fd = _io_uring_setup(config.submission_entries, &params);
+    if(ring.fd < 0)
+    {
+      ring.fd = -1;
+      return posix_error();
+    }
+    ring.is_polling = config.submission_polling;
+
+    const size_t sqringbytes = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    auto *sqring = ::mmap(nullptr, sqringbytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, _IORING_OFF_SQ_RING);
+    if(MAP_FAILED == sqring)
+    {
+      return posix_error();
+    }
+    ring.submission.ring = {(byte *) sqring, sqringbytes};
+    const size_t sqesbytes = params.sq_entries * sizeof(_io_uring_sqe);
+    auto *sqes = ::mmap(nullptr, sqesbytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, _IORING_OFF_SQES);
+    if(MAP_FAILED == sqes)
+    {
+      return posix_error();
+    }
+    ring.submission.entries_map = {(byte *) sqes, sqesbytes};
+    const size_t cqringbytes = params.cq_off.cqes + params.cq_entries * sizeof(_io_uring_cqe);
+    auto *cqring = ::mmap(nullptr, cqringbytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, _IORING_OFF_CQ_RING);
+    if(MAP_FAILED == cqring)
+    {
+      return posix_error();
+    }
+    ring.completion.ring = {(byte *) cqring, cqringbytes};
+
+    auto *sqbase = (byte *) sqring;
+    ring.submission.head = (uint32_t *) (sqbase + params.sq_off.head);
+    ring.submission.tail = (uint32_t *) (sqbase + params.sq_off.tail);
+    ring.submission.flags = (uint32_t *) (sqbase + params.sq_off.flags);
+    ring.submission.array = (uint32_t *) (sqbase + params.sq_off.array);
+    ring.submission.ring_mask = *(uint32_t *) (sqbase + params.sq_off.ring_mask);
+    ring.submission.ring_entries = *(uint32_t *) (sqbase + params.sq_off.ring_entries);
+    ring.submission.local_tail = *ring.submission.tail;
+    ring.submission.entries = (_io_uring_sqe *) sqes;
+    auto *cqbase = (byte *) cqring;
+    ring.completion.head = (uint32_t *) (cqbase + params.cq_off.head);
+    ring.completion.tail = (uint32_t *) (cqbase + params.cq_off.tail);
+    ring.completion.ring_mask = *(uint32_t *) (cqbase + params.cq_off.ring_mask);
+    ring.completion.ring_entries = *(uint32_t *) (cqbase + params.cq_off.ring_entries);
+    ring.completion.entries = (_io_uring_cqe *) (cqbase + params.cq_off.cqes);
+    return success();
+  }
+  static void _close_ring(_ring_t &ring) noexcept
+  {
+    if(!ring.completion.ring.empty())
+    {
+      ::munmap(ring.completion.ring.data(), ring.completion.ring.size());
+    }
+    if(!ring.submission.entries_map.empty())
+    {
+      ::munmap(ring.submission.entries_map.data(), ring.submission.entries_map.size());
+    }
+    if(!ring.submission.ring.empty())
+    {
+      ::munmap(ring.submission.ring.data(), ring.submission.ring.size());
+    }
+    if(ring.fd != -1)
+    {
+      ::close(ring.fd);
+    }
+    ring = _ring_t();
+  }
+
+  // Submits any filled submission queue entries to the kernel, optionally flushing completions
+  static result<void> _enter(_ring_t &ring, bool getevents) noexcept
+  {
+    ring.publish();
+    const uint32_t to_submit = ring.submission.local_tail - _io_uring_smp_load_acquire(*ring.submission.head);
+    unsigned flags = 0;
+    if(getevents && ring.inflight > 0)
+    {
+      flags |= _IORING_ENTER_GETEVENTS;
+    }
+    if(ring.is_polling)
+    {
+      // The kernel thread consumes the submission queue by itself, it only needs waking if it went to sleep
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if((_io_uring_smp_load_acquire(*ring.submission.flags) & _IORING_SQ_NEED_WAKEUP) != 0)
+      {
+        flags |= _IORING_ENTER_SQ_WAKEUP;
+      }
+      if(flags == 0)
+      {
+        return success();
+      }
+    }
+    else if(to_submit == 0 && flags == 0)
+    {
+      return success();
+    }
+    if(_io_uring_enter(ring.fd, to_submit, 0, flags) < 0)
+    {
+      if(EINTR != errno && EAGAIN != errno && EBUSY != errno)
+      {
+        return posix_error();
+      }
+    }
+    return success();
+  }
+
+  // Submits the filled entries of every io_uring to the kernel, optionally flushing completions.
+  // Must be called with the lock held.
+  result<void> _enter_all(bool getevents) noexcept
+  {
+    OUTCOME_TRY(_enter(_nonseekable, getevents));
+    OUTCOME_TRY(_enter(_seekable, getevents));
+    if(_polled.fd != -1)
+    {
+      OUTCOME_TRY(_enter(_polled, getevents));
+      // Nothing wakes threads sleeping upon the other io_urings when completion polled i/o
+      // completes, so have them spin instead
+      if(_polled.inflight > 0 && _sleepers > 0)
+      {
+        OUTCOME_TRY(_signal_wakefd());
+      }
+    }
+    return success();
+  }
+
+  // The number of submission queue entries the next submission of the operation needs
+  static uint32_t _sqes_needed(const _io_uring_operation_state *state) noexcept { return 1 + (state->needs_poll ? 1 : 0) + (state->has_deadline() ? 1 : 0); }
+  // Fills a linked timeout entry bounding the preceding entry by the operation's deadline
+  static _io_uring_sqe *_prep_link_timeout(_ring_t &ring, _io_uring_operation_state *state) noexcept
+  {
+    auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(state->expiry - std::chrono::steady_clock::now()).count();
+    if(remaining < 0)
+    {
+      remaining = 0;
+    }
+    state->timeout.tv_sec = remaining / 1000000000;
+    state->timeout.tv_nsec = remaining % 1000000000;
+    auto *sqe = ring.get_sqe();
+    sqe->opcode = _IORING_OP_LINK_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t) &state->timeout;
+    sqe->len = 1;
+    sqe->user_data = (uint64_t)(uintptr_t) state | 2;  // second bit tags the linked timeout
+    ++state->cqes_outstanding;
+    return sqe;
+  }
+  // Fills submission queue entries for the operation. Must be called with the lock held.
+  // The kernel's encoding of an i/o priority, the class in the top three bits
+  static uint16_t _ioprio(io_priority priority) noexcept
+  {
+    if(!priority)
+    {
+      return 0;
+    }
+    return (uint16_t)(((unsigned) priority.priority_class << 13) | std::min(priority.level, (uint8_t) 7));
+  }
+  // The kernel's per i/o flags for the flags of a request
+  static uint32_t _rw_flags(io_flag flags, bool is_write) noexcept
+  {
+    uint32_t ret = 0;
+    if(flags & io_flag::nowait)
+    {
+      ret |= _RWF_NOWAIT;
+    }
+    if(is_write)
+    {
+      if(flags & io_flag::data_sync)
+      {
+        ret |= _RWF_DSYNC;
+      }
+      if(flags & io_flag::sync)
+      {
+        ret |= _RWF_SYNC;
+      }
+      if(flags & io_flag::append)
+      {
+        ret |= _RWF_APPEND;
+      }
+    }
+    return ret;
+  }
+  // The buffers of a scatter-gather list the next submission of the i/o transfers, at most IOV_MAX
+  template <class BuffersType> static size_t _batch_buffers(const _io_uring_operation_state *state, const BuffersType &buffers) noexcept
+  {
+    return std::min(buffers.size() - state->iov_done, (size_t) IOV_MAX);
+  }
+  // If the completed submission of a scatter-gather list longer than IOV_MAX transferred all of its batch,
+  // and more of the list remains, accounts for the batch and returns true. A short read from a non-seekable
+  // handle is a legitimate completion, so their lists are never resubmitted.
+  static bool _next_batch(_io_uring_operation_state *state) noexcept
+  {
+    auto &nc = state->payload.noncompleted;
+    if(state->res <= 0 || state->is_fixed_buffer || state->buffer_group != nullptr)
+    {
+      return false;
+    }
+    auto next = [&](const auto &buffers) {
+      const size_t count = _batch_buffers(state, buffers);
+      if(state->iov_done + count >= buffers.size())
+      {
+        return false;
+      }
+      extent_type bytes = 0;
+      for(size_t n = state->iov_done; n < state->iov_done + count; n++)
+      {
+        bytes += buffers[n].size();
+      }
+      if((extent_type) state->res < bytes)
+      {
+        return false;
+      }
+      state->iov_done += (uint32_t) count;
+      state->bytes_done += bytes;
+      return true;
+    };
+    switch(state->initiated)
+    {
+    case io_operation_state_type::read_initiated:
+      return state->is_seekable && next(nc.params.read.reqs.buffers);
+    case io_operation_state_type::write_initiated:
+      return next(nc.params.write.reqs.buffers);
+    default:
+      return false;
+    }
+  }
+  void _prep(_ring_t &ring, _io_uring_operation_state *state) noexcept
+  {
+    auto &nc = state->payload.noncompleted;
+    state->poll_result = 0;
+    state->is_poll_linked = false;
+    state->cqes_outstanding = 1;
+    if(state->needs_poll)
+    {
+      auto *sqe = ring.get_sqe();
+      sqe->opcode = _IORING_OP_POLL_ADD;
+      sqe->flags = _IOSQE_IO_LINK;
+      sqe->fd = state->fd;
+      sqe->poll_events = (state->initiated == io_operation_state_type::read_initiated) ? POLLIN : POLLOUT;
+      sqe->user_data = (uint64_t)(uintptr_t) state | 1;  // bottom bit tags the linked poll
+      state->needs_poll = false;
+      state->is_poll_linked = true;
+      state->cqes_outstanding = 2;
+      if(state->has_deadline())
+      {
+        // The wait for readiness is what needs bounding, if it fires the i/o never happens
+        _prep_link_timeout(ring, state)->flags = _IOSQE_IO_LINK;
+      }
+    }
+    auto *sqe = ring.get_sqe();
+    sqe->fd = state->fd;
+    switch(state->initiated)
+    {
+    case io_operation_state_type::read_initiated:
+      state->selected_buffer = -1;
+      if(state->buffer_group != nullptr)
+      {
+        // The kernel selects a buffer from the group once there is something to read
+        sqe->opcode = _IORING_OP_READ;
+        sqe->flags = _IOSQE_BUFFER_SELECT;
+        sqe->len = (uint32_t) std::min(nc.params.read.reqs.buffers[0].size(), state->buffer_group->buffer_size);
+        sqe->buf_group = state->buffer_group->gid;
+      }
+      else if(state->is_fixed_buffer)
+      {
+        sqe->opcode = _IORING_OP_READ_FIXED;
+        sqe->addr = (uint64_t)(uintptr_t) nc.params.read.reqs.buffers[0].data();
+        sqe->len = (uint32_t) nc.params.read.reqs.buffers[0].size();
+        sqe->buf_index = 0;
+      }
+      else
+      {
+        sqe->opcode = _IORING_OP_READV;
+        sqe->addr = (uint64_t)(uintptr_t)(nc.params.read.reqs.buffers.data() + state->iov_done);
+        sqe->len = (uint32_t) _batch_buffers(state, nc.params.read.reqs.buffers);
+      }
+      sqe->off = state->is_seekable ? (nc.params.read.reqs.offset + state->bytes_done) : 0;
+      break;
+    case io_operation_state_type::write_initiated:
+      if(state->is_fixed_buffer)
+      {
+        sqe->opcode = _IORING_OP_WRITE_FIXED;
+        sqe->addr = (uint64_t)(uintptr_t) nc.params.write.reqs.buffers[0].data();
+        sqe->len = (uint32_t) nc.params.write.reqs.buffers[0].size();
+        sqe->buf_index = 0;
+      }
+      else
+      {
+        sqe->opcode = _IORING_OP_WRITEV;
+        sqe->addr = (uint64_t)(uintptr_t)(nc.params.write.reqs.buffers.data() + state->iov_done);
+        sqe->len = (uint32_t) _batch_buffers(state, nc.params.write.reqs.buffers);
+      }
+      if(state->is_seekable)
+      {
+        sqe->off = nc.params.write.reqs.offset + state->bytes_done;
+      }
+      break;
+    case io_operation_state_type::barrier_initiated:
+    {
+      extent_type bytes = 0;
+      for(const auto &req : nc.params.barrier.reqs.buffers)
+      {
+        bytes += req.size();
+      }
+      sqe->off = nc.params.barrier.reqs.offset;
+      sqe->len = (bytes > UINT32_MAX) ? 0 : (uint32_t) bytes;  // zero means to the end of the file
+      if(nc.params.barrier.kind <= barrier_kind::wait_data_only && _has_sync_file_range)
+      {
+        // As per the synchronous implementation, only the dirty pages in the range are flushed
+        sqe->opcode = _IORING_OP_SYNC_FILE_RANGE;
+        sqe->sync_range_flags = _SYNC_FILE_RANGE_WRITE;
+        if(nc.params.barrier.kind == barrier_kind::wait_data_only || nc.params.barrier.kind == barrier_kind::wait_view_only)
+        {
+          sqe->sync_range_flags |= _SYNC_FILE_RANGE_WAIT_BEFORE | _SYNC_FILE_RANGE_WAIT_AFTER;
+        }
+        break;
+      }
+      sqe->opcode = _IORING_OP_FSYNC;
+      if(nc.params.barrier.kind <= barrier_kind::wait_data_only)
+      {
+        sqe->fsync_flags = _IORING_FSYNC_DATASYNC;
+      }
+      break;
+    }
+    default:
+      abort();
+    }
+    if(state->initiated != io_operation_state_type::barrier_initiated)
+    {
+      // Older kernels refuse a priority upon syncs
+      sqe->ioprio = state->ioprio;
+      sqe->rw_flags = (state->initiated == io_operation_state_type::read_initiated) ? _rw_flags(nc.params.read.reqs.flags, false) :
+                                                                                     _rw_flags(nc.params.write.reqs.flags, true);
+    }
+    sqe->user_data = (uint64_t)(uintptr_t) state;
+    if(state->has_deadline() && !state->is_poll_linked)
+    {
+      sqe->flags |= _IOSQE_IO_LINK;
+      _prep_link_timeout(ring, state);
+    }
+    state->location = _io_uring_operation_state::location_t::submitted;
+  }
+  // Fills a submission queue entry to cancel the operation. Must be called with the lock held.
+  bool _prep_cancel(_io_uring_operation_state *state) noexcept
+  {
+    auto &ring = _ring_for(state);
+    if(!ring.has_room(state->is_poll_linked ? 2 : 1))
+    {
+      return false;
+    }
+    auto *sqe = ring.get_sqe();
+    sqe->opcode = _IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t) state;
+    sqe->user_data = 0;  // ignored upon completion
+    if(state->is_poll_linked)
+    {
+      // If the linked poll is still pending, the i/o has not been issued yet and cannot be found
+      sqe = ring.get_sqe();
+      sqe->opcode = _IORING_OP_ASYNC_CANCEL;
+      sqe->fd = -1;
+      sqe->addr = (uint64_t)(uintptr_t) state | 1;
+      sqe->user_data = 0;
+    }
+    return true;
+  }
+  // Fills a submission queue entry with a filesystem syscall. Must be called with the lock held.
+  void _prep_syscall(syscall_operation_state *op) noexcept
+  {
+    auto *sqe = _nonseekable.get_sqe();
+    switch(op->kind)
+    {
+    case syscall_operation_kind::openat:
+      sqe->opcode = _IORING_OP_OPENAT;
+      sqe->fd = op->fd;
+      sqe->addr = (uint64_t)(uintptr_t) op->path;
+      sqe->len = op->mode;
+      sqe->open_flags = (uint32_t) op->flags;
+      break;
+    case syscall_operation_kind::close:
+      sqe->opcode = _IORING_OP_CLOSE;
+      sqe->fd = op->fd;
+      break;
+    case syscall_operation_kind::statx:
+      sqe->opcode = _IORING_OP_STATX;
+      sqe->fd = op->fd;
+      sqe->addr = (uint64_t)(uintptr_t) op->path;
+      sqe->len = op->mode;
+      sqe->off = (uint64_t)(uintptr_t) op->buffer;
+      sqe->statx_flags = (uint32_t) op->flags;
+      break;
+    case syscall_operation_kind::getdents:
+      break;  // io_uring has no opcode, so this goes to the syscall worker instead
+    }
+    // Bit 2 distinguishes syscalls from i/o, as both are at least eight byte aligned
+    sqe->user_data = (uint64_t)(uintptr_t) op | 4;
+  }
+  // Signals the eventfd, waking anybody sleeping in poll(). Unlike a completion posted to
+  // an io_uring, another thread cannot consume this before the sleepers see it, as it is
+  // only reset by a thread about to sleep when nobody else is. Must be called with the lock held.
+  result<void> _signal_wakefd() noexcept
+  {
+    if(!_wakefd_set)
+    {
+      if(-1 == ::eventfd_write(_wakefd, 1))
+      {
+        return posix_error();
+      }
+      _wakefd_set = true;
+    }
+    return success();
+  }
+  // Resets the eventfd. Must be called with the lock held.
+  void _reset_wakefd() noexcept
+  {
+    if(_wakefd_set)
+    {
+      eventfd_t v;
+      (void) ::eventfd_read(_wakefd, &v);
+      _wakefd_set = false;
+    }
+  }
+  // Resets the eventfd registered with the io_urings before reaping, re-signalling it
+  // afterwards if anything was left unreaped. Must be called with the lock held.
+  void _reset_notifyfd() noexcept
+  {
+    eventfd_t v;
+    (void) ::eventfd_read(_notifyfd, &v);
+  }
+  void _renotify_if_unreaped() noexcept
+  {
+    auto unreaped = [](_ring_t &ring) { return ring.fd != -1 && *ring.completion.head != _io_uring_smp_load_acquire(*ring.completion.tail); };
+    // Completion polled i/o completes only when asked about, so the caller must keep asking
+    if(unreaped(_nonseekable) || unreaped(_seekable) || unreaped(_polled) || _polled.inflight > 0 || _syscall_worker.has_completed())
+    {
+      (void) ::eventfd_write(_notifyfd, 1);
+    }
+  }
+  // The pending list the i/o waits upon for room in its io_uring
+  _queue_t &_pending_for(const _io_uring_operation_state *state) noexcept { return state->is_high_priority ? _pending_high_priority : _pending; }
+  // Makes non-seekable i/o pending, unless i/o of its kind upon its handle is already pending
+  // or submitted, in which case it queues behind that. Must be called with the lock held.
+  void _pend_or_queue(_io_uring_operation_state *state) noexcept
+  {
+    auto *rfd = _find_registered_fd(state->fd);
+    if(rfd != nullptr)
+    {
+      const bool is_read = (state->initiated == io_operation_state_type::read_initiated);
+      auto *&inprogress = is_read ? rfd->inprogress_read : rfd->inprogress_write;
+      if(inprogress != nullptr)
+      {
+        state->location = _io_uring_operation_state::location_t::queued;
+        (is_read ? rfd->queued_reads : rfd->queued_writes).push_back(state);
+        return;
+      }
+      inprogress = state;
+    }
+    state->location = _io_uring_operation_state::location_t::pending;
+    _pending_for(state).push_back(state);
+  }
+  // Called when non-seekable i/o which was pending or submitted is leaving the multiplexer,
+  // making the next i/o of its kind queued upon its handle pending. Must be called with the lock held.
+  void _release_inprogress(_io_uring_operation_state *state) noexcept
+  {
+    auto *rfd = _find_registered_fd(state->fd);
+    if(rfd == nullptr)
+    {
+      return;
+    }
+    const bool is_read = (state->initiated == io_operation_state_type::read_initiated);
+    auto *&inprogress = is_read ? rfd->inprogress_read : rfd->inprogress_write;
+    if(inprogress != state)
+    {
+      return;
+    }
+    auto &queued = is_read ? rfd->queued_reads : rfd->queued_writes;
+    inprogress = queued.first;
+    if(inprogress != nullptr)
+    {
+      queued.remove(inprogress);
+      inprogress->location = _io_uring_operation_state::location_t::pending;
+      _pending_for(inprogress).push_back(inprogress);
+    }
+  }
+  // Removes i/o which has not been submitted yet from the multiplexer. Must be called with the lock held.
+  void _remove_unsubmitted(_io_uring_operation_state *state) noexcept
+  {
+    if(state->location == _io_uring_operation_state::location_t::queued)
+    {
+      auto *rfd = _find_registered_fd(state->fd);
+      assert(rfd != nullptr);
+      (state->initiated == io_operation_state_type::read_initiated ? rfd->queued_reads : rfd->queued_writes).remove(state);
+    }
+    else if(state->location == _io_uring_operation_state::location_t::pending)
+    {
+      _pending_for(state).remove(state);
+      if(!state->is_seekable)
+      {
+        _release_inprogress(state);
+      }
+    }
+    _remove_from_inode(state);
+    this->_deadlines.remove(state);
+  }
+  // Removes seekable i/o from its inode, making any i/o blocked only by it pending. Must be called with the lock held.
+  void _remove_from_inode(_io_uring_operation_state *state) noexcept
+  {
+    if(state->inode == nullptr)
+    {
+      return;
+    }
+    state->inode->remove(state, [this](_io_uring_operation_state *released) {
+      assert(released->location == _io_uring_operation_state::location_t::blocked);
+      released->location = _io_uring_operation_state::location_t::pending;
+      _pending_for(released).push_back(released);
+    });
+    state->inode = nullptr;
+  }
+  // Moves as many pending operations as possible into the submission queues. Must be called with the lock held.
+  void _submit_pending() noexcept
+  {
+    while(!_deferred_cancels.empty() && _prep_cancel(_deferred_cancels.back()))
+    {
+      _deferred_cancels.pop_back();
+    }
+    // Buffers go to the kernel ahead of any read which could select them. The removal of a
+    // destroyed group's buffers must precede providing buffers to a new group reusing its id.
+    while(!_removed_buffer_groups.empty() && _nonseekable.has_room(1))
+    {
+      auto *sqe = _nonseekable.get_sqe();
+      sqe->opcode = _IORING_OP_REMOVE_BUFFERS;
+      sqe->fd = (int32_t) _removed_buffer_groups.back().second;
+      sqe->buf_group = _removed_buffer_groups.back().first;
+      sqe->user_data = 0;
+      _removed_buffer_groups.pop_back();
+    }
+    if(_removed_buffer_groups.empty())
+    {
+      for(auto *group : _buffer_groups)
+      {
+        if(group->any_returned && !_prep_provide_buffers(group))
+        {
+          break;
+        }
+      }
+    }
+    while(_pending_syscalls_first != nullptr && _nonseekable.has_room(1))
+    {
+      auto *op = _pending_syscalls_first;
+      _pending_syscalls_first = op->_next;
+      if(_pending_syscalls_first == nullptr)
+      {
+        _pending_syscalls_last = nullptr;
+      }
+      op->_next = nullptr;
+      _prep_syscall(op);
+    }
+    // High priority i/o gets the room in the rings first. Once a ring is full, don't let later
+    // operations overtake earlier ones. This is checked first so a long pending list costs no more
+    // than a walk once the ring has filled.
+    bool nonseekable_full = false, seekable_full = false, polled_full = false;
+    for(auto *pending : {&_pending_high_priority, &_pending})
+    {
+      for(auto *state = pending->first; state != nullptr;)
+      {
+        auto *next = state->next;
+        auto &ring = _ring_for(state);
+        bool &full = state->is_polled ? polled_full : (state->is_seekable ? seekable_full : nonseekable_full);
+        if(full || !ring.has_room(_sqes_needed(state)))
+        {
+          full = true;
+          state = next;
+          continue;
+        }
+        pending->remove(state);
+        _prep(ring, state);
+        state = next;
+      }
+    }
+    _nonseekable.publish();
+    _seekable.publish();
+    if(_polled.fd != -1)
+    {
+      _polled.publish();
+    }
+  }
+  // Reaps up to max i/o completions from the ring, prepending any syscalls completed to the
+  // syscalls list. Must be called with the lock held.
+  size_t _reap(_ring_t &ring, _io_uring_operation_state **out, size_t max, syscall_operation_state *&syscalls) noexcept
+  {
+    size_t count = 0;
+    uint32_t head = *ring.completion.head;
+    const uint32_t tail = _io_uring_smp_load_acquire(*ring.completion.tail);
+    for(; head != tail && count < max; ++head)
+    {
+      const _io_uring_cqe &cqe = ring.completion.entries[head & ring.completion.ring_mask];
+      --ring.inflight;
+      if(cqe.user_data == 0)
+      {
+        continue;  // cancellations
+      }
+      if((cqe.user_data & 4) != 0)
+      {
+        auto *op = (syscall_operation_state *) (uintptr_t)(cqe.user_data & ~(uint64_t) 7);
+        op->result = cqe.res;
+        op->_next = syscalls;
+        syscalls = op;
+        continue;
+      }
+      auto *state = (_io_uring_operation_state *) (uintptr_t)(cqe.user_data & ~(uint64_t) 3);
+      if((cqe.user_data & 1) != 0)
+      {
+        // Completion of a linked poll. If it failed, the linked i/o completes with ECANCELED.
+        if(cqe.res < 0)
+        {
+          state->poll_result = cqe.res;
+        }
+      }
+      else if((cqe.user_data & 2) != 0)
+      {
+        // Completion of a linked timeout. If it fired, what it was linked to completes with ECANCELED.
+        if(-ETIME == cqe.res)
+        {
+          state->timed_out = true;
+        }
+      }
+      else
+      {
+        state->res = cqe.res;
+        if((cqe.flags & _IORING_CQE_F_BUFFER) != 0)
+        {
+          const auto bid = cqe.flags >> _IORING_CQE_BUFFER_SHIFT;
+          if(cqe.res > 0)
+          {
+            state->selected_buffer = (int) bid;
+            state->buffer_group->selected[bid / 64] |= (uint64_t) 1 << (bid % 64);
+          }
+          else
+          {
+            // Older kernels consume the buffer even if nothing was read into it
+            _return_selected_buffer(state->buffer_group, bid);
+          }
+        }
+      }
+      if(--state->cqes_outstanding > 0)
+      {
+        continue;
+      }
+      if(state->cancelled)
+      {
+        auto it = std::find(_deferred_cancels.begin(), _deferred_cancels.end(), state);
+        if(it != _deferred_cancels.end())
+        {
+          _deferred_cancels.erase(it);
+        }
+        if(-EAGAIN == state->res)
+        {
+          state->res = -ECANCELED;
+        }
+      }
+      else
+      {
+        if(-ECANCELED == state->res && state->poll_result < 0)
+        {
+          state->res = state->poll_result;
+        }
+        if(-ECANCELED == state->res && state->timed_out)
+        {
+          state->res = -ETIMEDOUT;
+        }
+        if(-EOPNOTSUPP == state->res && state->is_polled)
+        {
+          // The filesystem or device cannot be polled, so resubmit this and all later i/o
+          // upon the handle to the ordinary seekable io_uring, ahead of any later i/o
+          auto *rfd = _find_registered_fd(state->fd);
+          if(rfd != nullptr)
+          {
+            rfd->not_pollable = true;
+          }
+          state->is_polled = false;
+          state->location = _io_uring_operation_state::location_t::pending;
+          _pending_for(state).push_front(state);
+          continue;
+        }
+        if(-EOPNOTSUPP == state->res && state->is_nowait)
+        {
+          // The filesystem cannot tell if the i/o would block, which is as good as it would
+          state->res = -EAGAIN;
+        }
+        if(-EPERM == state->res && (state->ioprio >> 13) == (uint16_t) io_priority_class::realtime)
+        {
+          // Realtime i/o needs privilege this process lacks, so resubmit as the highest best effort
+          state->ioprio = _ioprio(io_priority(io_priority_class::best_effort, 0));
+          state->location = _io_uring_operation_state::location_t::pending;
+          _pending_for(state).push_front(state);
+          continue;
+        }
+        if(-EAGAIN == state->res && !state->is_seekable && !state->is_nowait)
+        {
+          if(state->has_deadline() && state->expiry <= std::chrono::steady_clock::now())
+          {
+            state->res = -ETIMEDOUT;
+          }
+          else
+          {
+            // Resubmit after the handle becomes ready, ahead of any later i/o
+            state->needs_poll = true;
+            state->location = _io_uring_operation_state::location_t::pending;
+            _pending_for(state).push_front(state);
+            continue;
+          }
+        }
+        if(_next_batch(state))
+        {
+          // Submit the next batch of the list ahead of any later i/o
+          state->location = _io_uring_operation_state::location_t::pending;
+          _pending_for(state).push_front(state);
+          continue;
+        }
+      }
+      if(!state->is_seekable)
+      {
+        _release_inprogress(state);
+      }
+      _remove_from_inode(state);
+      this->_deadlines.remove(state);
+      state->location = _io_uring_operation_state::location_t::completing;
+      out[count++] = state;
+    }
+    _io_uring_smp_store_release(*ring.completion.head, head);
+    return count;
+  }
+
+  // bytes_done is what earlier submissions of a list longer than IOV_MAX transferred, a failure after
+  // which is reported as a short transfer
+  template <class BuffersType> static io_result<BuffersType> _result_from_cqe(BuffersType buffers, int res, extent_type bytes_done = 0) noexcept
+  {
+    if(res < 0 && bytes_done == 0)
+    {
+      return posix_error(-res);
+    }
+    auto bytes = static_cast<size_type>(bytes_done + std::max(res, 0));
+    for(size_t i = 0; i < buffers.size(); i++)
+    {
+      auto &buffer = buffers[i];
+      if(buffer.size() <= bytes)
+      {
+        bytes -= buffer.size();
+      }
+      else
+      {
+        buffer = {buffer.data(), bytes};
+        buffers = {buffers.data(), i + 1};
+        break;
+      }
+    }
+    return {buffers};
+  }
+  static io_operation_state_type _read_finish(_io_uring_operation_state *state, io_result<buffers_type> &&res) noexcept
+  {
+    state->read_completed(std::move(res));
+    state->read_finished();
+    return io_operation_state_type::read_finished;
+  }
+  static io_operation_state_type _write_finish(_io_uring_operation_state *state, io_result<const_buffers_type> &&res) noexcept
+  {
+    state->write_completed(std::move(res));
+    state->write_or_barrier_finished();
+    return io_operation_state_type::write_or_barrier_finished;
+  }
+  static io_operation_state_type _barrier_finish(_io_uring_operation_state *state, io_result<const_buffers_type> &&res) noexcept
+  {
+    state->barrier_completed(std::move(res));
+    state->write_or_barrier_finished();
+    return io_operation_state_type::write_or_barrier_finished;
+  }
+  // Invokes the visitor with the result of the completion. Must be called without the lock held.
+  static io_operation_state_type _complete(_io_uring_operation_state *state) noexcept
+  {
+    auto &nc = state->payload.noncompleted;
+    state->location = _io_uring_operation_state::location_t::none;
+    switch(state->initiated)
+    {
+    case io_operation_state_type::read_initiated:
+      if(state->buffer_group != nullptr && state->res >= 0)
+      {
+        // Point the buffer at whichever buffer the kernel selected, a read of nothing selects none
+        auto &buffer = nc.params.read.reqs.buffers[0];
+        buffer = (state->selected_buffer < 0) ? buffer_type(nullptr, 0) :
+                                                buffer_type(state->buffer_group->data() + (size_t) state->selected_buffer * state->buffer_group->buffer_size, (size_t) state->res);
+        return _read_finish(state, io_result<buffers_type>(nc.params.read.reqs.buffers));
+      }
+      return _read_finish(state, _result_from_cqe(nc.params.read.reqs.buffers, state->res, state->bytes_done));
+    case io_operation_state_type::write_initiated:
+      return _write_finish(state, _result_from_cqe(nc.params.write.reqs.buffers, state->res, state->bytes_done));
+    case io_operation_state_type::barrier_initiated:
+      if(state->res < 0)
+      {
+        return _barrier_finish(state, io_result<const_buffers_type>(posix_error(-state->res)));
+      }
+      return _barrier_finish(state, io_result<const_buffers_type>(nc.params.barrier.reqs.buffers));
+    default:
+      abort();
+    }
+  }
+
+public:
+  constexpr linux_io_uring_multiplexer() {}
+  linux_io_uring_multiplexer(const linux_io_uring_multiplexer &) = delete;
+  linux_io_uring_multiplexer(linux_io_uring_multiplexer &&) = delete;
+  linux_io_uring_multiplexer &operator=(const linux_io_uring_multiplexer &) = delete;
+  linux_io_uring_multiplexer &operator=(linux_io_uring_multiplexer &&) = delete;
+  virtual ~linux_io_uring_multiplexer()
+  {
+    if(this->_v)
+    {
+      (void) linux_io_uring_multiplexer::close();
+    }
+  }
+  result<void> init(const multiplexer_linux_io_uring_config &config)
+  {
+    auto r = [&]() -> result<void> {
+      int wq_fd = (config.share_worker_pool_with != nullptr) ? config.share_worker_pool_with->native_handle().fd : -1;
+      OUTCOME_TRY(_init_ring(_nonseekable, config, 0, wq_fd));
+      if(config.share_worker_pool && wq_fd == -1)
+      {
+        wq_fd = _nonseekable.fd;
+      }
+      OUTCOME_TRY(_init_ring(_seekable, config, 0, wq_fd));
+      if(config.completion_polling)
+      {
+        OUTCOME_TRY(_init_ring(_polled, config, _IORING_SETUP_IOPOLL, wq_fd));
+      }
+      OUTCOME_TRY(_syscall_worker.init());
+      _wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if(-1 == _wakefd)
+      {
+        return posix_error();
+      }
+      return success();
+    }();
+    if(!r)
+    {
+      _close_ring(_polled);
+      _close_ring(_seekable);
+      _close_ring(_nonseekable);
+      return r;
+    }
+    {
+      // Kernels before 5.6 cannot be probed for supported operations, so treat them as not supporting
+      // anything optional
+      alignas(_io_uring_probe) byte buffer[sizeof(_io_uring_probe) + _IORING_OP_LAST * sizeof(_io_uring_probe_op)];
+      memset(buffer, 0, sizeof(buffer));
+      auto *probe = reinterpret_cast<_io_uring_probe *>(buffer);
+      if(_io_uring_register(_seekable.fd, _IORING_REGISTER_PROBE, probe, _IORING_OP_LAST) >= 0)
+      {
+        auto supported = [probe](uint8_t op) { return (op < probe->ops_len) && (probe->ops[op].flags & _IO_URING_OP_SUPPORTED) != 0; };
+        _has_sync_file_range = supported(_IORING_OP_SYNC_FILE_RANGE);
+        _has_openat = supported(_IORING_OP_OPENAT);
+        _has_close = supported(_IORING_OP_CLOSE);
+        _has_statx = supported(_IORING_OP_STATX);
+        _has_provide_buffers = supported(_IORING_OP_PROVIDE_BUFFERS) && supported(_IORING_OP_READ);
+      }
+    }
+    // The non-seekable io_uring is the native handle of this multiplexer
+    this->_v.fd = _nonseekable.fd;
+    this->_v.behaviour |= native_handle_type::disposition::multiplexer;
+    return success();
+  }
+
+  // These functions are inherited from handle
+  virtual result<path_type> current_path() const noexcept override
+  {
+    return success();  // empty path, means it has been deleted
+  }
+  virtual result<void> close() noexcept override
+  {
+    // handle::close() would refuse to close a multiplexer, and we have two or three io_urings to close in any case
+    _close_ring(_polled);
+    _close_ring(_seekable);
+    _close_ring(_nonseekable);
+    if(_wakefd != -1)
+    {
+      ::close(_wakefd);
+      _wakefd = -1;
+    }
+    if(_notifyfd != -1)
+    {
+      _syscall_worker.set_notify_fd(-1);
+      ::close(_notifyfd);
+      _notifyfd = -1;
+    }
+    this->_v = native_handle_type();
+    _pending = _queue_t();
+    _pending_high_priority = _queue_t();
+    _buffer_pool.reset();  // outstanding registered buffers keep the slab alive
+    _buffer_pool_failed = false;
+    _registered_fds.clear();
+    _inodes.clear();
+    _deferred_cancels.clear();
+    // Outstanding buffer groups keep their memory, but are no longer provided to anything
+    for(auto *group : _buffer_groups)
+    {
+      group->parent = nullptr;
+    }
+    _buffer_groups.clear();
+    _removed_buffer_groups.clear();
+    return success();
+  }
+
+  virtual result<uint8_t> do_io_handle_register(io_handle *h) noexcept override
+  {
+    const auto nativeh = h->native_handle();
+    // Handles without a kernel fd, or which do their i/o in user space, get their i/o
+    // performed synchronously upon initiation. We flag these using _multiplexer_state_bit0.
+    if(nativeh.fd == -1 || this->do_io_handle_max_buffers(h) == 0)
+    {
+      return (uint8_t) 1;
+    }
+    std::pair<dev_t, ino_t> inodeid;
+    if(nativeh.is_seekable())
+    {
+      // i/o to seekable handles is ordered per inode
+      struct stat st;
+      if(-1 == ::fstat(nativeh.fd, &st))
+      {
+        return posix_error();
+      }
+      inodeid = {st.st_dev, st.st_ino};
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    try
+    {
+      auto it = _registered_fd_lower_bound(nativeh.fd);
+      if(it == _registered_fds.end() || it->fd != nativeh.fd)
+      {
+        _inode_t *inode = nullptr;
+        if(nativeh.is_seekable())
+        {
+          inode = &_inodes[inodeid];
+        }
+        it = _registered_fds.insert(it, _registered_fd(nativeh.fd));
+        it->inode = inode;
+        if(inode != nullptr)
+        {
+          ++inode->handles;
+        }
+      }
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+    return (uint8_t) 0;
+  }
+  virtual result<void> do_io_handle_deregister(io_handle *h) noexcept override
+  {
+    const auto nativeh = h->native_handle();
+    if((nativeh.behaviour & native_handle_type::disposition::_multiplexer_state_bit0) != 0)
+    {
+      return success();
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    for(auto *pending : {&_pending_high_priority, &_pending})
+    {
+      for(auto *state = pending->first; state != nullptr; state = state->next)
+      {
+        if(state->h == h)
+        {
+          return errc::operation_in_progress;
+        }
+      }
+    }
+    auto it = _registered_fd_lower_bound(nativeh.fd);
+    if(it != _registered_fds.end() && it->fd == nativeh.fd)
+    {
+      if(it->inprogress_read != nullptr || it->inprogress_write != nullptr)
+      {
+        return errc::operation_in_progress;
+      }
+      if(it->inode != nullptr)
+      {
+        auto is_upon_h = [h](const _io_uring_operation_state *state) { return state->h == h; };
+        if(_inode_t::_tree_any(it->inode->root, is_upon_h))
+        {
+          return errc::operation_in_progress;
+        }
+        if(--it->inode->handles == 0)
+        {
+          for(auto it2 = _inodes.begin(); it2 != _inodes.end(); ++it2)
+          {
+            if(&it2->second == it->inode)
+            {
+              _inodes.erase(it2);
+              break;
+            }
+          }
+        }
+      }
+      _registered_fds.erase(it);
+    }
+    return success();
+  }
+
+  virtual result<registered_buffer_type> do_io_handle_allocate_registered_buffer(io_handle *h, size_t &bytes) noexcept override
+  {
+    const auto nativeh = h->native_handle();
+    if((nativeh.behaviour & native_handle_type::disposition::_multiplexer_state_bit0) == 0 && bytes > 0 && bytes <= _registered_buffer_pool_size)
+    {
+      _multiplexer_lock_guard g(this->_lock);
+      if(!_buffer_pool && !_buffer_pool_failed && _nonseekable.inflight == 0 && _seekable.inflight == 0 && _polled.inflight == 0)
+      {
+        _buffer_pool_failed = !_init_buffer_pool();
+      }
+      if(_buffer_pool)
+      {
+        auto pool = _buffer_pool;
+        g.unlock();
+        const size_t pages = (bytes + pool->page_size - 1) / pool->page_size;
+        const size_t first = pool->allocate(pages);
+        if(first != (size_t) -1)
+        {
+          try
+          {
+            bytes = pages * pool->page_size;
+            return std::make_shared<_registered_buffer>(pool, span<byte>(pool->slab.data() + first * pool->page_size, bytes));
+          }
+          catch(...)
+          {
+            pool->release(first, pages);
+            return error_from_exception();
+          }
+        }
+      }
+    }
+    // Slab is unavailable or exhausted, so allocate unregistered memory
+    return _base::do_io_handle_allocate_registered_buffer(h, bytes);
+  }
+
+  virtual result<registered_buffer_type> allocate_buffer_group(size_t count, size_t bytes) noexcept override
+  {
+    if(!_has_provide_buffers)
+    {
+      return errc::operation_not_supported;
+    }
+    // Buffer ids are sixteen bits
+    if(count == 0 || count > 65535 || bytes == 0 || bytes > INT32_MAX)
+    {
+      return errc::invalid_argument;
+    }
+    // Pages are only allocated once a read selects a buffer
+    const size_t pagesize = utils::page_size();
+    const size_t total = (count * bytes + pagesize - 1) & ~(pagesize - 1);
+    void *p = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(MAP_FAILED == p)
+    {
+      return posix_error();
+    }
+    std::shared_ptr<_buffer_group> ret;
+    try
+    {
+      _multiplexer_lock_guard g(this->_lock);
+      if(_buffer_groups.size() >= 65536)
+      {
+        ::munmap(p, total);
+        return errc::resource_unavailable_try_again;
+      }
+      _buffer_groups.reserve(_buffer_groups.size() + 1);
+      _removed_buffer_groups.reserve(_buffer_groups.size() + _removed_buffer_groups.size() + 1);
+      // Reuse the lowest group id not in use. If a destroyed group's removal is still pending,
+      // it gets submitted before any buffers are provided to this group.
+      uint16_t gid = 0;
+      for(bool clashed = true; clashed;)
+      {
+        clashed = false;
+        for(auto *group : _buffer_groups)
+        {
+          if(group->gid == gid)
+          {
+            ++gid;
+            clashed = true;
+          }
+        }
+      }
+      ret = std::make_shared<_buffer_group>(this, span<byte>((byte *) p, count * bytes), bytes, (uint32_t) count, gid);
+      _buffer_groups.push_back(ret.get());
+      for(uint32_t bid = 0; bid < count; bid++)
+      {
+        _return_selected_buffer(ret.get(), bid);
+      }
+      // The kernel gets told on flush or check, ahead of any read
+      _submit_pending();
+    }
+    catch(...)
+    {
+      ::munmap(p, total);
+      return error_from_exception();
+    }
+    return registered_buffer_type(std::move(ret));
+  }
+  virtual result<void> release_selected_buffer(const registered_buffer_type &base, buffer_type buffer) noexcept override
+  {
+    if(buffer.data() == nullptr)
+    {
+      return success();  // a read of nothing selects no buffer
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    auto *group = _find_buffer_group(base.get());
+    if(group == nullptr || buffer.data() < group->data() || buffer.data() >= group->data() + group->size() ||
+       ((size_t)(buffer.data() - group->data()) % group->buffer_size) != 0)
+    {
+      return errc::invalid_argument;
+    }
+    const auto bid = (uint32_t)((size_t)(buffer.data() - group->data()) / group->buffer_size);
+    const uint64_t bit = (uint64_t) 1 << (bid % 64);
+    if((group->selected[bid / 64] & bit) == 0)
+    {
+      return errc::invalid_argument;  // not selected, or released twice
+    }
+    group->selected[bid / 64] &= ~bit;
+    _return_selected_buffer(group, bid);
+    _submit_pending();
+    return success();
+  }
+
+  virtual std::pair<size_t, size_t> io_state_requirements() noexcept override { return {sizeof(_io_uring_operation_state), alignof(_io_uring_operation_state)}; }
+
+  virtual io_operation_state *construct(span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor, registered_buffer_type &&b, deadline d, io_request<buffers_type> reqs) noexcept override
+  {
+    assert(storage.size() >= sizeof(_io_uring_operation_state));
+    assert(((uintptr_t) storage.data() % alignof(_io_uring_operation_state)) == 0);
+    if(storage.size() < sizeof(_io_uring_operation_state) || ((uintptr_t) storage.data() % alignof(_io_uring_operation_state)) != 0)
+    {
+      return nullptr;
+    }
+    return new(storage.data()) _io_uring_operation_state(_h, _visitor, std::move(b), d, std::move(reqs));
+  }
+  virtual io_operation_state *construct(span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor, registered_buffer_type &&b, deadline d, io_request<const_buffers_type> reqs) noexcept override
+  {
+    assert(storage.size() >= sizeof(_io_uring_operation_state));
+    assert(((uintptr_t) storage.data() % alignof(_io_uring_operation_state)) == 0);
+    if(storage.size() < sizeof(_io_uring_operation_state) || ((uintptr_t) storage.data() % alignof(_io_uring_operation_state)) != 0)
+    {
+      return nullptr;
+    }
+    return new(storage.data()) _io_uring_operation_state(_h, _visitor, std::move(b), d, std::move(reqs));
+  }
+  virtual io_operation_state *construct(span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor, registered_buffer_type &&b, deadline d, io_request<const_buffers_type> reqs, barrier_kind kind) noexcept override
+  {
+    assert(storage.size() >= sizeof(_io_uring_operation_state));
+    assert(((uintptr_t) storage.data() % alignof(_io_uring_operation_state)) == 0);
+    if(storage.size() < sizeof(_io_uring_operation_state) || ((uintptr_t) storage.data() % alignof(_io_uring_operation_state)) != 0)
+    {
+      return nullptr;
+    }
+    return new(storage.data()) _io_uring_operation_state(_h, _visitor, std::move(b), d, std::move(reqs), kind);
+  }
+
+  // Initiates the i/o up to the point of enqueuing it, which requires the lock. Returns a finished state if the i/o completed immediately.
+  io_operation_state_type _init_io_operation_begin(_io_uring_operation_state *state) noexcept
+  {
+    auto s = state->current_state();
+    auto &nc = state->payload.noncompleted;
+    const auto nativeh = state->h->native_handle();
+    if((nativeh.behaviour & native_handle_type::disposition::_multiplexer_state_bit0) != 0)
+    {
+      // This handle cannot be usefully multiplexed, so do the i/o synchronously now
+      switch(s)
+      {
+      case io_operation_state_type::read_initialised:
+        return _read_finish(state, _base::_do_io_handle_read(state->h, std::move(nc.base), nc.params.read.reqs, nc.d));
+      case io_operation_state_type::write_initialised:
+        return _write_finish(state, _base::_do_io_handle_write(state->h, std::move(nc.base), nc.params.write.reqs, nc.d));
+      case io_operation_state_type::barrier_initialised:
+        return _barrier_finish(state, _base::_do_io_handle_barrier(state->h, nc.params.barrier.reqs, nc.params.barrier.kind, nc.d));
+      default:
+        assert(false);
+        return s;
+      }
+    }
+    switch(s)
+    {
+    case io_operation_state_type::read_initialised:
+      if(nc.base && nc.params.read.reqs.buffers.size() == 1 && nc.params.read.reqs.buffers[0].data() == nullptr)
+      {
+        // A read to be given a buffer from a buffer group upon completion
+        _multiplexer_lock_guard g(this->_lock);
+        state->buffer_group = _find_buffer_group(nc.base.get());
+        if(state->buffer_group != nullptr && nativeh.is_seekable())
+        {
+          // The group is provided to the non-seekable io_uring only
+          state->buffer_group = nullptr;
+          return _read_finish(state, io_result<buffers_type>(errc::operation_not_supported));
+        }
+        // Wait for readiness first, else a read which would block may consume a buffer
+        state->needs_poll = (state->buffer_group != nullptr) && !(nc.params.read.reqs.flags & io_flag::nowait);
+      }
+      state->initiated = io_operation_state_type::read_initiated;
+      break;
+    case io_operation_state_type::write_initialised:
+      state->initiated = io_operation_state_type::write_initiated;
+      break;
+    case io_operation_state_type::barrier_initialised:
+      if(!nativeh.is_seekable())
+      {
+        return _barrier_finish(state, io_result<const_buffers_type>(const_buffers_type()));  // nothing was flushed
+      }
+      state->initiated = io_operation_state_type::barrier_initiated;
+      break;
+    default:
+      assert(false);
+      return s;
+    }
+    state->fd = nativeh.fd;
+    state->is_seekable = nativeh.is_seekable();
+    {
+      auto from_request = [&](const auto &reqs) {
+        state->is_high_priority = reqs.priority.is_high();
+        state->ioprio = _ioprio(reqs.priority);
+        state->is_nowait = !!(reqs.flags & io_flag::nowait);
+        state->iov_done = 0;
+        state->bytes_done = 0;
+      };
+      switch(state->initiated)
+      {
+      case io_operation_state_type::read_initiated:
+        from_request(nc.params.read.reqs);
+        break;
+      case io_operation_state_type::write_initiated:
+        from_request(nc.params.write.reqs);
+        break;
+      default:
+        from_request(nc.params.barrier.reqs);
+        break;
+      }
+    }
+    // Only reads and writes can be submitted to the completion polled io_uring, and it cannot
+    // time out i/o
+    state->is_polled = _polled.fd != -1 && state->is_seekable && nativeh.requires_aligned_io() && !nc.d &&
+                       state->initiated != io_operation_state_type::barrier_initiated;
+    if(nc.d)
+    {
+      state->expiry = detail::io_multiplexer_deadline_wheel::to_time_point(nc.d);
+    }
+    const auto ret = state->initiated;
+    // Invoke the visitor before taking the multiplexer lock, as it may call into the multiplexer
+    switch(ret)
+    {
+    case io_operation_state_type::read_initiated:
+      state->read_initiated();
+      break;
+    case io_operation_state_type::write_initiated:
+      state->write_initiated();
+      break;
+    default:
+      state->barrier_initiated();
+      break;
+    }
+    return ret;
+  }
+  // Enqueues the initiated i/o for submission. Must be called with the lock held.
+  void _init_io_operation_enqueue(_io_uring_operation_state *state) noexcept
+  {
+    auto &nc = state->payload.noncompleted;
+    const auto ret = state->initiated;
+    switch(ret)
+    {
+    case io_operation_state_type::read_initiated:
+      state->is_fixed_buffer = _is_fixed_buffer(nc.base, nc.params.read.reqs.buffers);
+      break;
+    case io_operation_state_type::write_initiated:
+      state->is_fixed_buffer = _is_fixed_buffer(nc.base, nc.params.write.reqs.buffers);
+      break;
+    default:
+      break;
+    }
+    if(state->is_seekable)
+    {
+      auto *rfd = _find_registered_fd(state->fd);
+      if(rfd != nullptr && rfd->inode != nullptr)
+      {
+        // Compute the region of the inode affected, a zero length barrier affects all of it
+        auto region = [&](const auto &reqs) {
+          state->io_offset = reqs.offset;
+          state->io_end = reqs.offset;
+          for(const auto &b : reqs.buffers)
+          {
+            state->io_end += b.size();
+          }
+          if(state->io_end < state->io_offset)
+          {
+            state->io_end = (extent_type) -1;
+          }
+        };
+        switch(ret)
+        {
+        case io_operation_state_type::read_initiated:
+          region(nc.params.read.reqs);
+          break;
+        case io_operation_state_type::write_initiated:
+          region(nc.params.write.reqs);
+          if(nc.params.write.reqs.flags & io_flag::append)
+          {
+            // Where the end of the file will be is unknown
+            state->io_offset = 0;
+            state->io_end = (extent_type) -1;
+          }
+          break;
+        default:
+          region(nc.params.barrier.reqs);
+          if(state->io_end == state->io_offset)
+          {
+            state->io_end = (extent_type) -1;
+          }
+          break;
+        }
+        state->inode = rfd->inode;
+        state->inode->add(state);
+      }
+      if(rfd != nullptr && rfd->not_pollable)
+      {
+        state->is_polled = false;
+      }
+    }
+    if(state->has_deadline())
+    {
+      // Until submitted the wheel enforces the deadline, after which the kernel does
+      this->_deadlines.insert(state, state->expiry);
+    }
+    if(!state->is_seekable)
+    {
+      _pend_or_queue(state);
+      return;
+    }
+    if(state->inode != nullptr && state->inode_blockers != 0)
+    {
+      // Wait for earlier overlapping i/o upon this inode to complete
+      state->location = _io_uring_operation_state::location_t::blocked;
+      return;
+    }
+    state->location = _io_uring_operation_state::location_t::pending;
+    _pending_for(state).push_back(state);
+  }
+  template <class BuffersType>
+  result<void> _construct_and_init_batch(span<io_operation_state *> states, span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor, deadline d,
+                                         span<const io_request<BuffersType>> reqs) noexcept
+  {
+    OUTCOME_TRY(auto &&stride, this->_check_batch_storage(states, storage, reqs.size()));
+    for(size_t n = 0; n < reqs.size(); n++)
+    {
+      auto *state = new(storage.data() + n * stride) _io_uring_operation_state(_h, _visitor, {}, d, reqs[n]);
+      states[n] = state;
+      _init_io_operation_begin(state);
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    for(size_t n = 0; n < reqs.size(); n++)
+    {
+      auto *state = static_cast<_io_uring_operation_state *>(states[n]);
+      // i/o which completed immediately was never initiated
+      if(is_initiated(state->initiated))
+      {
+        _init_io_operation_enqueue(state);
+      }
+    }
+    // One pass to fill the submission queues, then one syscall per ring to tell the kernel
+    _submit_pending();
+    OUTCOME_TRY(_enter_all(false));
+    return success();
+  }
+
+  virtual io_operation_state_type init_io_operation(io_operation_state *_op) noexcept override
+  {
+    auto *state = static_cast<_io_uring_operation_state *>(_op);
+    const auto ret = _init_io_operation_begin(state);
+    if(!is_initiated(ret))
+    {
+      return ret;
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    _init_io_operation_enqueue(state);
+    // Fill the submission queue now, the kernel gets told on flush or check
+    _submit_pending();
+    return ret;
+  }
+  virtual result<void> construct_and_init_io_operations(span<io_operation_state *> states, span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor,
+                                                        deadline d, span<const io_request<buffers_type>> reqs) noexcept override
+  {
+    return _construct_and_init_batch(states, storage, _h, _visitor, d, reqs);
+  }
+  virtual result<void> construct_and_init_io_operations(span<io_operation_state *> states, span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor,
+                                                        deadline d, span<const io_request<const_buffers_type>> reqs) noexcept override
+  {
+    return _construct_and_init_batch(states, storage, _h, _visitor, d, reqs);
+  }
+
+  virtual result<void> flush_inited_io_operations() noexcept override
+  {
+    _multiplexer_lock_guard g(this->_lock);
+    _submit_pending();
+    OUTCOME_TRY(_enter_all(false));
+    return success();
+  }
+
+  virtual result<void> init_syscall_operation(syscall_operation_state *op) noexcept override
+  {
+    switch(op->kind)
+    {
+    case syscall_operation_kind::openat:
+      if(!_has_openat)
+      {
+        return _syscall_worker.submit(op);
+      }
+      break;
+    case syscall_operation_kind::close:
+      if(!_has_close)
+      {
+        return _syscall_worker.submit(op);
+      }
+      break;
+    case syscall_operation_kind::statx:
+      if(!_has_statx)
+      {
+        return _syscall_worker.submit(op);
+      }
+      break;
+    case syscall_operation_kind::getdents:
+      return _syscall_worker.submit(op);
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    // As with i/o, this is submitted upon the next flush or check for completions
+    op->_next = nullptr;
+    if(_pending_syscalls_last == nullptr)
+    {
+      _pending_syscalls_first = op;
+    }
+    else
+    {
+      _pending_syscalls_last->_next = op;
+    }
+    _pending_syscalls_last = op;
+    return success();
+  }
+
+  virtual io_operation_state_type check_io_operation(io_operation_state *_op) noexcept override
+  {
+    auto s = _op->current_state();
+    if(is_initiated(s))
+    {
+      (void) check_for_any_completed_io(std::chrono::seconds(0));
+      s = _op->current_state();
+    }
+    return s;
+  }
+
+  virtual result<io_operation_state_type> cancel_io_operation(io_operation_state *_op, deadline d = {}) noexcept override
+  {
+    (void) d;
+    auto *state = static_cast<_io_uring_operation_state *>(_op);
+    // Read the state before taking the multiplexer lock, as visitors can call into
+    // the multiplexer with the state lock held
+    const auto s = state->current_state();
+    if(!is_initiated(s))
+    {
+      return s;
+    }
+    _multiplexer_lock_guard g(this->_lock);
+    switch(state->location)
+    {
+    case _io_uring_operation_state::location_t::queued:
+    case _io_uring_operation_state::location_t::blocked:
+    case _io_uring_operation_state::location_t::pending:
+    {
+      _remove_unsubmitted(state);
+      g.unlock();
+      state->location = _io_uring_operation_state::location_t::none;
+      switch(s)
+      {
+      case io_operation_state_type::read_initiated:
+        return _read_finish(state, io_result<buffers_type>(errc::operation_canceled));
+      case io_operation_state_type::write_initiated:
+        return _write_finish(state, io_result<const_buffers_type>(errc::operation_canceled));
+      default:
+        return _barrier_finish(state, io_result<const_buffers_type>(errc::operation_canceled));
+      }
+    }
+    case _io_uring_operation_state::location_t::submitted:
+      // Completion polled i/o cannot be cancelled, but completes promptly
+      if(!state->cancelled && !state->is_polled)
+      {
+        state->cancelled = true;
+        if(!_prep_cancel(state))
+        {
+          // No room in the rings right now, cancel when some becomes available
+          try
+          {
+            _deferred_cancels.push_back(state);
+          }
+          catch(...)
+          {
+            return error_from_exception();
+          }
+        }
+        OUTCOME_TRY(_enter(_ring_for(state), false));
+      }
+      return s;
+    default:
+      return s;
+    }
+  }
+
+  virtual result<check_for_any_completed_io_statistics> check_for_any_completed_io(deadline d = std::chrono::seconds(0), size_t max_completions = (size_t) -1) noexcept override
+  {
+    LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+    check_for_any_completed_io_statistics ret;
+    _io_uring_operation_state *completed[64];
+    bool slept = false;
+    while(max_completions > 0)
+    {
+      // How long to sleep for if nothing has completed, zero means don't sleep
+      int mstimeout = -1;
+      if(d)
+      {
+        std::chrono::microseconds timeout;
+        LLFIO_DEADLINE_TO_PARTIAL_TIMEOUT(timeout, d);
+        mstimeout = (int) ((timeout.count() + 999) / 1000);
+      }
+      size_t count = 0;
+      _queue_t timedout;
+      syscall_operation_state *syscalls = nullptr;
+      bool spin = false;
+      {
+        _multiplexer_lock_guard g(this->_lock);
+        if(slept)
+        {
+          --_sleepers;
+        }
+        const bool may_sleep = this->_may_sleep();
+        this->_checked();
+        // If another kernel thread woke me, exit the loop
+        if(_wakecount > 0)
+        {
+          --_wakecount;
+          break;
+        }
+        if(_notifyfd != -1)
+        {
+          _reset_notifyfd();
+        }
+        if(!this->_deadlines.empty())
+        {
+          // Unsubmitted i/o past its deadline is never submitted. Submitted i/o has a linked timeout.
+          const auto now = std::chrono::steady_clock::now();
+          this->_deadlines.expire(now, [&](detail::io_multiplexer_deadline_wheel::node *n) {
+            auto *state = static_cast<_io_uring_operation_state *>(n);
+            if(state->location == _io_uring_operation_state::location_t::queued || state->location == _io_uring_operation_state::location_t::blocked ||
+               state->location == _io_uring_operation_state::location_t::pending)
+            {
+              _remove_unsubmitted(state);
+              state->res = -ETIMEDOUT;
+              state->location = _io_uring_operation_state::location_t::completing;
+              timedout.push_back(state);
+            }
+          });
+          const auto next = this->_deadlines.next_expiry();
+          if(next != std::chrono::steady_clock::time_point::max())
+          {
+            const int wheelms = (int) std::min<int64_t>(INT_MAX, std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1));
+            if(mstimeout < 0 || wheelms < mstimeout)
+            {
+              mstimeout = wheelms;
+            }
+          }
+        }
+        _submit_pending();
+        OUTCOME_TRY(_enter_all(true));
+        const size_t max = std::min(max_completions, (size_t) 64);
+        count = _reap(_nonseekable, completed, max, syscalls);
+        count += _reap(_seekable, completed + count, max - count, syscalls);
+        if(_polled.fd != -1)
+        {
+          count += _reap(_polled, completed + count, max - count, syscalls);
+        }
+        for(auto *op = _syscall_worker.reap(); op != nullptr;)
+        {
+          auto *next = op->_next;
+          op->_next = syscalls;
+          syscalls = op;
+          op = next;
+        }
+        if(_notifyfd != -1)
+        {
+          _renotify_if_unreaped();
+        }
+        if(_pending_high_priority.first != nullptr || _pending.first != nullptr || _pending_syscalls_first != nullptr || !_removed_buffer_groups.empty() ||
+           std::any_of(_buffer_groups.begin(), _buffer_groups.end(), [](const _buffer_group *group) { return group->any_returned; }))
+        {
+          // Completions may have unblocked, or requeued, pending i/o, or returned buffers
+          _submit_pending();
+          OUTCOME_TRY(_enter_all(false));
+        }
+        if(!may_sleep)
+        {
+          // Another thread may have completed what my caller is waiting upon since it last
+          // looked, and that completion has been consumed, so return for it to recheck
+          mstimeout = 0;
+        }
+        // Completion polled i/o completes only when asked about, so spin rather than sleep
+        spin = (_polled.inflight > 0);
+        if(count == 0 && timedout.first == nullptr && syscalls == nullptr && !slept && mstimeout != 0 && !spin)
+        {
+          // Anybody woken for whom the eventfd was signalled has now woken, so reset it
+          if(_sleepers == 0)
+          {
+            _reset_wakefd();
+          }
+          ++_sleepers;
+        }
+      }
+      for(size_t n = 0; n < count; n++)
+      {
+        (void) _complete(completed[n]);
+        ++ret.initiated_ios_finished;
+      }
+      while(timedout.first != nullptr)
+      {
+        auto *state = timedout.first;
+        timedout.remove(state);
+        (void) _complete(state);
+        ++ret.initiated_ios_finished;
+        ++count;
+      }
+      while(syscalls != nullptr)
+      {
+        auto *op = syscalls;
+        syscalls = op->_next;
+        op->_next = nullptr;
+        op->completed(op);  // may destroy op
+        ++ret.initiated_ios_finished;
+        ++count;
+      }
+      if(count > 0)
+      {
+        if(is_threadsafe)
+        {
+          // Any i/o just completed may be what another thread is sleeping upon, and
+          // we consumed the completion which would have woken it, so wake it
+          _multiplexer_lock_guard g(this->_lock);
+          this->_completions_invoked();
+          this->_checked();
+          if(_sleepers > 0)
+          {
+            OUTCOME_TRY(_signal_wakefd());
+          }
+        }
+        break;
+      }
+      // Having slept once, return so the caller can recheck whatever it is waiting upon
+      if(slept || mstimeout == 0)
+      {
+        break;
+      }
+      if(spin)
+      {
+        continue;
+      }
+      // Sleep until either io_uring has completions ready, or the syscall worker has, or
+      // another thread wakes us
+      pollfd fds[4];
+      memset(fds, 0, sizeof(fds));
+      fds[0].fd = _nonseekable.fd;
+      fds[0].events = POLLIN;
+      fds[1].fd = _seekable.fd;
+      fds[1].events = POLLIN;
+      fds[2].fd = _syscall_worker.fd();
+      fds[2].events = POLLIN;
+      fds[3].fd = _wakefd;
+      fds[3].events = POLLIN;
+      const int pollret = ::poll(fds, 4, mstimeout);
+      slept = true;
+      if(-1 == pollret && EINTR != errno)
+      {
+        const auto errcode = errno;
+        _multiplexer_lock_guard g(this->_lock);
+        --_sleepers;
+        return posix_error(errcode);
+      }
+    }
+    return ret;
+  }
+
+  virtual result<void> wake_check_for_any_completed_io() noexcept override
+  {
+    _multiplexer_lock_guard g(this->_lock);
+    ++_wakecount;
+    return _signal_wakefd();
+  }
+
+  virtual result<native_handle_type> completion_notification_handle() noexcept override
+  {
+    _multiplexer_lock_guard g(this->_lock);
+    if(_notifyfd == -1)
+    {
+      int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if(-1 == fd)
+      {
+        return posix_error();
+      }
+      if(_io_uring_register(_nonseekable.fd, _IORING_REGISTER_EVENTFD, &fd, 1) < 0)
+      {
+        auto ret = posix_error();
+        ::close(fd);
+        return ret;
+      }
+      if(_io_uring_register(_seekable.fd, _IORING_REGISTER_EVENTFD, &fd, 1) < 0)
+      {
+        auto ret = posix_error();
+        (void) _io_uring_register(_nonseekable.fd, _IORING_UNREGISTER_EVENTFD, nullptr, 0);
+        ::close(fd);
+        return ret;
+      }
+      _syscall_worker.set_notify_fd(fd);
+      _notifyfd = fd;
+      // Anything completed before registration would otherwise never be notified
+      _renotify_if_unreaped();
+    }
+    return native_handle_type(native_handle_type::disposition::readable | native_handle_type::disposition::nonblocking, _notifyfd);
+  }
+};
+
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_io_uring(const multiplexer_linux_io_uring_config &config) noexcept
+{
+  try
+  {
+    if(1 == config.threads)
+    {
+      auto ret = std::make_unique<linux_io_uring_multiplexer<false>>();
+      OUTCOME_TRY(ret->init(config));
+      return io_multiplexer_ptr(ret.release());
+    }
+    auto ret = std::make_unique<linux_io_uring_multiplexer<true>>();
+    OUTCOME_TRY(ret->init(config));
+    return io_multiplexer_ptr(ret.release());
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_io_uring(size_t threads, bool is_polling) noexcept
+{
+  multiplexer_linux_io_uring_config config;
+  config.threads = threads;
+  config.submission_polling = is_polling;
+  return multiplexer_linux_io_uring(config);
+}
+
+LLFIO_V2_NAMESPACE_END
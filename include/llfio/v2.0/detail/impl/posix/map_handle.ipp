@@ -27,7 +27,12 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "quickcpplib/signal_guard.hpp"
 
+#include <mutex>
+#include <vector>
+
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 //#define LLFIO_DEBUG_LINUX_MUNMAP
 
@@ -117,6 +122,93 @@ result<section_handle> section_handle::section(extent_type bytes, const path_han
   return ret;
 }
 
+result<section_handle> section_handle::anonymous_section(extent_type bytes, flag _flag) noexcept
+{
+#ifdef MFD_ALLOW_SEALING
+  if(bytes == 0u)
+  {
+    return errc::invalid_argument;
+  }
+  unsigned mfdflags = MFD_CLOEXEC | MFD_ALLOW_SEALING;
+  OUTCOME_TRY(auto &&pagesize, detail::pagesize_from_flags(_flag));
+  if(pagesize != utils::page_size())
+  {
+#ifdef MFD_HUGETLB
+    mfdflags |= MFD_HUGETLB;
+#ifdef MFD_HUGE_SHIFT
+    // Ask for page size requested
+    size_t topbitset = (__CHAR_BIT__ * sizeof(unsigned long)) - __builtin_clzl((unsigned long) pagesize) - 1;
+    mfdflags |= topbitset << MFD_HUGE_SHIFT;
+#endif
+#else
+    return errc::invalid_argument;
+#endif
+  }
+  bytes = utils::round_up_to_page_size(bytes, pagesize);
+  int fd = ::memfd_create("llfio_anonymous_section", mfdflags);
+  if(-1 == fd)
+  {
+    return posix_error();
+  }
+  native_handle_type anonnativeh(native_handle_type::disposition::file | native_handle_type::disposition::readable | native_handle_type::disposition::writable | native_handle_type::disposition::seekable, fd);
+  file_handle anonh(anonnativeh, file_handle::caching::temporary, file_handle::flag::anonymous_inode, nullptr);
+  if(-1 == ::ftruncate(fd, bytes))
+  {
+    return posix_error();
+  }
+  result<section_handle> ret(section_handle(native_handle_type(), nullptr, std::move(anonh), _flag));
+  native_handle_type &nativeh = ret.value()._v;
+  nativeh.fd = fd;
+  if(_flag & flag::read)
+  {
+    nativeh.behaviour |= native_handle_type::disposition::readable;
+  }
+  if(_flag & flag::write)
+  {
+    nativeh.behaviour |= native_handle_type::disposition::writable;
+  }
+  nativeh.behaviour |= native_handle_type::disposition::section;
+  LLFIO_LOG_FUNCTION_CALL(&ret);
+  return ret;
+#else
+  auto &tempdirh = path_discovery::memory_backed_temporary_files_directory().is_valid() ? path_discovery::memory_backed_temporary_files_directory() : path_discovery::storage_backed_temporary_files_directory();
+  return section(bytes, tempdirh, _flag);
+#endif
+}
+
+result<section_handle> section_handle::from_native_handle(native_handle_type nativeh, flag _flag) noexcept
+{
+  if(nativeh.fd == -1)
+  {
+    return errc::invalid_argument;
+  }
+  struct stat s
+  {
+  };
+  memset(&s, 0, sizeof(s));
+  if(-1 == ::fstat(nativeh.fd, &s))
+  {
+    return posix_error();
+  }
+  // The anonymous file handle owns the file descriptor, so truncate() works and close() closes it
+  native_handle_type anonnativeh(native_handle_type::disposition::file | native_handle_type::disposition::readable | native_handle_type::disposition::writable | native_handle_type::disposition::seekable, nativeh.fd);
+  file_handle anonh(anonnativeh, s.st_dev, s.st_ino, file_handle::caching::temporary, file_handle::flag::anonymous_inode, nullptr);
+  result<section_handle> ret(section_handle(native_handle_type(), nullptr, std::move(anonh), _flag));
+  native_handle_type &v = ret.value()._v;
+  v.fd = nativeh.fd;
+  if(_flag & flag::read)
+  {
+    v.behaviour |= native_handle_type::disposition::readable;
+  }
+  if(_flag & flag::write)
+  {
+    v.behaviour |= native_handle_type::disposition::writable;
+  }
+  v.behaviour |= native_handle_type::disposition::section;
+  LLFIO_LOG_FUNCTION_CALL(&ret);
+  return ret;
+}
+
 result<section_handle::extent_type> section_handle::length() const noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
@@ -144,9 +236,273 @@ result<section_handle::extent_type> section_handle::truncate(extent_type newsize
   return newsize;
 }
 
+result<void> section_handle::add_seals(seal_flag seals) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+#ifdef F_ADD_SEALS
+  int fseals = 0;
+  if(seals & seal_flag::no_more_seals)
+  {
+    fseals |= F_SEAL_SEAL;
+  }
+  if(seals & seal_flag::shrink)
+  {
+    fseals |= F_SEAL_SHRINK;
+  }
+  if(seals & seal_flag::grow)
+  {
+    fseals |= F_SEAL_GROW;
+  }
+  if(seals & seal_flag::write)
+  {
+    fseals |= F_SEAL_WRITE;
+  }
+  if(seals & seal_flag::future_write)
+  {
+#ifdef F_SEAL_FUTURE_WRITE
+    fseals |= F_SEAL_FUTURE_WRITE;
+#else
+    return errc::operation_not_supported;
+#endif
+  }
+  if(-1 == ::fcntl(_v.fd, F_ADD_SEALS, fseals))
+  {
+    if(EINVAL == errno)
+    {
+      // Not a sealable file
+      return errc::operation_not_supported;
+    }
+    if(EPERM == errno)
+    {
+      return errc::operation_not_permitted;
+    }
+    return posix_error();
+  }
+  return success();
+#else
+  (void) seals;
+  return errc::operation_not_supported;
+#endif
+}
+
+result<section_handle::seal_flag> section_handle::seals() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  seal_flag ret = seal_flag::none;
+#ifdef F_GET_SEALS
+  int fseals = ::fcntl(_v.fd, F_GET_SEALS);
+  if(-1 == fseals)
+  {
+    if(EINVAL == errno)
+    {
+      // Not a sealable file
+      return ret;
+    }
+    return posix_error();
+  }
+  if(fseals & F_SEAL_SEAL)
+  {
+    ret |= seal_flag::no_more_seals;
+  }
+  if(fseals & F_SEAL_SHRINK)
+  {
+    ret |= seal_flag::shrink;
+  }
+  if(fseals & F_SEAL_GROW)
+  {
+    ret |= seal_flag::grow;
+  }
+  if(fseals & F_SEAL_WRITE)
+  {
+    ret |= seal_flag::write;
+  }
+#ifdef F_SEAL_FUTURE_WRITE
+  if(fseals & F_SEAL_FUTURE_WRITE)
+  {
+    ret |= seal_flag::future_write;
+  }
+#endif
+#endif
+  return ret;
+}
+
 
 /******************************************* map_handle *********************************************/
 
+namespace detail
+{
+  /* A process-wide cache of released anonymous mappings. The pages are handed back to the kernel
+  using MADV_FREE, but the address space is retained so a later map() of a similar size can reuse
+  it without the mmap()/munmap() pair, and the TLB shootdowns which accompany munmap().
+
+  Buckets are indexed by the power of two at or below the size of the mapping. Each bucket is
+  LIFO, so the most recently released mapping (which is the most likely to still be paged in)
+  is reused first, and the oldest mappings are at the front for trimming.
+
+  The total bytes held are capped, mappings larger than the cap are never cached, and the
+  oldest mappings are unmapped to make room for newer ones. Large allocations are rare enough
+  that recycling them gains little, whereas holding onto them would pin a lot of commit charge.
+  */
+  struct map_handle_cache_item
+  {
+    byte *addr{nullptr};
+    size_t bytes{0};
+    std::chrono::steady_clock::time_point when;
+  };
+  struct map_handle_cache_t
+  {
+    std::mutex lock;
+    std::vector<map_handle_cache_item> buckets[sizeof(size_t) * 8];
+    map_handle::cache_statistics stats;
+    std::atomic<bool> disabled{false};
+    std::atomic<size_t> limit{32 * 1024 * 1024};
+
+    static size_t bucket_for(size_t bytes) noexcept
+    {
+      size_t ret = 0;
+      while((bytes >>= 1) != 0)
+      {
+        ++ret;
+      }
+      return ret;
+    }
+    // Returns a released mapping at least `bytes` long, or an empty item if there is none
+    map_handle_cache_item get(size_t bytes) noexcept
+    {
+      if(disabled.load(std::memory_order_relaxed))
+      {
+        return {};
+      }
+      std::lock_guard<std::mutex> g(lock);
+      // Try the bucket for this size, then the bucket above for a mapping no more than twice as big
+      const size_t idx = bucket_for(bytes);
+      for(size_t n = idx; n <= idx + 1 && n < sizeof(buckets) / sizeof(buckets[0]); n++)
+      {
+        auto &bucket = buckets[n];
+        for(auto it = bucket.rbegin(); it != bucket.rend(); ++it)
+        {
+          if(it->bytes >= bytes && it->bytes / 2 <= bytes)
+          {
+            map_handle_cache_item ret = *it;
+            bucket.erase(std::next(it).base());
+            stats.items_in_cache--;
+            stats.bytes_in_cache -= ret.bytes;
+            stats.hits++;
+            utils::detail::map_handle_cache_bytes().fetch_sub(ret.bytes, std::memory_order_relaxed);
+            return ret;
+          }
+        }
+      }
+      stats.misses++;
+      return {};
+    }
+    // Unmaps the oldest cached mappings until no more than `maxbytes` remain. Lock must be held.
+    void evict_to(size_t maxbytes) noexcept
+    {
+      while(stats.bytes_in_cache > maxbytes)
+      {
+        std::vector<map_handle_cache_item> *oldest = nullptr;
+        for(auto &bucket : buckets)
+        {
+          if(!bucket.empty() && (oldest == nullptr || bucket.front().when < oldest->front().when))
+          {
+            oldest = &bucket;
+          }
+        }
+        const map_handle_cache_item item = oldest->front();
+        oldest->erase(oldest->begin());
+        (void) ::munmap(item.addr, item.bytes);
+        stats.items_in_cache--;
+        stats.bytes_in_cache -= item.bytes;
+        utils::detail::map_handle_cache_bytes().fetch_sub(item.bytes, std::memory_order_relaxed);
+      }
+    }
+    // Returns false if the mapping was not taken, in which case the caller must unmap it
+    bool add(byte *addr, size_t bytes) noexcept
+    {
+#ifdef MADV_FREE
+      if(disabled.load(std::memory_order_relaxed) || bytes > limit.load(std::memory_order_relaxed))
+      {
+        return false;
+      }
+      if(-1 == ::madvise(addr, bytes, MADV_FREE))
+      {
+        // Kernels before Linux 4.5 don't implement MADV_FREE, so don't keep trying
+        disabled.store(true, std::memory_order_relaxed);
+        return false;
+      }
+      std::lock_guard<std::mutex> g(lock);
+      try
+      {
+        buckets[bucket_for(bytes)].push_back({addr, bytes, std::chrono::steady_clock::now()});
+      }
+      catch(...)
+      {
+        return false;
+      }
+      stats.items_in_cache++;
+      stats.bytes_in_cache += bytes;
+      utils::detail::map_handle_cache_bytes().fetch_add(bytes, std::memory_order_relaxed);
+      evict_to(limit.load(std::memory_order_relaxed));
+      return true;
+#else
+      (void) addr;
+      (void) bytes;
+      return false;
+#endif
+    }
+    map_handle::cache_statistics trim(std::chrono::steady_clock::time_point older_than) noexcept
+    {
+      std::lock_guard<std::mutex> g(lock);
+      map_handle::cache_statistics ret;
+      for(auto &bucket : buckets)
+      {
+        auto it = bucket.begin();
+        for(; it != bucket.end() && it->when < older_than; ++it)
+        {
+          (void) ::munmap(it->addr, it->bytes);
+          ret.items_just_trimmed++;
+          ret.bytes_just_trimmed += it->bytes;
+        }
+        bucket.erase(bucket.begin(), it);
+      }
+      stats.items_in_cache -= ret.items_just_trimmed;
+      stats.bytes_in_cache -= ret.bytes_just_trimmed;
+      utils::detail::map_handle_cache_bytes().fetch_sub(ret.bytes_just_trimmed, std::memory_order_relaxed);
+      ret.items_in_cache = stats.items_in_cache;
+      ret.bytes_in_cache = stats.bytes_in_cache;
+      ret.hits = stats.hits;
+      ret.misses = stats.misses;
+      return ret;
+    }
+  };
+  inline map_handle_cache_t &map_handle_cache()
+  {
+    // Leaked, so maps closed during static deinitialisation still have a cache to go to
+    static map_handle_cache_t *v = new map_handle_cache_t;
+    return *v;
+  }
+}  // namespace detail
+
+map_handle::cache_statistics map_handle::trim_cache(std::chrono::steady_clock::time_point older_than) noexcept
+{
+  return detail::map_handle_cache().trim(older_than);
+}
+
+bool map_handle::set_cache_disabled(bool disabled) noexcept
+{
+  return detail::map_handle_cache().disabled.exchange(disabled, std::memory_order_relaxed);
+}
+
+size_t map_handle::set_cache_limit(size_t bytes) noexcept
+{
+  auto &cache = detail::map_handle_cache();
+  std::lock_guard<std::mutex> g(cache.lock);
+  const size_t ret = cache.limit.exchange(bytes, std::memory_order_relaxed);
+  cache.evict_to(bytes);
+  return ret;
+}
+
 
 map_handle::~map_handle()
 {
@@ -173,7 +529,8 @@ result<void> map_handle::close() noexcept
       OUTCOME_TRYV(map_handle::barrier(barrier_kind::wait_all));
     }
     // printf("%d munmap %p-%p\n", getpid(), _addr, _addr+_reservation);
-    if(-1 == ::munmap(_addr, _reservation))
+    // Recyclable anonymous memory goes to the cache instead of being unmapped
+    if((!_recyclable || !detail::map_handle_cache().add(_addr, _reservation)) && -1 == ::munmap(_addr, _reservation))
     {
 #ifdef LLFIO_DEBUG_LINUX_MUNMAP
       int olderrno = errno;
@@ -200,6 +557,7 @@ result<void> map_handle::close() noexcept
   _v = native_handle_type();
   _addr = nullptr;
   _length = 0;
+  _recyclable = false;
   return success();
 }
 
@@ -210,6 +568,7 @@ native_handle_type map_handle::release() noexcept
   _v = native_handle_type();
   _addr = nullptr;
   _length = 0;
+  _recyclable = false;
   return {};
 }
 
@@ -387,9 +746,8 @@ static inline result<void *> do_mmap(native_handle_type &nativeh, void *ataddr,
   return addr;
 }
 
-result<map_handle> map_handle::map(size_type bytes, bool /*unused*/, section_handle::flag _flag) noexcept
+result<map_handle> map_handle::map(size_type bytes, bool zeroed, section_handle::flag _flag) noexcept
 {
-  // TODO: Keep a cache of MADV_FREE pages deallocated
   if(bytes == 0u)
   {
     return errc::argument_out_of_domain;
@@ -398,6 +756,33 @@ result<map_handle> map_handle::map(size_type bytes, bool /*unused*/, section_han
   result<map_handle> ret(map_handle(nullptr, _flag));
   native_handle_type &nativeh = ret.value()._v;
   OUTCOME_TRY(auto &&pagesize, detail::pagesize_from_flags(ret.value()._flag));
+  // Only plain read/write anonymous memory of the default page size is recycled
+  ret.value()._recyclable = (ret.value()._flag == section_handle::flag::readwrite && pagesize == utils::page_size());
+  if(ret.value()._recyclable)
+  {
+    auto item = detail::map_handle_cache().get(bytes);
+    if(item.addr != nullptr)
+    {
+      if(zeroed)
+      {
+#ifdef __linux__
+        // Private anonymous pages are zero filled upon next touch after MADV_DONTNEED
+        if(-1 == ::madvise(item.addr, bytes, MADV_DONTNEED))
+#endif
+        {
+          memset(item.addr, 0, bytes);
+        }
+      }
+      ret.value()._addr = item.addr;
+      ret.value()._reservation = item.bytes;
+      ret.value()._length = bytes;
+      ret.value()._pagesize = pagesize;
+      nativeh._init = -2;  // otherwise appears closed
+      nativeh.behaviour |= native_handle_type::disposition::allocation;
+      LLFIO_LOG_FUNCTION_CALL(&ret);
+      return ret;
+    }
+  }
   OUTCOME_TRY(auto &&addr, do_mmap(nativeh, nullptr, 0, nullptr, pagesize, bytes, 0, ret.value()._flag));
   ret.value()._addr = static_cast<byte *>(addr);
   ret.value()._reservation = bytes;
@@ -432,6 +817,33 @@ result<map_handle> map_handle::map(section_handle &section, size_type bytes, ext
   return ret;
 }
 
+result<map_handle> map_handle::map_at(byte *addr, section_handle &section, size_type bytes, extent_type offset, section_handle::flag _flag) noexcept
+{
+  OUTCOME_TRY(auto &&length, section.length());  // length of the backing file
+  if(addr == nullptr || bytes == 0u)
+  {
+    return errc::invalid_argument;
+  }
+  result<map_handle> ret{map_handle(&section, _flag)};
+  native_handle_type &nativeh = ret.value()._v;
+  OUTCOME_TRY(auto &&pagesize, detail::pagesize_from_flags(ret.value()._flag));
+  if((reinterpret_cast<uintptr_t>(addr) & (pagesize - 1)) != 0)
+  {
+    return errc::invalid_argument;
+  }
+  OUTCOME_TRY(auto &&mapped, do_mmap(nativeh, addr, MAP_FIXED, &section, pagesize, bytes, offset, ret.value()._flag));
+  ret.value()._addr = static_cast<byte *>(mapped);
+  ret.value()._offset = offset;
+  ret.value()._reservation = utils::round_up_to_page_size(bytes, pagesize);
+  ret.value()._length = (length - offset < bytes) ? (length - offset) : bytes;  // length of backing, not reservation
+  ret.value()._pagesize = pagesize;
+  // Make my handle borrow the native handle of my backing storage
+  ret.value()._v.fd = section.native_handle().fd;
+  nativeh.behaviour |= native_handle_type::disposition::allocation;
+  LLFIO_LOG_FUNCTION_CALL(&ret);
+  return ret;
+}
+
 // Change the address reservation for this map
 result<map_handle::size_type> map_handle::truncate(size_type newsize, bool permit_relocation) noexcept
 {
@@ -530,6 +942,8 @@ result<map_handle::buffer_type> map_handle::commit(buffer_type region, section_h
   extent_type offset = _offset + (region.data() - _addr);
   size_type bytes = region.size();
   OUTCOME_TRYV(do_mmap(_v, region.data(), MAP_FIXED, _section, _pagesize, bytes, offset, flag));
+  // The pages may now have different permissions to the rest, so don't recycle them
+  _recyclable = false;
   // Tell the kernel we will be using these pages soon
   if(-1 == ::madvise(region.data(), region.size(), MADV_WILLNEED))
   {
@@ -555,6 +969,7 @@ result<map_handle::buffer_type> map_handle::decommit(buffer_type region) noexcep
   extent_type offset = _offset + (region.data() - _addr);
   size_type bytes = region.size();
   OUTCOME_TRYV(do_mmap(_v, region.data(), MAP_FIXED, _section, _pagesize, bytes, offset, section_handle::flag::none | section_handle::flag::nocommit));
+  _recyclable = false;
   return region;
 }
 
@@ -606,6 +1021,41 @@ result<span<map_handle::buffer_type>> map_handle::prefetch(span<buffer_type> reg
   return regions;
 }
 
+result<span<byte>> map_handle::residency(span<byte> bitmap, buffer_type region) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(0);
+  const size_t pagesize = utils::page_size();
+  region = utils::round_to_page_size_larger(region, pagesize);
+  const size_t pages = region.size() / pagesize;
+  if(bitmap.size() < (pages + 7) / 8)
+  {
+    return errc::invalid_argument;
+  }
+  bitmap = {bitmap.data(), (pages + 7) / 8};
+  memset(bitmap.data(), 0, bitmap.size());
+#ifdef __linux__
+  unsigned char vec[4096];
+#else
+  char vec[4096];
+#endif
+  for(size_t n = 0; n < pages; n += sizeof(vec))
+  {
+    const size_t thispages = std::min(pages - n, sizeof(vec));
+    if(-1 == ::mincore(region.data() + n * pagesize, thispages * pagesize, vec))
+    {
+      return posix_error();
+    }
+    for(size_t i = 0; i < thispages; i++)
+    {
+      if(vec[i] & 1)
+      {
+        bitmap[(n + i) / 8] |= to_byte(static_cast<unsigned char>(1U << ((n + i) % 8)));
+      }
+    }
+  }
+  return bitmap;
+}
+
 result<map_handle::buffer_type> map_handle::do_not_store(buffer_type region) noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(0);
@@ -25,6 +25,8 @@ Distributed under the Boost Software License, Version 1.0.
 #include "../../../mapped_file_handle.hpp"
 #include "import.hpp"
 
+#include <sys/mman.h>
+
 LLFIO_V2_NAMESPACE_BEGIN
 
 result<mapped_file_handle::size_type> mapped_file_handle::reserve(size_type reservation) noexcept
@@ -58,6 +60,8 @@ result<mapped_file_handle::size_type> mapped_file_handle::reserve(size_type rese
   {
     mapflags |= section_handle::flag::write;
   }
+  // A copy on write section must be mapped privately, which map_handle does not take from the section
+  mapflags |= _sh.section_flags() & section_handle::flag::cow;
   OUTCOME_TRYV(_mh.close());
   OUTCOME_TRY(auto &&mh, map_handle::map(_sh, reservation, 0, mapflags));
   _mh = std::move(mh);
@@ -68,6 +72,7 @@ result<mapped_file_handle::size_type> mapped_file_handle::reserve(size_type rese
 result<void> mapped_file_handle::close() noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  _prefetcher.reset();
   if(_mh.is_valid())
   {
     OUTCOME_TRYV(_mh.close());
@@ -81,6 +86,7 @@ result<void> mapped_file_handle::close() noexcept
 native_handle_type mapped_file_handle::release() noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  _prefetcher.reset();
   if(_mh.is_valid())
   {
     (void) _mh.close();
@@ -164,4 +170,27 @@ result<mapped_file_handle::extent_type> mapped_file_handle::update_map() noexcep
   return length;
 }
 
+void mapped_file_handle::_prefetcher_drop(extent_type offset, size_type bytes) noexcept
+{
+  if(offset >= _mh.length())
+  {
+    return;
+  }
+  if(offset + bytes > _mh.length())
+  {
+    bytes = static_cast<size_type>(_mh.length() - offset);
+  }
+  // Unlike MADV_FREE or MADV_REMOVE, on a shared file mapping this only drops our page table
+  // entries, dirty pages remain in the page cache to be written back. On a private copy on
+  // write mapping it would throw away our modifications, so leave those pages alone.
+  if(!(_mh.section_flags() & section_handle::flag::cow))
+  {
+    (void) ::madvise(_mh.address() + offset, bytes, MADV_DONTNEED);
+  }
+#ifdef POSIX_FADV_DONTNEED
+  // Clean pages are evicted from the page cache, dirty pages are scheduled for writeback
+  (void) ::posix_fadvise(_v.fd, offset, bytes, POSIX_FADV_DONTNEED);
+#endif
+}
+
 LLFIO_V2_NAMESPACE_END
@@ -86,120 +86,231 @@ inline struct timespec from_timepoint(std::chrono::system_clock::time_point time
   return {static_cast<time_t>(duration.count() / STL_TICKS_PER_SEC), static_cast<long int>((duration.count() % STL_TICKS_PER_SEC) * divider / multiplier)};
 }
 
-LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> stat_t::fill(const handle &h, stat_t::want wanted) noexcept
-{
-  LLFIO_LOG_FUNCTION_CALL(&h);
-  size_t ret = 0;
 #ifdef __linux__
+namespace detail
+{
+  struct statx_timestamp
   {
-    struct statx_timestamp
-    {
-      int64_t tv_sec;   /* Seconds since the Epoch (UNIX time) */
-      uint32_t tv_nsec; /* Nanoseconds since tv_sec */
-      uint32_t __reserved;
-    };
-    struct statx
-    {
-      uint32_t stx_mask;       /* Mask of bits indicating
-                               filled fields */
-      uint32_t stx_blksize;    /* Block size for filesystem I/O */
-      uint64_t stx_attributes; /* Extra file attribute indicators */
-      uint32_t stx_nlink;      /* Number of hard links */
-      uint32_t stx_uid;        /* User ID of owner */
-      uint32_t stx_gid;        /* Group ID of owner */
-      uint16_t stx_mode;       /* File type and mode */
-      uint16_t __spare0[1];
-      uint64_t stx_ino;    /* Inode number */
-      uint64_t stx_size;   /* Total size in bytes */
-      uint64_t stx_blocks; /* Number of 512B blocks allocated */
-      uint64_t stx_attributes_mask;
-      /* Mask to show what's supported
-         in stx_attributes */
+    int64_t tv_sec;   /* Seconds since the Epoch (UNIX time) */
+    uint32_t tv_nsec; /* Nanoseconds since tv_sec */
+    uint32_t __reserved;
+  };
+  struct statx_t
+  {
+    uint32_t stx_mask;       /* Mask of bits indicating
+                             filled fields */
+    uint32_t stx_blksize;    /* Block size for filesystem I/O */
+    uint64_t stx_attributes; /* Extra file attribute indicators */
+    uint32_t stx_nlink;      /* Number of hard links */
+    uint32_t stx_uid;        /* User ID of owner */
+    uint32_t stx_gid;        /* Group ID of owner */
+    uint16_t stx_mode;       /* File type and mode */
+    uint16_t __spare0[1];
+    uint64_t stx_ino;    /* Inode number */
+    uint64_t stx_size;   /* Total size in bytes */
+    uint64_t stx_blocks; /* Number of 512B blocks allocated */
+    uint64_t stx_attributes_mask;
+    /* Mask to show what's supported
+       in stx_attributes */
+
+    /* The following fields are file timestamps */
+    struct statx_timestamp stx_atime; /* Last access */
+    struct statx_timestamp stx_btime; /* Creation */
+    struct statx_timestamp stx_ctime; /* Last status change */
+    struct statx_timestamp stx_mtime; /* Last modification */
+
+    /* If this file represents a device, then the next two
+       fields contain the ID of the device */
+    uint32_t stx_rdev_major; /* Major ID */
+    uint32_t stx_rdev_minor; /* Minor ID */
+
+    /* The next two fields contain the ID of the device
+       containing the filesystem where the file resides */
+    uint32_t stx_dev_major; /* Major ID */
+    uint32_t stx_dev_minor; /* Minor ID */
 
-      /* The following fields are file timestamps */
-      struct statx_timestamp stx_atime; /* Last access */
-      struct statx_timestamp stx_btime; /* Creation */
-      struct statx_timestamp stx_ctime; /* Last status change */
-      struct statx_timestamp stx_mtime; /* Last modification */
+    uint64_t __spare2[14];
+  };
+  static_assert(sizeof(statx_t) == stat_t::_statx_buffer_size, "statx_t is not the size of the kernel's struct statx!");
+}  // namespace detail
 
-      /* If this file represents a device, then the next two
-         fields contain the ID of the device */
-      uint32_t stx_rdev_major; /* Major ID */
-      uint32_t stx_rdev_minor; /* Minor ID */
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC unsigned stat_t::_statx_mask(stat_t::want wanted) noexcept
+{
+  unsigned mask = 0;
+  if(wanted & want::dev)
+  {
+    mask |= 0x0100U /*STATX_INO*/;
+  }
+  if(wanted & want::ino)
+  {
+    mask |= 0x0100U /*STATX_INO*/;
+  }
+  if(wanted & want::type)
+  {
+    mask |= 0x0001U /*STATX_TYPE*/;
+  }
+  if(wanted & want::perms)
+  {
+    mask |= 0x0002U /*STATX_MODE*/;
+  }
+  if(wanted & want::nlink)
+  {
+    mask |= 0x0004U /*STATX_NLINK*/;
+  }
+  if(wanted & want::uid)
+  {
+    mask |= 0x0008U /*STATX_UID*/;
+  }
+  if(wanted & want::gid)
+  {
+    mask |= 0x0010U /*STATX_GID*/;
+  }
+  if(wanted & want::rdev)
+  {
+    mask |= 0x0100U /*STATX_INO*/;
+  }
+  if(wanted & want::atim)
+  {
+    mask |= 0x0020U /*STATX_ATIME*/;
+  }
+  if(wanted & want::mtim)
+  {
+    mask |= 0x0040U /*STATX_MTIME*/;
+  }
+  if(wanted & want::ctim)
+  {
+    mask |= 0x0080U /*STATX_CTIME*/;
+  }
+  if(wanted & want::size)
+  {
+    mask |= 0x0200U /*STATX_SIZE*/;
+  }
+  if(wanted & want::allocated)
+  {
+    mask |= 0x0200U /*STATX_SIZE*/;
+  }
+  if(wanted & want::blocks)
+  {
+    mask |= 0x0400U /*STATX_BLOCKS*/;
+  }
+  if(wanted & want::blksize)
+  {
+    mask |= 0x0400U /*STATX_BLOCKS*/;
+  }
+  if(wanted & want::birthtim)
+  {
+    mask |= 0x0800U /*STATX_BTIME*/;
+  }
+  return mask;
+}
 
-      /* The next two fields contain the ID of the device
-         containing the filesystem where the file resides */
-      uint32_t stx_dev_major; /* Major ID */
-      uint32_t stx_dev_minor; /* Minor ID */
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t stat_t::_fill_from_statx(const void *statxbuf, stat_t::want wanted) noexcept
+{
+  const auto &s = *static_cast<const detail::statx_t *>(statxbuf);
+  size_t ret = 0;
+  if(wanted & want::dev)
+  {
+    st_dev = makedev(s.stx_dev_major, s.stx_dev_minor);
+    ++ret;
+  }
+  if(wanted & want::ino)
+  {
+    st_ino = s.stx_ino;
+    ++ret;
+  }
+  if(wanted & want::type)
+  {
+    st_type = to_st_type(s.stx_mode);
+    ++ret;
+  }
+  if(wanted & want::perms)
+  {
+    st_perms = s.stx_mode & 0xfff;
+    ++ret;
+  }
+  if(wanted & want::nlink)
+  {
+    st_nlink = s.stx_nlink;
+    ++ret;
+  }
+  if(wanted & want::uid)
+  {
+    st_uid = s.stx_uid;
+    ++ret;
+  }
+  if(wanted & want::gid)
+  {
+    st_gid = s.stx_gid;
+    ++ret;
+  }
+  if(wanted & want::rdev)
+  {
+    st_rdev = makedev(s.stx_rdev_major, s.stx_rdev_minor);
+    ++ret;
+  }
+  if(wanted & want::atim)
+  {
+    st_atim = to_timepoint(timespec{s.stx_atime.tv_sec, s.stx_atime.tv_nsec});
+    ++ret;
+  }
+  if(wanted & want::mtim)
+  {
+    st_mtim = to_timepoint(timespec{s.stx_mtime.tv_sec, s.stx_mtime.tv_nsec});
+    ++ret;
+  }
+  if(wanted & want::ctim)
+  {
+    st_ctim = to_timepoint(timespec{s.stx_ctime.tv_sec, s.stx_ctime.tv_nsec});
+    ++ret;
+  }
+  if(wanted & want::size)
+  {
+    st_size = s.stx_size;
+    ++ret;
+  }
+  if(wanted & want::allocated)
+  {
+    st_allocated = static_cast<handle::extent_type>(s.stx_blocks) * 512;
+    ++ret;
+  }
+  if(wanted & want::blocks)
+  {
+    st_blocks = s.stx_blocks;
+    ++ret;
+  }
+  if(wanted & want::blksize)
+  {
+    st_blksize = s.stx_blksize;
+    ++ret;
+  }
+  if(wanted & want::birthtim)
+  {
+    st_birthtim = to_timepoint(timespec{s.stx_btime.tv_sec, s.stx_btime.tv_nsec});
+    ++ret;
+  }
+  if(wanted & want::sparse)
+  {
+    st_sparse = static_cast<unsigned int>((static_cast<handle::extent_type>(s.stx_blocks) * 512) < static_cast<handle::extent_type>(s.stx_size));
+    ++ret;
+  }
+  if(wanted & want::compressed)
+  {
+    st_compressed = static_cast<unsigned int>(s.stx_attributes & 0x0004 /*STATX_ATTR_COMPRESSED*/);
+    ++ret;
+  }
+  return ret;
+}
+#endif
 
-      uint64_t __spare2[14];
-    } s;
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> stat_t::fill(const handle &h, stat_t::want wanted) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(&h);
+  size_t ret = 0;
+#ifdef __linux__
+  {
+    detail::statx_t s;
     memset(&s, 0, sizeof(s));
-    unsigned mask = 0;
-    if(wanted & want::dev)
-    {
-      mask |= 0x0100U /*STATX_INO*/;
-    }
-    if(wanted & want::ino)
-    {
-      mask |= 0x0100U /*STATX_INO*/;
-    }
-    if(wanted & want::type)
-    {
-      mask |= 0x0001U /*STATX_TYPE*/;
-    }
-    if(wanted & want::perms)
-    {
-      mask |= 0x0002U /*STATX_MODE*/;
-    }
-    if(wanted & want::nlink)
-    {
-      mask |= 0x0004U /*STATX_NLINK*/;
-    }
-    if(wanted & want::uid)
-    {
-      mask |= 0x0008U /*STATX_UID*/;
-    }
-    if(wanted & want::gid)
-    {
-      mask |= 0x0010U /*STATX_GID*/;
-    }
-    if(wanted & want::rdev)
-    {
-      mask |= 0x0100U /*STATX_INO*/;
-    }
-    if(wanted & want::atim)
-    {
-      mask |= 0x0020U /*STATX_ATIME*/;
-    }
-    if(wanted & want::mtim)
-    {
-      mask |= 0x0040U /*STATX_MTIME*/;
-    }
-    if(wanted & want::ctim)
-    {
-      mask |= 0x0080U /*STATX_CTIME*/;
-    }
-    if(wanted & want::size)
-    {
-      mask |= 0x0200U /*STATX_SIZE*/;
-    }
-    if(wanted & want::allocated)
-    {
-      mask |= 0x0200U /*STATX_SIZE*/;
-    }
-    if(wanted & want::blocks)
-    {
-      mask |= 0x0400U /*STATX_BLOCKS*/;
-    }
-    if(wanted & want::blksize)
-    {
-      mask |= 0x0400U /*STATX_BLOCKS*/;
-    }
-    if(wanted & want::birthtim)
-    {
-      mask |= 0x0800U /*STATX_BTIME*/;
-    }
+    const unsigned mask = _statx_mask(wanted);
     int flags = AT_EMPTY_PATH | AT_NO_AUTOMOUNT | AT_SYMLINK_NOFOLLOW | 0x0000 /*AT_STATX_SYNC_AS_STAT*/;
     int fd = h.native_handle().fd;
     if(
@@ -220,97 +331,7 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> stat_t::fill(const handle &h, sta
 #endif
     >= 0)
     {
-      if(wanted & want::dev)
-      {
-        st_dev = makedev(s.stx_dev_major, s.stx_dev_minor);
-        ++ret;
-      }
-      if(wanted & want::ino)
-      {
-        st_ino = s.stx_ino;
-        ++ret;
-      }
-      if(wanted & want::type)
-      {
-        st_type = to_st_type(s.stx_mode);
-        ++ret;
-      }
-      if(wanted & want::perms)
-      {
-        st_perms = s.stx_mode & 0xfff;
-        ++ret;
-      }
-      if(wanted & want::nlink)
-      {
-        st_nlink = s.stx_nlink;
-        ++ret;
-      }
-      if(wanted & want::uid)
-      {
-        st_uid = s.stx_uid;
-        ++ret;
-      }
-      if(wanted & want::gid)
-      {
-        st_gid = s.stx_gid;
-        ++ret;
-      }
-      if(wanted & want::rdev)
-      {
-        st_rdev = makedev(s.stx_rdev_major, s.stx_rdev_minor);
-        ++ret;
-      }
-      if(wanted & want::atim)
-      {
-        st_atim = to_timepoint(timespec{s.stx_atime.tv_sec, s.stx_atime.tv_nsec});
-        ++ret;
-      }
-      if(wanted & want::mtim)
-      {
-        st_mtim = to_timepoint(timespec{s.stx_mtime.tv_sec, s.stx_mtime.tv_nsec});
-        ++ret;
-      }
-      if(wanted & want::ctim)
-      {
-        st_ctim = to_timepoint(timespec{s.stx_ctime.tv_sec, s.stx_ctime.tv_nsec});
-        ++ret;
-      }
-      if(wanted & want::size)
-      {
-        st_size = s.stx_size;
-        ++ret;
-      }
-      if(wanted & want::allocated)
-      {
-        st_allocated = static_cast<handle::extent_type>(s.stx_blocks) * 512;
-        ++ret;
-      }
-      if(wanted & want::blocks)
-      {
-        st_blocks = s.stx_blocks;
-        ++ret;
-      }
-      if(wanted & want::blksize)
-      {
-        st_blksize = s.stx_blksize;
-        ++ret;
-      }
-      if(wanted & want::birthtim)
-      {
-        st_birthtim = to_timepoint(timespec{s.stx_btime.tv_sec, s.stx_btime.tv_nsec});
-        ++ret;
-      }
-      if(wanted & want::sparse)
-      {
-        st_sparse = static_cast<unsigned int>((static_cast<handle::extent_type>(s.stx_blocks) * 512) < static_cast<handle::extent_type>(s.stx_size));
-        ++ret;
-      }
-      if(wanted & want::compressed)
-      {
-        st_compressed = static_cast<unsigned int>(s.stx_attributes & 0x0004 /*STATX_ATTR_COMPRESSED*/);
-        ++ret;
-      }
-      return ret;
+      return _fill_from_statx(&s, wanted);
     }
     // std::cerr << "statx failed with " << strerror(errno) << std::endl;
   }
@@ -397,6 +397,7 @@ namespace utils
         }
         //std::cerr << i << "\nSize = " << size << " Rss = " << rss << std::endl;
       }
+      ret.private_recycled = detail::map_handle_cache_bytes().load(std::memory_order_relaxed);
       return ret;
     }
     catch(...)
@@ -426,6 +427,7 @@ namespace utils
   ret.total_address_space_paged_in = vmInfo.resident_size;
   ret.private_committed = vmInfo.internal + vmInfo.compressed;
   ret.private_paged_in = vmInfo.phys_footprint;
+  ret.private_recycled = detail::map_handle_cache_bytes().load(std::memory_order_relaxed);
   return ret;
 #else
 #error Unknown platform
@@ -476,6 +478,11 @@ namespace utils
         std::terminate();
       }
     }
+    std::atomic<size_t> &map_handle_cache_bytes() noexcept
+    {
+      static std::atomic<size_t> v(0);
+      return v;
+    }
   }  // namespace detail
 }  // namespace utils
 
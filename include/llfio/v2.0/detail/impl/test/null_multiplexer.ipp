@@ -262,7 +262,7 @@ namespace test
     virtual io_operation_state_type init_io_operation(io_operation_state *_op) noexcept override
     {
       auto *state = static_cast<_null_operation_state *>(_op);
-      auto s = state->current_state();  // read the current state, holding the state's lock
+      auto s = state->current_state();  // read the current state
       switch(s)
       {
       case io_operation_state_type::unknown:
@@ -203,6 +203,18 @@ result<directory_handle> directory_handle::directory(const path_handle &base, pa
   return ret;
 }
 
+bool directory_handle::_co_directory_op::prepare(io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return false;
+}
+
+result<directory_handle> directory_handle::_co_directory_op::finish(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return synchronous();
+}
+
+void directory_handle::_co_directory_op::discard(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept {}
+
 result<directory_handle> directory_handle::reopen(mode mode_, caching caching_, deadline /* unused */) const noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
@@ -455,4 +467,14 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
   return std::move(req.buffers);
 }
 
+bool directory_handle::_co_read_op::prepare(io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return false;
+}
+
+result<directory_handle::buffers_type> directory_handle::_co_read_op::finish(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return synchronous();
+}
+
 LLFIO_V2_NAMESPACE_END
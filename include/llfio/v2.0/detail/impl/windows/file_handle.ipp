@@ -181,6 +181,28 @@ result<file_handle> file_handle::file(const path_handle &base, file_handle::path
   return ret;
 }
 
+bool file_handle::_co_file_op::prepare(io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return false;
+}
+
+result<file_handle> file_handle::_co_file_op::finish(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return synchronous();
+}
+
+void file_handle::_co_file_op::discard(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept {}
+
+bool file_handle::_co_close_op::prepare(io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return false;
+}
+
+result<void> file_handle::_co_close_op::finish(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return synchronous();
+}
+
 result<file_handle> file_handle::temp_inode(const path_handle &dirh, mode _mode, flag flags) noexcept
 {
   windows_nt_kernel::init();
@@ -402,6 +424,14 @@ result<std::vector<file_handle::extent_pair>> file_handle::extents() const noexc
   }
 }
 
+result<std::vector<file_handle::extent_pair>> file_handle::cached_extents(extent_pair extent) const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  // Windows has no facility to query which parts of a file are in the file cache
+  (void) extent;
+  return errc::operation_not_supported;
+}
+
 result<file_handle::extent_pair> file_handle::clone_extents_to(file_handle::extent_pair extent, io_handle &dest_, io_handle::extent_type destoffset, deadline d,
                                                                bool force_copy_now, bool emulate_if_unsupported) noexcept
 {
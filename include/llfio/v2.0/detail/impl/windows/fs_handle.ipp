@@ -391,4 +391,14 @@ result<void> fs_handle::unlink(deadline d) noexcept
   return success();
 }
 
+bool fs_handle::_co_stat_op::prepare(io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return false;
+}
+
+result<stat_t> fs_handle::_co_stat_op::finish(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept
+{
+  return synchronous();
+}
+
 LLFIO_V2_NAMESPACE_END
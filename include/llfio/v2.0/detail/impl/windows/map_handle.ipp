@@ -178,15 +178,12 @@ result<section_handle> section_handle::section(file_handle &backing, extent_type
   return ret;
 }
 
-result<section_handle> section_handle::section(extent_type bytes, const path_handle &dirh, flag _flag) noexcept
+// Creates a section over backingh, or over the paging file if backingh is null
+static inline result<void> create_unbacked_section(native_handle_type &nativeh, section_handle::extent_type bytes, section_handle::flag _flag, HANDLE backingh) noexcept
 {
   windows_nt_kernel::init();
   using namespace windows_nt_kernel;
-  OUTCOME_TRY(auto &&_anonh, file_handle::temp_inode(dirh));
-  OUTCOME_TRYV(_anonh.truncate(bytes));
-  result<section_handle> ret(section_handle(native_handle_type(), nullptr, std::move(_anonh), _flag));
-  native_handle_type &nativeh = ret.value()._v;
-  file_handle &anonh = ret.value()._anonymous;
+  using flag = section_handle::flag;
   ULONG prot = 0, attribs = 0;
   if(_flag & flag::read)
   {
@@ -255,17 +252,73 @@ result<section_handle> section_handle::section(extent_type bytes, const path_han
   nativeh.behaviour |= native_handle_type::disposition::section;
   LARGE_INTEGER _maximum_size{}, *pmaximum_size = &_maximum_size;
   _maximum_size.QuadPart = bytes;
-  LLFIO_LOG_FUNCTION_CALL(&ret);
   HANDLE h;
-  NTSTATUS ntstat = NtCreateSection(&h, SECTION_ALL_ACCESS, nullptr, pmaximum_size, prot, attribs, anonh.native_handle().h);
+  NTSTATUS ntstat = NtCreateSection(&h, SECTION_ALL_ACCESS, nullptr, pmaximum_size, prot, attribs, backingh);
   if(ntstat < 0)
   {
     return ntkernel_error(ntstat);
   }
   nativeh.h = h;
+  return success();
+}
+
+result<section_handle> section_handle::section(extent_type bytes, const path_handle &dirh, flag _flag) noexcept
+{
+  OUTCOME_TRY(auto &&_anonh, file_handle::temp_inode(dirh));
+  OUTCOME_TRYV(_anonh.truncate(bytes));
+  result<section_handle> ret(section_handle(native_handle_type(), nullptr, std::move(_anonh), _flag));
+  file_handle &anonh = ret.value()._anonymous;
+  LLFIO_LOG_FUNCTION_CALL(&ret);
+  OUTCOME_TRYV(create_unbacked_section(ret.value()._v, bytes, _flag, anonh.native_handle().h));
+  return ret;
+}
+
+result<section_handle> section_handle::anonymous_section(extent_type bytes, flag _flag) noexcept
+{
+  if(bytes == 0u)
+  {
+    return errc::invalid_argument;
+  }
+  // A section with no file handle is backed by the paging file
+  result<section_handle> ret(section_handle(native_handle_type(), nullptr, file_handle(), _flag));
+  LLFIO_LOG_FUNCTION_CALL(&ret);
+  OUTCOME_TRYV(create_unbacked_section(ret.value()._v, bytes, _flag, nullptr));
+  return ret;
+}
+
+result<section_handle> section_handle::from_native_handle(native_handle_type nativeh, flag _flag) noexcept
+{
+  if(nativeh.h == nullptr || nativeh.h == INVALID_HANDLE_VALUE)
+  {
+    return errc::invalid_argument;
+  }
+  nativeh.behaviour |= native_handle_type::disposition::section;
+  if(_flag & flag::read)
+  {
+    nativeh.behaviour |= native_handle_type::disposition::readable;
+  }
+  if(_flag & flag::write)
+  {
+    nativeh.behaviour |= native_handle_type::disposition::writable;
+  }
+  result<section_handle> ret(section_handle(nativeh, nullptr, file_handle(), _flag));
+  LLFIO_LOG_FUNCTION_CALL(&ret);
   return ret;
 }
 
+result<void> section_handle::add_seals(seal_flag seals) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  (void) seals;
+  return errc::operation_not_supported;
+}
+
+result<section_handle::seal_flag> section_handle::seals() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  return seal_flag::none;
+}
+
 result<section_handle::extent_type> section_handle::length() const noexcept
 {
   windows_nt_kernel::init();
@@ -619,6 +672,21 @@ map_handle::io_result<map_handle::const_buffers_type> map_handle::_do_barrier(ma
 }
 
 
+map_handle::cache_statistics map_handle::trim_cache(std::chrono::steady_clock::time_point /*unused*/) noexcept
+{
+  return {};
+}
+
+bool map_handle::set_cache_disabled(bool /*unused*/) noexcept
+{
+  return true;
+}
+
+size_t map_handle::set_cache_limit(size_t /*unused*/) noexcept
+{
+  return 0;
+}
+
 result<map_handle> map_handle::map(size_type bytes, bool /*unused*/, section_handle::flag _flag) noexcept
 {
   // TODO: Keep a cache of DiscardVirtualMemory()/MEM_RESET pages deallocated
@@ -705,6 +773,43 @@ result<map_handle> map_handle::map(section_handle &section, size_type bytes, ext
   return ret;
 }
 
+result<map_handle> map_handle::map_at(byte *addr, section_handle &section, size_type bytes, extent_type offset, section_handle::flag _flag) noexcept
+{
+  windows_nt_kernel::init();
+  using namespace windows_nt_kernel;
+  if(addr == nullptr || bytes == 0u)
+  {
+    return errc::invalid_argument;
+  }
+  OUTCOME_TRY(auto &&length, section.length());
+  result<map_handle> ret{map_handle(&section, _flag)};
+  native_handle_type &nativeh = ret.value()._v;
+  ULONG allocation = 0, prot;
+  PVOID base = addr;
+  size_t commitsize = bytes;
+  LARGE_INTEGER _offset{};
+  _offset.QuadPart = offset;
+  OUTCOME_TRY(auto &&pagesize, detail::pagesize_from_flags(ret.value()._flag));
+  SIZE_T _bytes = bytes;
+  OUTCOME_TRY(win32_map_flags(nativeh, allocation, prot, commitsize, section.backing() != nullptr, ret.value()._flag));
+  LLFIO_LOG_FUNCTION_CALL(&ret);
+  // The kernel places the view at the base address given if it is free, else it fails
+  NTSTATUS ntstat = NtMapViewOfSection(section.native_handle().h, GetCurrentProcess(), &base, 0, commitsize, &_offset, &_bytes, ViewUnmap, allocation, prot);
+  if(ntstat < 0)
+  {
+    return ntkernel_error(ntstat);
+  }
+  ret.value()._addr = static_cast<byte *>(base);
+  ret.value()._offset = offset;
+  ret.value()._reservation = _bytes;
+  ret.value()._length = (length - offset < bytes) ? (length - offset) : bytes;
+  ret.value()._pagesize = pagesize;
+  // Make my handle borrow the native handle of my backing storage
+  ret.value()._v.h = section.backing_native_handle().h;
+  nativeh.behaviour |= native_handle_type::disposition::allocation;
+  return ret;
+}
+
 result<map_handle::size_type> map_handle::truncate(size_type newsize, bool /* unused */) noexcept
 {
   windows_nt_kernel::init();
@@ -895,6 +1000,45 @@ result<span<map_handle::buffer_type>> map_handle::prefetch(span<buffer_type> reg
   return regions;
 }
 
+result<span<byte>> map_handle::residency(span<byte> bitmap, buffer_type region) noexcept
+{
+  windows_nt_kernel::init();
+  using namespace windows_nt_kernel;
+  LLFIO_LOG_FUNCTION_CALL(0);
+  const size_t pagesize = utils::page_size();
+  region = utils::round_to_page_size_larger(region, pagesize);
+  const size_t pages = region.size() / pagesize;
+  if(bitmap.size() < (pages + 7) / 8)
+  {
+    return errc::invalid_argument;
+  }
+  bitmap = {bitmap.data(), (pages + 7) / 8};
+  memset(bitmap.data(), 0, bitmap.size());
+  MEMORY_WORKING_SET_EX_INFORMATION mwsei[256];
+  for(size_t n = 0; n < pages; n += 256)
+  {
+    const size_t thispages = std::min(pages - n, (size_t) 256);
+    for(size_t i = 0; i < thispages; i++)
+    {
+      mwsei[i].VirtualAddress = region.data() + (n + i) * pagesize;
+    }
+    SIZE_T written = 0;
+    NTSTATUS ntstat = NtQueryVirtualMemory(GetCurrentProcess(), nullptr, MemoryWorkingSetExInformation, mwsei, thispages * sizeof(MEMORY_WORKING_SET_EX_INFORMATION), &written);
+    if(ntstat < 0)
+    {
+      return ntkernel_error(ntstat);
+    }
+    for(size_t i = 0; i < thispages; i++)
+    {
+      if(mwsei[i].VirtualAttributes.IfValid.Valid)
+      {
+        bitmap[(n + i) / 8] |= to_byte(static_cast<unsigned char>(1U << ((n + i) % 8)));
+      }
+    }
+  }
+  return bitmap;
+}
+
 result<map_handle::buffer_type> map_handle::do_not_store(buffer_type region) noexcept
 {
   windows_nt_kernel::init();
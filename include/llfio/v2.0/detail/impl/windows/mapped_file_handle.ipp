@@ -68,6 +68,8 @@ result<mapped_file_handle::size_type> mapped_file_handle::reserve(size_type rese
   {
     map_size = length;
   }
+  // A copy on write section must be viewed copy on write, which map_handle does not take from the section
+  mapflags |= _sh.section_flags() & section_handle::flag::cow;
   OUTCOME_TRYV(_mh.close());
   OUTCOME_TRY(auto &&mh, map_handle::map(_sh, map_size, 0, mapflags));
   _mh = std::move(mh);
@@ -78,6 +80,7 @@ result<mapped_file_handle::size_type> mapped_file_handle::reserve(size_type rese
 result<void> mapped_file_handle::close() noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  _prefetcher.reset();
   if(_mh.is_valid())
   {
     OUTCOME_TRYV(_mh.close());
@@ -91,6 +94,7 @@ result<void> mapped_file_handle::close() noexcept
 native_handle_type mapped_file_handle::release() noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  _prefetcher.reset();
   if(_mh.is_valid())
   {
     (void) _mh.close();
@@ -193,4 +197,19 @@ result<mapped_file_handle::extent_type> mapped_file_handle::update_map() noexcep
   return length;
 }
 
+void mapped_file_handle::_prefetcher_drop(extent_type offset, size_type bytes) noexcept
+{
+  if(offset >= _mh.length())
+  {
+    return;
+  }
+  if(offset + bytes > _mh.length())
+  {
+    bytes = static_cast<size_type>(_mh.length() - offset);
+  }
+  // Unlocking pages which are not locked removes them from the working set, which is
+  // the closest Windows has to dropping them without losing their contents
+  (void) VirtualUnlock(_mh.address() + offset, bytes);
+}
+
 LLFIO_V2_NAMESPACE_END
@@ -236,6 +236,7 @@ namespace utils
 
     ret.private_committed = vmc.PrivateUsage;
     ret.private_paged_in = vmc.PrivateWorkingSetSize;
+    ret.private_recycled = detail::map_handle_cache_bytes().load(std::memory_order_relaxed);
     return ret;
   }
 
@@ -274,6 +275,11 @@ namespace utils
         std::terminate();
       }
     }
+    std::atomic<size_t> &map_handle_cache_bytes() noexcept
+    {
+      static std::atomic<size_t> v(0);
+      return v;
+    }
   }  // namespace detail
 }  // namespace utils
 
@@ -243,6 +243,40 @@ public:
   */
   LLFIO_MAKE_FREE_FUNCTION
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<directory_handle> directory(const path_handle &base, path_view_type path, mode _mode = mode::read, creation _creation = creation::open_existing, caching _caching = caching::all, flag flags = flag::none) noexcept;
+  //! The operation performed by the awaitable returned by `co_directory()`
+  struct LLFIO_DECL _co_directory_op
+  {
+    using result_type = result<directory_handle>;
+    const path_handle *base{nullptr};
+    path_view_type path;
+    mode _mode{mode::read};
+    creation _creation{creation::open_existing};
+    caching _caching{caching::all};
+    flag flags{flag::none};
+    optional<path_view::c_str<>> zpath;
+    native_handle_type nativeh;
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool prepare(io_multiplexer::syscall_operation_state &s) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result_type finish(const io_multiplexer::syscall_operation_state &s) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void discard(const io_multiplexer::syscall_operation_state &s) noexcept;
+    result_type synchronous() noexcept { return directory(*base, path, _mode, _creation, _caching, flags); }
+  };
+  /*! \brief Returns an awaitable which opens a directory handle as per `directory()` using `ctx`,
+  or synchronously if `ctx` is null or cannot do so.
+
+  On Linux with io_uring, the `openat()` of an existing directory is performed by the kernel
+  asynchronously. Creating directories is always performed synchronously. Unless
+  `flag::disable_safety_unlinks` is set, the inode of the directory is fetched synchronously
+  after opening, as with `directory()`.
+
+  As with all awaitables, `base` and `path` must remain valid until the awaitable is ready.
+
+  \errors Any of the values POSIX open() or CreateFile() can return.
+  */
+  static io_multiplexer::syscall_awaitable<_co_directory_op> co_directory(const path_handle &base, path_view_type path, mode _mode = mode::read, creation _creation = creation::open_existing, caching _caching = caching::all, flag flags = flag::none, io_multiplexer *ctx = this_thread::multiplexer()) noexcept
+  {
+    return {ctx, _co_directory_op{&base, path, _mode, _creation, _caching, flags}};
+  }
   /*! Create a directory handle creating a uniquely named file on a path.
   The file is opened exclusively with `creation::only_if_not_exist` so it
   will never collide with nor overwrite any existing entry.
@@ -354,6 +388,42 @@ public:
   */
   LLFIO_MAKE_FREE_FUNCTION
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<buffers_type> read(io_request<buffers_type> req, deadline d = std::chrono::seconds(30)) const noexcept;
+  //! The operation performed by the awaitable returned by `co_read()`
+  struct LLFIO_DECL _co_read_op
+  {
+    using result_type = result<buffers_type>;
+    const directory_handle *h{nullptr};
+    io_request<buffers_type> req;
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool prepare(io_multiplexer::syscall_operation_state &s) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result_type finish(const io_multiplexer::syscall_operation_state &s) noexcept;
+    void discard(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept {}
+    result_type synchronous() noexcept { return h->read(std::move(req)); }
+  };
+  /*! \brief Returns an awaitable which fills the buffers type as per `read()` using `ctx`,
+  or synchronously if `ctx` is null or cannot do so.
+
+  On Linux with io_uring or epoll, the `getdents64()` is performed upon the syscall worker
+  threads of the multiplexer, as no kernel supplies an asynchronous directory enumeration.
+  Many directories can thus be enumerated at once, which helps most with networked
+  filesystems. The `getdents64()` is serialised with any `read()` of this handle. A glob
+  without wildcards is a `stat()`, which is performed synchronously.
+
+  As with all awaitables, this handle, the directory entries to be filled, and any kernel
+  buffer of the request must remain valid until the awaitable is ready.
+
+  \errors As for `read()`.
+  */
+  io_multiplexer::syscall_awaitable<_co_read_op> co_read(io_request<buffers_type> req, io_multiplexer *ctx = this_thread::multiplexer()) const noexcept
+  {
+    return {ctx, _co_read_op{this, std::move(req)}};
+  }
+
+private:
+#ifndef _WIN32
+  // Fills the buffers of the request from the dirents returned by getdents()
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<buffers_type> _fill_buffers(io_request<buffers_type> &req, const char *zglob, const void *dirents, int bytes) noexcept;
+#endif
 };
 inline std::ostream &operator<<(std::ostream &s, const directory_handle::filter &v)
 {
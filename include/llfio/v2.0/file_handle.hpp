@@ -153,6 +153,41 @@ public:
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<file_handle> file(const path_handle &base, path_view_type path, mode _mode = mode::read,
                                                                   creation _creation = creation::open_existing, caching _caching = caching::all,
                                                                   flag flags = flag::none) noexcept;
+  //! The operation performed by the awaitable returned by `co_file()`
+  struct LLFIO_DECL _co_file_op
+  {
+    using result_type = result<file_handle>;
+    const path_handle *base{nullptr};
+    path_view_type path;
+    mode _mode{mode::read};
+    creation _creation{creation::open_existing};
+    caching _caching{caching::all};
+    flag flags{flag::none};
+    optional<path_view::c_str<>> zpath;
+    native_handle_type nativeh;
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool prepare(io_multiplexer::syscall_operation_state &s) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result_type finish(const io_multiplexer::syscall_operation_state &s) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void discard(const io_multiplexer::syscall_operation_state &s) noexcept;
+    result_type synchronous() noexcept { return file(*base, path, _mode, _creation, _caching, flags); }
+  };
+  /*! \brief Returns an awaitable which opens a file handle as per `file()` using `ctx`, or
+  synchronously if `ctx` is null or cannot do so.
+
+  On Linux with io_uring, the `openat()` is performed by the kernel asynchronously. Replacing
+  an existing file with `creation::always_new` is a sequence of operations, and is always
+  performed synchronously. The handle returned has no multiplexer set, as with `file()`.
+
+  As with all awaitables, `base` and `path` must remain valid until the awaitable is ready.
+
+  \errors Any of the values POSIX open() or CreateFile() can return.
+  */
+  static io_multiplexer::syscall_awaitable<_co_file_op> co_file(const path_handle &base, path_view_type path, mode _mode = mode::read,
+                                                                creation _creation = creation::open_existing, caching _caching = caching::all,
+                                                                flag flags = flag::none, io_multiplexer *ctx = this_thread::multiplexer()) noexcept
+  {
+    return {ctx, _co_file_op{&base, path, _mode, _creation, _caching, flags}};
+  }
   /*! Create a file handle creating a uniquely named file on a path.
   The file is opened exclusively with `creation::only_if_not_exist` so it
   will never collide with nor overwrite any existing file. Note also
@@ -250,6 +285,30 @@ public:
 #endif
     return io_handle::close();
   }
+  //! The operation performed by the awaitable returned by `co_close()`
+  struct LLFIO_DECL _co_close_op
+  {
+    using result_type = result<void>;
+    file_handle *h{nullptr};
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool prepare(io_multiplexer::syscall_operation_state &s) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result_type finish(const io_multiplexer::syscall_operation_state &s) noexcept;
+    void discard(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept {}
+    result_type synchronous() noexcept { return h->close(); }
+  };
+  /*! \brief Returns an awaitable which closes this handle using its multiplexer, or if it
+  has none, `this_thread::multiplexer()`. If neither is set, or it cannot do so, the handle
+  is closed synchronously using `close()`.
+
+  On Linux with io_uring, the `close()` is performed by the kernel asynchronously. The handle
+  is deregistered from its multiplexer, and becomes invalid, upon the awaitable being
+  initiated. Handles with `flag::unlink_on_first_close`, or which issue safety barriers,
+  are always closed synchronously.
+  */
+  io_multiplexer::syscall_awaitable<_co_close_op> co_close() noexcept
+  {
+    return {(_ctx != nullptr) ? _ctx : this_thread::multiplexer(), _co_close_op{this}};
+  }
 
   /*! Reopen this handle (copy constructor is disabled to avoid accidental copying),
   optionally race free reopening the handle with different access or caching.
@@ -310,6 +369,31 @@ public:
   LLFIO_MAKE_FREE_FUNCTION
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<extent_pair>> extents() const noexcept;
 
+  /*! \brief Returns a list of the extents of this open file currently held in the kernel page cache. WARNING: racy!
+  \return A vector of pairs of extent offset + extent length representing the page aligned
+  extents within `extent` which are resident in memory, so reading them would not need to
+  wait upon storage. Default is the whole file.
+  \param extent The extent to query. Its start is rounded down to the page size, and no extent
+  returned ends after the end of `extent` or the end of the file.
+
+  On Linux, `cachestat()` is used where available to answer quickly if the region is wholly
+  cached or wholly uncached. Otherwise the file is mapped without access permissions a chunk at
+  a time, and `mincore()` is used to determine which pages are resident. This is cheap compared
+  to doing i/o, but not free: querying a file of hundreds of gigabytes takes milliseconds.
+
+  Since Linux 5.0, `mincore()` only reports the page cache residency of a file which the caller
+  owns or could open for writing, otherwise it reports only the pages mapped into this process,
+  which would be none. Rather than return that wrong answer, if `cachestat()` cannot answer and
+  this handle is not writable and the file is not owned by the effective user, this fails with
+  `errc::permission_denied`.
+
+  \errors Any of the values POSIX mmap() or mincore() can return. `errc::permission_denied`
+  on Linux if the page cache residency cannot be determined reliably, as above.
+  `errc::operation_not_supported` on Microsoft Windows, which has no facility to query the file cache.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<std::vector<extent_pair>> cached_extents(extent_pair extent = {(extent_type) -1, (extent_type) -1}) const noexcept;
+
   /*! \brief Clones the extents referred to by `extent` to `dest` at `destoffset`. This
   is how you ought to copy file content, including within the same file. This is
   fundamentally a racy call with respect to concurrent modification of the files.
@@ -511,6 +595,34 @@ inline result<std::vector<file_handle::extent_pair>> extents(const file_handle &
 {
   return self.extents();
 }
+/*! \brief Returns a list of the extents of this open file currently held in the kernel page cache. WARNING: racy!
+\return A vector of pairs of extent offset + extent length representing the page aligned
+extents within `extent` which are resident in memory, so reading them would not need to
+wait upon storage. Default is the whole file.
+\param extent The extent to query. Its start is rounded down to the page size, and no extent
+returned ends after the end of `extent` or the end of the file.
+
+On Linux, `cachestat()` is used where available to answer quickly if the region is wholly
+cached or wholly uncached. Otherwise the file is mapped without access permissions a chunk at
+a time, and `mincore()` is used to determine which pages are resident. This is cheap compared
+to doing i/o, but not free: querying a file of hundreds of gigabytes takes milliseconds.
+
+Since Linux 5.0, `mincore()` only reports the page cache residency of a file which the caller
+owns or could open for writing, otherwise it reports only the pages mapped into this process,
+which would be none. Rather than return that wrong answer, if `cachestat()` cannot answer and
+this handle is not writable and the file is not owned by the effective user, this fails with
+`errc::permission_denied`.
+
+\errors Any of the values POSIX mmap() or mincore() can return. `errc::permission_denied`
+on Linux if the page cache residency cannot be determined reliably, as above.
+`errc::operation_not_supported` on Microsoft Windows, which has no facility to query the file cache.
+*/
+inline result<std::vector<file_handle::extent_pair>> cached_extents(const file_handle &self,
+                                                                     file_handle::extent_pair extent = {(file_handle::extent_type) -1,
+                                                                                                        (file_handle::extent_type) -1}) noexcept
+{
+  return self.cached_extents(std::forward<decltype(extent)>(extent));
+}
 /*! \brief Efficiently zero, and possibly deallocate, data on storage.
 
 On most major operating systems and with recent filing systems which are "extents based", one can
@@ -25,8 +25,10 @@ Distributed under the Boost Software License, Version 1.0.
 #ifndef LLFIO_FS_HANDLE_H
 #define LLFIO_FS_HANDLE_H
 
+#include "io_multiplexer.hpp"
 #include "path_handle.hpp"
 #include "path_view.hpp"
+#include "stat.hpp"
 
 #include "quickcpplib/uint128.hpp"
 
@@ -242,6 +244,40 @@ public:
   result<void> unlink(deadline d = std::chrono::seconds(30)) noexcept;
 
   LLFIO_DEADLINE_TRY_FOR_UNTIL(unlink)
+
+  //! The operation performed by the awaitable returned by `co_stat()`
+  struct LLFIO_DECL _co_stat_op
+  {
+    using result_type = result<stat_t>;
+    const handle *h{nullptr};
+    stat_t::want wanted{stat_t::want::all};
+#ifdef __linux__
+    alignas(8) byte statxbuf[stat_t::_statx_buffer_size];
+#endif
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool prepare(io_multiplexer::syscall_operation_state &s) noexcept;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result_type finish(const io_multiplexer::syscall_operation_state &s) noexcept;
+    void discard(const io_multiplexer::syscall_operation_state & /*unused*/) noexcept {}
+    result_type synchronous() noexcept
+    {
+      stat_t ret(nullptr);
+      OUTCOME_TRY(ret.fill(*h, wanted));
+      return ret;
+    }
+  };
+  /*! \brief Returns an awaitable which fetches the metadata `wanted` about this handle's inode
+  using `ctx`, or synchronously via `stat_t::fill()` if `ctx` is null or cannot do so.
+
+  On Linux with io_uring, this is a `statx()` performed by the kernel asynchronously. Note that
+  the multiplexer set upon a handle is not used unless you pass it as `ctx`.
+
+  \errors Any of the values POSIX `statx()`, `fstat()` or `GetFileInformationByHandleEx()` can return.
+  */
+  io_multiplexer::syscall_awaitable<_co_stat_op> co_stat(stat_t::want wanted = stat_t::want::all,
+                                                         io_multiplexer *ctx = this_thread::multiplexer()) const noexcept
+  {
+    return {ctx, _co_stat_op{&_get_handle(), wanted}};
+  }
 };
 
 namespace detail
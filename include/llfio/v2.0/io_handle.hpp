@@ -57,6 +57,9 @@ public:
   using buffers_type = io_multiplexer::buffers_type;
   using const_buffers_type = io_multiplexer::const_buffers_type;
   using registered_buffer_type = io_multiplexer::registered_buffer_type;
+  using io_priority_class = io_multiplexer::io_priority_class;
+  using io_priority = io_multiplexer::io_priority;
+  using io_flag = io_multiplexer::io_flag;
   template <class T> using io_request = io_multiplexer::io_request<T>;
   template <class T> using io_result = io_multiplexer::io_result<T>;
   template <class T> using awaitable = io_multiplexer::awaitable<T>;
@@ -142,61 +145,80 @@ protected:
   //! The virtualised implementation of `barrier()` used if no multiplexer has been set.
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept;
 
-  io_result<buffers_type> _do_multiplexer_read(registered_buffer_type &&base, io_request<buffers_type> reqs, deadline d) noexcept
+  // Waits for i/o initiated by the blocking functions to finish. Multiplexers ought to time out
+  // the i/o themselves, but if the deadline passes without that happening it gets cancelled.
+  // Returns whether it was cancelled.
+  result<bool> _do_multiplexer_wait(io_multiplexer::io_operation_state *state, deadline d) noexcept
   {
     LLFIO_DEADLINE_TO_SLEEP_INIT(d);
-    const auto state_reqs = _ctx->io_state_requirements();
-    auto *storage = (byte *) alloca(state_reqs.first + state_reqs.second);
-    const auto diff = (uintptr_t) storage & (state_reqs.second - 1);
-    storage += state_reqs.second - diff;
-    auto *state = _ctx->construct_and_init_io_operation({storage, state_reqs.first}, this, nullptr, std::move(base), d, std::move(reqs));
+    auto check_deadline = [&]() -> result<void> {
+      LLFIO_DEADLINE_TO_TIMEOUT_LOOP(d);
+      return success();
+    };
+    bool cancelled = false;
     OUTCOME_TRY(_ctx->flush_inited_io_operations());
     while(!is_finished(_ctx->check_io_operation(state)))
     {
       deadline nd;
-      LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+      if(!cancelled)
+      {
+        LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+      }
       OUTCOME_TRY(_ctx->check_for_any_completed_io(nd));
+      if(!cancelled && !is_finished(state->current_state()) && !check_deadline())
+      {
+        OUTCOME_TRY(_ctx->cancel_io_operation(state));
+        cancelled = true;
+      }
     }
+    return cancelled;
+  }
+  io_result<buffers_type> _do_multiplexer_read(registered_buffer_type &&base, io_request<buffers_type> reqs, deadline d) noexcept
+  {
+    const auto state_reqs = _ctx->io_state_requirements();
+    auto *storage = (byte *) alloca(state_reqs.first + state_reqs.second);
+    const auto diff = (uintptr_t) storage & (state_reqs.second - 1);
+    storage += state_reqs.second - diff;
+    auto *state = _ctx->construct_and_init_io_operation({storage, state_reqs.first}, this, nullptr, std::move(base), d, std::move(reqs));
+    OUTCOME_TRY(auto &&cancelled, _do_multiplexer_wait(state, d));
     io_result<buffers_type> ret = std::move(*state).get_completed_read();
     state->~io_operation_state();
+    if(cancelled && !ret && ret.error() == errc::operation_canceled)
+    {
+      return errc::timed_out;
+    }
     return ret;
   }
   io_result<const_buffers_type> _do_multiplexer_write(registered_buffer_type &&base, io_request<const_buffers_type> reqs, deadline d) noexcept
   {
-    LLFIO_DEADLINE_TO_SLEEP_INIT(d);
     const auto state_reqs = _ctx->io_state_requirements();
     auto *storage = (byte *) alloca(state_reqs.first + state_reqs.second);
     const auto diff = (uintptr_t) storage & (state_reqs.second - 1);
     storage += state_reqs.second - diff;
     auto *state = _ctx->construct_and_init_io_operation({storage, state_reqs.first}, this, nullptr, std::move(base), d, std::move(reqs));
-    OUTCOME_TRY(_ctx->flush_inited_io_operations());
-    while(!is_finished(_ctx->check_io_operation(state)))
-    {
-      deadline nd;
-      LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
-      OUTCOME_TRY(_ctx->check_for_any_completed_io(nd));
-    }
+    OUTCOME_TRY(auto &&cancelled, _do_multiplexer_wait(state, d));
     io_result<const_buffers_type> ret = std::move(*state).get_completed_write_or_barrier();
     state->~io_operation_state();
+    if(cancelled && !ret && ret.error() == errc::operation_canceled)
+    {
+      return errc::timed_out;
+    }
     return ret;
   }
   io_result<const_buffers_type> _do_multiplexer_barrier(registered_buffer_type &&base, io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept
   {
-    LLFIO_DEADLINE_TO_SLEEP_INIT(d);
     const auto state_reqs = _ctx->io_state_requirements();
     auto *storage = (byte *) alloca(state_reqs.first + state_reqs.second);
     const auto diff = (uintptr_t) storage & (state_reqs.second - 1);
     storage += state_reqs.second - diff;
     auto *state = _ctx->construct_and_init_io_operation({storage, state_reqs.first}, this, nullptr, std::move(base), d, std::move(reqs), kind);
-    OUTCOME_TRY(_ctx->flush_inited_io_operations());
-    while(!is_finished(_ctx->check_io_operation(state)))
-    {
-      deadline nd;
-      LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
-      OUTCOME_TRY(_ctx->check_for_any_completed_io(nd));
-    }
+    OUTCOME_TRY(auto &&cancelled, _do_multiplexer_wait(state, d));
     io_result<const_buffers_type> ret = std::move(*state).get_completed_write_or_barrier();
     state->~io_operation_state();
+    if(cancelled && !ret && ret.error() == errc::operation_canceled)
+    {
+      return errc::timed_out;
+    }
     return ret;
   }
 
@@ -211,7 +233,9 @@ public:
 
   Note also that some OSs will error out if you supply more than this limit to `read()` or `write()`,
   but other OSs do not. Some OSs guarantee that each i/o syscall has effects atomically visible or not
-  to other i/o, other OSs do not.
+  to other i/o, other OSs do not. On POSIX, `read()` and `write()` split scatter-gather lists longer
+  than this limit into batches of this many buffers, issued in sequence, stopping at the first batch which
+  transfers less than requested. Any atomicity then applies per batch, not per `read()` or `write()`.
 
   OS X does not implement scatter-gather file i/o syscalls. Thus this function will always return
   `1` in that situation.
@@ -503,6 +527,11 @@ inline result<void> io_handle::set_multiplexer(io_multiplexer *c) noexcept
   return success();
 }
 
+inline result<void> io_multiplexer_group::set_multiplexer(io_handle &h) noexcept
+{
+  return h.set_multiplexer(current());
+}
+
 inline size_t io_multiplexer::do_io_handle_max_buffers(const io_handle *h) const noexcept
 {
   return h->_do_max_buffers();
@@ -511,6 +540,18 @@ inline result<io_multiplexer::registered_buffer_type> io_multiplexer::do_io_hand
 {
   return h->_do_allocate_registered_buffer(bytes);
 }
+inline io_multiplexer::io_result<io_multiplexer::buffers_type> io_multiplexer::_do_io_handle_read(io_handle *h, registered_buffer_type &&base, io_request<buffers_type> reqs, deadline d) noexcept
+{
+  return h->_do_read(std::move(base), reqs, d);
+}
+inline io_multiplexer::io_result<io_multiplexer::const_buffers_type> io_multiplexer::_do_io_handle_write(io_handle *h, registered_buffer_type &&base, io_request<const_buffers_type> reqs, deadline d) noexcept
+{
+  return h->_do_write(std::move(base), reqs, d);
+}
+inline io_multiplexer::io_result<io_multiplexer::const_buffers_type> io_multiplexer::_do_io_handle_barrier(io_handle *h, io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept
+{
+  return h->_do_barrier(reqs, kind, d);
+}
 template <class T> inline bool io_multiplexer::awaitable<T>::await_ready() noexcept
 {
   auto state = _state->current_state();
@@ -529,6 +570,7 @@ template <class T> inline io_multiplexer::awaitable<T>::~awaitable()
     auto state = _state->current_state();
     if(state != io_operation_state_type::unknown && !is_initialised(state) && !is_finished(state))
     {
+      _group = nullptr;
 #if LLFIO_ENABLE_COROUTINES
       // Resumption of the coroutine at this point causes recursion into this destructor, so prevent that
       _coro = {};
@@ -536,8 +578,9 @@ template <class T> inline io_multiplexer::awaitable<T>::~awaitable()
       state = _state->h->multiplexer()->check_io_operation(_state);
       if(!is_completed(state))
       {
-        // Cancel the i/o
+        // Cancel the i/o, which may finish it immediately
         (void) _state->h->multiplexer()->cancel_io_operation(_state);
+        state = _state->current_state();
       }
       while(!is_finished(state))
       {
@@ -549,6 +592,185 @@ template <class T> inline io_multiplexer::awaitable<T>::~awaitable()
     _state->~io_operation_state();
   }
 }
+template <class T> inline void io_multiplexer::awaitable<T>::_finished(lock_guard &g) noexcept
+{
+  // The group cannot go away whilst its coroutine is suspended, and only the
+  // finish which completes the group resumes it
+  auto *group = _group;
+  _group = nullptr;
+  if(!group->_element_finished(this))
+  {
+    return;
+  }
+#if LLFIO_ENABLE_COROUTINES
+  auto coro = group->_coro;
+  g.unlock();
+  if(coro)
+  {
+    coro.resume();
+  }
+#else
+  (void) g;
+#endif
+}
+template <class T> inline bool io_multiplexer::awaitable_group<T>::_element_finished(awaitable<T> *a) noexcept
+{
+  if(_any)
+  {
+    size_t expected = (size_t) -1;
+    if(!_first.compare_exchange_strong(expected, (size_t)(a - _awaitables.data()), std::memory_order_acq_rel))
+    {
+      return false;
+    }
+  }
+  return _count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+template <class T> inline void io_multiplexer::awaitable_group<T>::_detach() noexcept
+{
+  if(!_registered)
+  {
+    return;
+  }
+  _registered = false;
+  // Awaitables not yet finished must stop referring to this group
+  for(auto &a : _awaitables)
+  {
+    if(a._state != nullptr)
+    {
+      a._state->invoke(make_function_ptr<void *(io_operation_state_type)>([&](io_operation_state_type /*unused*/) -> void * {
+        if(a._group == this)
+        {
+          a._group = nullptr;
+        }
+        return nullptr;
+      }));
+    }
+  }
+}
+template <class T> inline bool io_multiplexer::awaitable_group<T>::await_ready() noexcept
+{
+  io_multiplexer *last = nullptr;
+  bool any_finished = false, all_finished = true;
+  for(size_t n = 0; n < _awaitables.size(); n++)
+  {
+    auto *state = _awaitables[n]._state;
+    if(state == nullptr)
+    {
+      continue;
+    }
+    auto s = state->current_state();
+    if(s == io_operation_state_type::unknown)
+    {
+      // Its result has already been retrieved
+      continue;
+    }
+    if(is_initialised(s))
+    {
+      // Initiate everything first, then tell each multiplexer once
+      auto *multiplexer = state->h->multiplexer();
+      if(last != nullptr && multiplexer != last)
+      {
+        (void) last->flush_inited_io_operations();
+      }
+      last = multiplexer;
+      s = multiplexer->init_io_operation(state);
+    }
+    if(is_finished(s))
+    {
+      if(!any_finished && _any)
+      {
+        _first.store(n, std::memory_order_relaxed);
+      }
+      any_finished = true;
+    }
+    else
+    {
+      all_finished = false;
+    }
+  }
+  if(last != nullptr)
+  {
+    (void) last->flush_inited_io_operations();
+  }
+  return _any ? (any_finished || _awaitables.empty()) : all_finished;
+}
+#if LLFIO_ENABLE_COROUTINES
+template <class T> inline bool io_multiplexer::awaitable_group<T>::await_suspend(coroutine_handle<> coro) noexcept
+{
+  _coro = coro;
+  _registered = true;
+  // The suspending coroutine holds one count until every awaitable has been visited, so
+  // nothing can resume it before this function has decided whether to suspend
+  _count.store(_any ? 2 : 1, std::memory_order_relaxed);
+  for(size_t n = 0; n < _awaitables.size(); n++)
+  {
+    auto &a = _awaitables[n];
+    if(a._state == nullptr)
+    {
+      continue;
+    }
+    a._state->invoke(make_function_ptr<void *(io_operation_state_type)>([&](io_operation_state_type s) -> void * {
+      if(s == io_operation_state_type::unknown)
+      {
+        return nullptr;
+      }
+      if(is_finished(s))
+      {
+        if(_any)
+        {
+          (void) _element_finished(&a);
+        }
+        return nullptr;
+      }
+      if(!_any)
+      {
+        _count.fetch_add(1, std::memory_order_relaxed);
+      }
+      a._group = this;
+      return nullptr;
+    }));
+  }
+  // Don't suspend if everything needed finished in the meantime
+  return _count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+}
+#endif
+
+/*! \brief Returns a coroutine awaitable which initiates all the awaitables in the span, and
+suspends the awaiting coroutine until all of them have finished. The span of awaitables is
+returned upon resumption.
+
+\note The span must outlive the `co_await`. No memory is allocated.
+*/
+template <class T> inline io_multiplexer::awaitable_group<T> when_all(span<io_multiplexer::awaitable<T>> awaitables) noexcept
+{
+  return io_multiplexer::awaitable_group<T>(awaitables, false);
+}
+//! \overload Contiguous container overload
+template <class Container>
+inline auto when_all(Container &awaitables) noexcept -> io_multiplexer::awaitable_group<typename Container::value_type::result_type>
+{
+  using awaitable_type = typename Container::value_type;
+  return when_all(span<awaitable_type>(awaitables.data(), awaitables.size()));
+}
+
+/*! \brief Returns a coroutine awaitable which initiates all the awaitables in the span, and
+suspends the awaiting coroutine until any one of them has finished. A span of the first
+awaitable to finish is returned upon resumption.
+
+\note The span must outlive the `co_await`. No memory is allocated. Awaitables not finished
+can be awaited again, or destroyed, which cancels their i/o.
+*/
+template <class T> inline io_multiplexer::awaitable_group<T> when_any(span<io_multiplexer::awaitable<T>> awaitables) noexcept
+{
+  return io_multiplexer::awaitable_group<T>(awaitables, true);
+}
+//! \overload Contiguous container overload
+template <class Container>
+inline auto when_any(Container &awaitables) noexcept -> io_multiplexer::awaitable_group<typename Container::value_type::result_type>
+{
+  using awaitable_type = typename Container::value_type;
+  return when_any(span<awaitable_type>(awaitables.data(), awaitables.size()));
+}
 
 // BEGIN make_free_functions.py
 /*! \brief Read data from the open handle.
@@ -623,11 +845,11 @@ LLFIO_V2_NAMESPACE_END
 #include "detail/impl/windows/io_handle.ipp"
 #endif
 #else
-#if LLFIO_ENABLE_TEST_IO_MULTIPLEXERS
-//#include "detail/impl/posix/test/io_uring_multiplexer.ipp"
-#else
-#endif
 #include "detail/impl/posix/io_handle.ipp"
+#ifdef __linux__
+#include "detail/impl/posix/epoll_multiplexer.ipp"
+#include "detail/impl/posix/io_uring_multiplexer.ipp"
+#endif
 #endif
 #undef LLFIO_INCLUDED_BY_HEADER
 #endif
@@ -30,7 +30,9 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "handle.hpp"
 
+#include <atomic>
 #include <memory>  // for unique_ptr and shared_ptr
+#include <vector>
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -163,7 +165,8 @@ If the i/o handle's multiplexer pointer is not null, the multiplexer instance is
 `io_handle::read()`, `io_handle::write()` and `io_handle::barrier()` by constructing an i/o
 operation state on the stack, calling `.init_io_operation()` followed by `.flush_inited_io_operations()`,
 and then spinning on `.check_io_operation()` and `.check_for_any_completed_io()` with the deadline
-specified to the original blocking operation.
+specified to the original blocking operation. If the deadline passes without the multiplexer
+having timed out the i/o itself, the i/o is cancelled and `errc::timed_out` returned.
 
 If the i/o handle's multiplexer pointer is null, `io_handle::read()`, `io_handle::write()` and
 `io_handle::barrier()` all use virtually overridable implementations. The default implementations
@@ -377,17 +380,89 @@ public:
 #endif
 #endif
 
+  //! The scheduling class of an i/o request, see `io_priority`.
+  enum class io_priority_class : uint8_t
+  {
+    unchanged = 0,    //!< Whatever priority the thread and handle would have anyway.
+    realtime = 1,     //!< Served ahead of all other i/o to the device. Requires privilege on Linux, without which it is best effort at level 0.
+    best_effort = 2,  //!< Ordinary i/o, ordered within the class by level.
+    idle = 3          //!< Served only when no other i/o to the device is outstanding.
+  };
+  /*! \brief The priority of an i/o request, a scheduling class and a level within that class
+  from 0 (highest) to 7 (lowest). Guaranteed to be `TrivialType` apart from construction, and `StandardLayoutType`.
+
+  Multiplexers submit high priority i/o ahead of any ordinary i/o waiting for room in their
+  submission queues, though never ahead of earlier overlapping i/o to the same inode, nor ahead
+  of earlier i/o of the same kind to the same non-seekable handle. The Linux io_uring multiplexer
+  also passes the class and level to the kernel's i/o scheduler, which reorders i/o already
+  submitted. Blocking i/o on Linux uses `preadv2()` and `pwritev2()` with `RWF_HIPRI` for high
+  priority i/o, which polls for the completion of uncached i/o if the device supports it.
+  */
+  struct io_priority
+  {
+    io_priority_class priority_class{io_priority_class::unchanged};
+    uint8_t level{4};
+    constexpr io_priority() {}  // NOLINT
+    constexpr io_priority(io_priority_class _priority_class, uint8_t _level = 4)
+        : priority_class(_priority_class)
+        , level(_level)
+    {
+    }
+    //! True if this priority differs from the default.
+    constexpr explicit operator bool() const noexcept { return priority_class != io_priority_class::unchanged; }
+    //! True if i/o of this priority should overtake ordinary i/o: realtime, or best effort above the default level.
+    constexpr bool is_high() const noexcept
+    {
+      return priority_class == io_priority_class::realtime || (priority_class == io_priority_class::best_effort && level < 4);
+    }
+  };
+
+  /*! \brief Bitwise flags modifying a single i/o request.
+
+  On Linux, blocking i/o passes these to `preadv2()` and `pwritev2()`, and the io_uring
+  multiplexer passes them to the kernel with the i/o. Where the kernel or platform cannot
+  honour them, they are emulated: `nowait` fails seekable i/o with `errc::resource_unavailable_try_again`
+  without doing any i/o, `data_sync` and `sync` follow the write with `fdatasync()` or `fsync()`,
+  and `append` fails with `errc::operation_not_supported`.
+  */
+  QUICKCPPLIB_BITFIELD_BEGIN(io_flag){
+  none = 0,  //!< No flags
+  /*! Fail with `errc::resource_unavailable_try_again` instead of blocking. For reads of
+  cached files this probes the page cache: cached data is returned, possibly as a short read,
+  and a read needing storage fails, whereupon the caller can reissue it asynchronously.
+  */
+  nowait = 1U << 0U,
+  data_sync = 1U << 1U,  //!< The write completes only once its data has reached storage, as if the handle were `caching::reads_and_metadata` (<tt>O_DSYNC</tt>).
+  sync = 1U << 2U,       //!< The write completes only once its data and metadata have reached storage, as if the handle were `caching::reads` (<tt>O_SYNC</tt>).
+  append = 1U << 3U      //!< The write appends to the end of the file, ignoring the offset.
+  } QUICKCPPLIB_BITFIELD_END(io_flag);
+
   //! The i/o request type used by this handle. Guaranteed to be `TrivialType` apart from construction, and `StandardLayoutType`.
   template <class T> struct io_request
   {
     T buffers{};
     extent_type offset{0};
+    io_priority priority{};          //!< The priority of this i/o, by default unchanged.
+    io_flag flags{io_flag::none};  //!< Flags modifying this i/o.
     constexpr io_request() {}  // NOLINT (defaulting this breaks clang and GCC, so don't do it!)
     constexpr io_request(T _buffers, extent_type _offset)
         : buffers(std::move(_buffers))
         , offset(_offset)
     {
     }
+    constexpr io_request(T _buffers, extent_type _offset, io_priority _priority, io_flag _flags = io_flag::none)
+        : buffers(std::move(_buffers))
+        , offset(_offset)
+        , priority(_priority)
+        , flags(_flags)
+    {
+    }
+    constexpr io_request(T _buffers, extent_type _offset, io_flag _flags)
+        : buffers(std::move(_buffers))
+        , offset(_offset)
+        , flags(_flags)
+    {
+    }
   };
 #ifndef NDEBUG
   // Is trivial in all ways, except default constructibility
@@ -400,6 +475,7 @@ public:
   // static_assert(std::is_trivially_move_assignable<io_request<buffers_type>>::value, "io_request<buffers_type> is not trivially move assignable!");
 #if !defined(_MSC_VER) || _MSC_VER < 1926
   static_assert(std::is_standard_layout<io_request<buffers_type>>::value, "io_request<buffers_type> is not a standard layout type!");
+  static_assert(std::is_standard_layout<io_priority>::value, "io_priority is not a standard layout type!");
 #endif
 #endif
   //! The i/o result type used by this handle. Guaranteed to be `TrivialType` apart from construction.
@@ -625,12 +701,41 @@ public:
 protected:
   /*! \brief An unsynchronised i/o operation state.
 
-  This implementation does NOT use atomics during access.
+  This implementation does NOT use atomic read-modify-write during access. The lifecycle
+  state is stored with release semantics and loaded with acquire semantics, which costs
+  nothing extra on x64, so that a subclass may publish the payload written before a
+  state change to other threads without a lock.
   */
   struct _unsynchronised_io_operation_state : public io_operation_state
   {
+    //! Storage for the lifecycle state, which publishes the payload when changed
+    struct state_type
+    {
+      std::atomic<io_operation_state_type> v;
+
+      constexpr state_type(io_operation_state_type _v) noexcept
+          : v(_v)
+      {
+      }
+      state_type(const state_type &o) noexcept
+          : v(o.v.load(std::memory_order_relaxed))
+      {
+      }
+      state_type &operator=(const state_type &) = delete;
+      state_type &operator=(io_operation_state_type _v) noexcept
+      {
+        v.store(_v, std::memory_order_release);
+        return *this;
+      }
+      operator io_operation_state_type() const noexcept { return v.load(std::memory_order_acquire); }
+      //! Changes the state to `desired` only if it is currently `expected`, returning true if it was changed
+      bool compare_exchange(io_operation_state_type expected, io_operation_state_type desired) noexcept
+      {
+        return v.compare_exchange_strong(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+      }
+    };
     //! The current lifecycle state of this i/o operation
-    io_operation_state_type state{io_operation_state_type::unknown};
+    state_type state{io_operation_state_type::unknown};
     //! Variant storage
     union payload_t
     {
@@ -782,6 +887,12 @@ protected:
 
     //! Used to clear the storage in this operation state
     void clear_storage()
+    {
+      _clear_payload();
+      state = io_operation_state_type::unknown;
+    }
+    //! Destroys the payload for the current state, without changing the current state
+    void _clear_payload()
     {
       switch(state)
       {
@@ -814,7 +925,6 @@ protected:
         payload.completed_write_or_barrier.~io_result<const_buffers_type>();
         break;
       }
-      state = io_operation_state_type::unknown;
     }
 
     virtual void *invoke(function_ptr<void *(io_operation_state_type)> c) const noexcept override { return c(state); }
@@ -885,7 +995,7 @@ protected:
     {
       if(state == io_operation_state_type::read_initialised || state == io_operation_state_type::read_initiated)
       {
-        clear_storage();
+        _clear_payload();
         new(&payload.completed_read) io_result<buffers_type>(std::move(res));
         auto old = state;
         state = io_operation_state_type::read_completed;
@@ -921,7 +1031,7 @@ protected:
     {
       if(state == io_operation_state_type::write_initialised || state == io_operation_state_type::write_initiated)
       {
-        clear_storage();
+        _clear_payload();
         new(&payload.completed_write_or_barrier) io_result<const_buffers_type>(std::move(res));
         auto old = state;
         state = io_operation_state_type::write_or_barrier_completed;
@@ -946,7 +1056,7 @@ protected:
     {
       if(state == io_operation_state_type::barrier_initialised || state == io_operation_state_type::barrier_initiated)
       {
-        clear_storage();
+        _clear_payload();
         new(&payload.completed_write_or_barrier) io_result<const_buffers_type>(std::move(res));
         auto old = state;
         state = io_operation_state_type::write_or_barrier_completed;
@@ -1011,9 +1121,13 @@ protected:
   };
   /*! \brief A synchronised i/o operation state.
 
-  This implementation uses an atomic to synchronise access during the `*_completed()`,
-  `*_finished()` and `current_state()` member functions, thus making it suitable for
-  use across threads.
+  This implementation publishes each change of lifecycle state with release semantics
+  after the payload has been written, so `current_state()`, and the `*_initiated()`,
+  `*_completed()` and `*_finished()` member functions, are lock free if there is no
+  visitor. The finishing transition is an atomic compare and exchange, so it cannot
+  race with the result being retrieved. If there is a visitor, the spinlock is held
+  whilst the state changes and the visitor is called, as is also the case for
+  `invoke()`.
   */
   struct _synchronised_io_operation_state : public _unsynchronised_io_operation_state
   {
@@ -1030,19 +1144,15 @@ protected:
     virtual void _unlock() noexcept override { _lock_.unlock(); }
 
   public:
-    virtual io_operation_state_type current_state() const noexcept override
-    {
-      lock_guard g(const_cast<_synchronised_io_operation_state *>(this));
-      return _unsynchronised_io_operation_state::current_state();
-    }
+    virtual io_operation_state_type current_state() const noexcept override { return this->state; }
     virtual io_result<buffers_type> get_completed_read() &&noexcept override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return std::move(*this)._unsynchronised_io_operation_state::get_completed_read();
     }
     virtual io_result<const_buffers_type> get_completed_write_or_barrier() &&noexcept override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return std::move(*this)._unsynchronised_io_operation_state::get_completed_write_or_barrier();
     }
 
@@ -1053,41 +1163,51 @@ protected:
     }
     virtual void read_initiated() override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return _unsynchronised_io_operation_state::_read_initiated(g);
     }
     virtual void read_completed(io_result<buffers_type> &&res) override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return _unsynchronised_io_operation_state::_read_completed(g, std::move(res));
     }
     virtual void read_finished() override
     {
+      if(this->visitor == nullptr)
+      {
+        this->state.compare_exchange(io_operation_state_type::read_completed, io_operation_state_type::read_finished);
+        return;
+      }
       lock_guard g(this);
       return _unsynchronised_io_operation_state::_read_finished(g);
     }
     virtual void write_initiated() override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return _unsynchronised_io_operation_state::_write_initiated(g);
     }
     virtual void write_completed(io_result<const_buffers_type> &&res) override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return _unsynchronised_io_operation_state::_write_completed(g, std::move(res));
     }
     virtual void barrier_initiated() override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return _unsynchronised_io_operation_state::_barrier_initiated(g);
     }
     virtual void barrier_completed(io_result<const_buffers_type> &&res) override
     {
-      lock_guard g(this);
+      lock_guard g(this, this->visitor != nullptr);
       return _unsynchronised_io_operation_state::_barrier_completed(g, std::move(res));
     }
     virtual void write_or_barrier_finished() override
     {
+      if(this->visitor == nullptr)
+      {
+        this->state.compare_exchange(io_operation_state_type::write_or_barrier_completed, io_operation_state_type::write_or_barrier_finished);
+        return;
+      }
       lock_guard g(this);
       return _unsynchronised_io_operation_state::_write_or_barrier_finished(g);
     }
@@ -1097,7 +1217,7 @@ protected:
 #ifdef _WIN32
   static constexpr size_t _awaitable_size = 2048;  // IOCP implementation is unavoidably large
 #else
-  static constexpr size_t _awaitable_size = 128;
+  static constexpr size_t _awaitable_size = 344;  // io_uring implementation needs more than the base state
 #endif
   static io_result<buffers_type> _result_type_from_io_operation_state(io_operation_state *state, buffers_type * /*unused*/) noexcept
   {
@@ -1107,8 +1227,14 @@ protected:
   {
     return std::move(*state).get_completed_write_or_barrier();
   }
+  // Used by multiplexer implementations to perform i/o using the handle's non-multiplexed implementation
+  static inline io_result<buffers_type> _do_io_handle_read(io_handle *h, registered_buffer_type &&base, io_request<buffers_type> reqs, deadline d) noexcept;  // defined in io_handle.hpp
+  static inline io_result<const_buffers_type> _do_io_handle_write(io_handle *h, registered_buffer_type &&base, io_request<const_buffers_type> reqs, deadline d) noexcept;  // defined in io_handle.hpp
+  static inline io_result<const_buffers_type> _do_io_handle_barrier(io_handle *h, io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept;  // defined in io_handle.hpp
 
 public:
+  template <class T> class awaitable_group;
+
   /*! \brief A convenience coroutine awaitable type returned by `.co_read()`, `.co_write()` and
   `.co_barrier()`. **Blocks execution** if no i/o multiplexer has been set on this handle!
 
@@ -1118,17 +1244,21 @@ public:
   If the i/o does not complete immediately, the coroutine is suspended. To cause resumption
   of execution, you will need to pump the associated i/o multiplexer for completions using
   `io_multiplexer::check_for_any_completed_io()`.
+
+  To await many awaitables with a single coroutine suspension, see `when_all()` and `when_any()`.
   */
   template <class T> struct awaitable final : protected io_operation_state_visitor
   {
     friend class io_handle;
-    static constexpr size_t _state_storage_bytes = _awaitable_size - sizeof(void *) - sizeof(io_operation_state *)
+    friend class awaitable_group<T>;
+    static constexpr size_t _state_storage_bytes = _awaitable_size - sizeof(void *) - sizeof(io_operation_state *) - sizeof(awaitable_group<T> *)
 #if LLFIO_ENABLE_COROUTINES
                                                    - sizeof(coroutine_handle<>)
 #endif
     ;
     byte _state_storage[_state_storage_bytes];
     io_operation_state *_state{nullptr};
+    awaitable_group<T> *_group{nullptr};  // set whilst awaited as part of a group
 #if LLFIO_ENABLE_COROUTINES
     coroutine_handle<> _coro;
 #endif
@@ -1257,11 +1387,17 @@ public:
     }
 
   protected:
+    inline void _finished(lock_guard &g) noexcept;  // defined in io_handle.hpp
+
     // virtual void read_initiated(lock_guard &g, io_operation_state_type /*former*/) override {}
     // virtual void read_completed(lock_guard &g, io_operation_state_type /*former*/, io_result<buffers_type> && /*res*/) override {}
     virtual void read_finished(lock_guard &g, io_operation_state_type /*former*/) override
     {
       (void) g;
+      if(_group != nullptr)
+      {
+        return _finished(g);
+      }
 #if LLFIO_ENABLE_COROUTINES
       if(_coro)
       {
@@ -1280,6 +1416,10 @@ public:
     virtual void write_or_barrier_finished(lock_guard &g, io_operation_state_type /*former*/) override
     {
       (void) g;
+      if(_group != nullptr)
+      {
+        return _finished(g);
+      }
 #if LLFIO_ENABLE_COROUTINES
       if(_coro)
       {
@@ -1293,6 +1433,101 @@ public:
   };
   static_assert(sizeof(awaitable<io_result<buffers_type>>) == _awaitable_size, "awaitable<io_result<buffers_type>> is not _awaitable_size bytes in length!");
 
+  /*! \brief A coroutine awaitable type returned by `when_all()` and `when_any()`, which
+  awaits a span of `awaitable<T>` with a single coroutine suspension.
+
+  Upon `.await_ready()`, all not yet initiated awaitables in the span are initiated, and
+  each i/o multiplexer involved is flushed once. If the awaited condition is not already
+  met, the coroutine is suspended, and each unfinished awaitable in the span is pointed at
+  this group. The coroutine is resumed by whichever i/o finish satisfies the condition,
+  which occurs during `io_multiplexer::check_for_any_completed_io()` as usual.
+
+  No memory is allocated, the span must outlive the `co_await`. After resumption, fetch
+  each result using `.await_resume()` on each finished awaitable in the span. Awaitables
+  not yet finished after a `when_any()` can be awaited again, or be destroyed which cancels
+  their i/o.
+  */
+  template <class T> class awaitable_group
+  {
+    friend struct awaitable<T>;
+    span<awaitable<T>> _awaitables;
+    bool _any{false};
+    bool _registered{false};  // awaitables may refer to this group
+    // One for the suspending coroutine, plus one per awaitable whose finish is needed
+    std::atomic<size_t> _count{1};
+    std::atomic<size_t> _first{(size_t) -1};
+#if LLFIO_ENABLE_COROUTINES
+    coroutine_handle<> _coro;
+#endif
+
+    // Called by an awaitable in the group which just finished with its state lock held
+    inline bool _element_finished(awaitable<T> *a) noexcept;  // defined in io_handle.hpp
+    inline void _detach() noexcept;                           // defined in io_handle.hpp
+
+  public:
+    //! Constructs an instance
+    constexpr awaitable_group(span<awaitable<T>> awaitables, bool any) noexcept
+        : _awaitables(awaitables)
+        , _any(any)
+    {
+    }
+    awaitable_group(const awaitable_group &) = delete;
+    awaitable_group(awaitable_group &&o) noexcept
+        : _awaitables(o._awaitables)
+        , _any(o._any)
+    {
+    }
+    awaitable_group &operator=(const awaitable_group &) = delete;
+    awaitable_group &operator=(awaitable_group &&) = delete;
+    ~awaitable_group() { _detach(); }
+
+    //! True if the awaited condition is met. Initiates all not yet initiated i/o in the group.
+    inline bool await_ready() noexcept;  // defined in io_handle.hpp
+
+    /*! \brief For `when_all()`, returns the span of awaitables, all of which are finished.
+    For `when_any()`, returns a span of the first awaitable which finished.
+    */
+    span<awaitable<T>> await_resume() noexcept
+    {
+      _detach();
+      if(_any)
+      {
+        const auto idx = _first.load(std::memory_order_acquire);
+        return (idx < _awaitables.size()) ? _awaitables.subspan(idx, 1) : span<awaitable<T>>();
+      }
+      return _awaitables;
+    }
+
+#if LLFIO_ENABLE_COROUTINES
+    //! Suspends the coroutine for resumption after the awaited condition is met
+    inline bool await_suspend(coroutine_handle<> coro) noexcept;  // defined in io_handle.hpp
+#endif
+  };
+
+protected:
+  // Checks that the batch storage is sufficient, returning the stride between states
+  result<size_t> _check_batch_storage(span<io_operation_state *> states, span<byte> storage, size_t count) noexcept
+  {
+    const auto reqs = batch_io_state_requirements(1);
+    if(states.size() < count || storage.size() < reqs.first * count || ((uintptr_t) storage.data() % reqs.second) != 0)
+    {
+      return errc::invalid_argument;
+    }
+    return reqs.first;
+  }
+  template <class BuffersType>
+  result<void> _construct_and_init_io_operations(span<io_operation_state *> states, span<byte> storage, io_handle *_h, io_operation_state_visitor *_visitor,
+                                                 deadline d, span<const io_request<BuffersType>> reqs) noexcept
+  {
+    OUTCOME_TRY(auto &&stride, _check_batch_storage(states, storage, reqs.size()));
+    for(size_t n = 0; n < reqs.size(); n++)
+    {
+      states[n] = construct({storage.data() + n * stride, stride}, _h, _visitor, {}, d, reqs[n]);
+      init_io_operation(states[n]);
+    }
+    return flush_inited_io_operations();
+  }
+
 public:
   //! Returns the number of bytes, and alignment required, for an `io_operation_state` for this multiplexer
   virtual std::pair<size_t, size_t> io_state_requirements() noexcept = 0;
@@ -1355,6 +1590,113 @@ public:
     return state;
   }
 
+  /*! \brief Returns the number of bytes, and alignment required, for the storage of a batch of
+  `count` `io_operation_state` for this multiplexer. Each state occupies a slot of
+  `io_state_requirements().first` rounded up to the alignment.
+  */
+  std::pair<size_t, size_t> batch_io_state_requirements(size_t count) noexcept
+  {
+    const auto reqs = io_state_requirements();
+    return {((reqs.first + reqs.second - 1) & ~(reqs.second - 1)) * count, reqs.second};
+  }
+
+  /*! \brief Constructs and initiates a read operation for each of `reqs` into consecutive slots
+  of `storage`, writing each state into the corresponding item of `states`, and then flushes
+  the whole batch. The storage must meet the requirements from `batch_io_state_requirements()`.
+
+  Multiplexers able to do so submit the whole batch to the system with a single syscall,
+  and take their internal lock once for the whole batch rather than once per i/o. If
+  flushing fails, the states are still initiated, and must be completed as usual.
+  */
+  virtual result<void> construct_and_init_io_operations(span<io_operation_state *> states, span<byte> storage, io_handle *_h,
+                                                        io_operation_state_visitor *_visitor, deadline d, span<const io_request<buffers_type>> reqs) noexcept
+  {
+    return _construct_and_init_io_operations(states, storage, _h, _visitor, d, reqs);
+  }
+
+  /*! \brief Constructs and initiates a write operation for each of `reqs` into consecutive slots
+  of `storage`, writing each state into the corresponding item of `states`, and then flushes
+  the whole batch. The storage must meet the requirements from `batch_io_state_requirements()`.
+
+  Multiplexers able to do so submit the whole batch to the system with a single syscall,
+  and take their internal lock once for the whole batch rather than once per i/o. If
+  flushing fails, the states are still initiated, and must be completed as usual.
+  */
+  virtual result<void> construct_and_init_io_operations(span<io_operation_state *> states, span<byte> storage, io_handle *_h,
+                                                        io_operation_state_visitor *_visitor, deadline d, span<const io_request<const_buffers_type>> reqs) noexcept
+  {
+    return _construct_and_init_io_operations(states, storage, _h, _visitor, d, reqs);
+  }
+
+  /*! \brief A pool of storage blocks for the i/o operation states of a multiplexer.
+
+  Blocks are sized and aligned according to `io_state_requirements()`, and recycled through a
+  free list per thread per block size. Acquiring and releasing a block is therefore O(1) and
+  takes no locks, and once a thread's free list has warmed up, does not call the memory
+  allocator. Blocks may be released by a different thread to the one which acquired them.
+  Up to `max_cached` blocks of each size are retained per thread, any beyond that are
+  returned to the memory allocator, as are all retained blocks upon thread exit.
+  */
+  class LLFIO_DECL state_pool
+  {
+    io_multiplexer *_ctx{nullptr};
+    size_t _bytes{0}, _align{0};
+
+  public:
+    //! The maximum number of blocks of each size retained per thread
+    static constexpr size_t max_cached = 256;
+
+    //! Constructs a pool for the i/o operation states of `ctx`
+    explicit state_pool(io_multiplexer *ctx) noexcept
+        : _ctx(ctx)
+    {
+      const auto reqs = ctx->batch_io_state_requirements(1);
+      _bytes = reqs.first;
+      _align = reqs.second;
+    }
+
+    //! The multiplexer whose states this pool stores
+    io_multiplexer *multiplexer() const noexcept { return _ctx; }
+
+    //! Returns a block of storage for an i/o operation state, or an empty span if out of memory.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC span<byte> acquire() noexcept;
+    //! Returns a block previously returned by `acquire()` to the free list of the calling thread.
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void release(byte *block) noexcept;
+
+    //! Constructs and initiates an i/o operation in a block from the pool, returning null if out of memory.
+    template <class... Args>
+    io_operation_state *construct_and_init_io_operation(io_handle *_h, io_operation_state_visitor *_visitor, registered_buffer_type &&b, deadline d, Args &&... args) noexcept
+    {
+      auto block = acquire();
+      if(block.empty())
+      {
+        return nullptr;
+      }
+      return _ctx->construct_and_init_io_operation(block, _h, _visitor, std::move(b), d, std::forward<Args>(args)...);
+    }
+    /*! \brief Relocates an i/o operation state which is not in progress into a block from the
+    pool using `io_operation_state::relocate_to()`, destroying the original. Returns null
+    if out of memory, in which case the original is left untouched.
+    */
+    io_operation_state *relocate(io_operation_state *state) noexcept
+    {
+      auto block = acquire();
+      if(block.empty())
+      {
+        return nullptr;
+      }
+      auto *ret = state->relocate_to(block.data());
+      state->~io_operation_state();
+      return ret;
+    }
+    //! Destroys a finished i/o operation state stored in a block from the pool, and releases the block.
+    void destroy(io_operation_state *state) noexcept
+    {
+      state->~io_operation_state();
+      release(reinterpret_cast<byte *>(state));
+    }
+  };
+
   //! Flushes any previously initiated i/o, if necessary for this i/o multiplexer
   virtual result<void> flush_inited_io_operations() noexcept { return success(); }
 
@@ -1364,6 +1706,236 @@ public:
   //! Cancel an initiated i/o, returning its current state if successful.
   virtual result<io_operation_state_type> cancel_io_operation(io_operation_state *op, deadline d = {}) noexcept = 0;
 
+  /*! \brief Allocates a group of `count` buffers of `bytes` each, from which reads select
+  a buffer only when data arrives.
+
+  To read into the group, pass the group as the registered buffer base of a read of a
+  single buffer whose data pointer is null, and whose size is the most to read (it is
+  clamped to `bytes`). Upon completion the buffer returned points into the group, and
+  must be returned to the group using `release_selected_buffer()` when you are done with it.
+  A read of zero bytes (i.e. end of file) returns an empty buffer which needs no release.
+  If every buffer in the group is in use, the read fails with `errc::no_buffer_space`.
+
+  Thus, many handles which are mostly idle can each have a read outstanding, at a cost
+  in memory of only the buffers of those which are active. The group must outlive any
+  buffers selected from it.
+
+  Fails with `errc::operation_not_supported` if this multiplexer cannot select buffers for
+  reads, which is the default.
+  */
+  virtual result<registered_buffer_type> allocate_buffer_group(size_t count, size_t bytes) noexcept
+  {
+    (void) count;
+    (void) bytes;
+    return errc::operation_not_supported;
+  }
+  //! Returns a buffer selected by a read from a buffer group to that group, so it can be selected again.
+  virtual result<void> release_selected_buffer(const registered_buffer_type & /*unused*/, buffer_type /*unused*/) noexcept { return errc::invalid_argument; }
+
+  //! The kind of a filesystem syscall performed by `init_syscall_operation()`
+  enum class syscall_operation_kind : uint8_t
+  {
+    openat,   //!< `openat(fd, path, flags, mode)`
+    close,    //!< `close(fd)`
+    statx,    //!< `statx(fd, path, flags, mode, buffer)`
+    getdents  //!< `getdents64(fd, buffer, mode)` from the start of the directory
+  };
+  /*! \brief The state of a filesystem syscall initiated by `init_syscall_operation()`.
+
+  Unlike i/o, these syscalls have no handle yet, or are its last act. The state cannot be
+  relocated in memory between initiation and its `completed` callback being invoked.
+  */
+  struct alignas(8) syscall_operation_state
+  {
+    syscall_operation_kind kind{syscall_operation_kind::openat};  //!< The syscall to perform
+    int fd{-1};                                                     //!< The file descriptor, or base directory for `openat` and `statx`
+    int flags{0};                                                   //!< The flags for `openat` and `statx`
+    unsigned mode{0};                                               //!< The creation mode for `openat`, the mask for `statx`
+    const char *path{nullptr};                                      //!< The zero terminated path for `openat` and `statx`
+    void *buffer{nullptr};                                          //!< The output buffer for `statx` and `getdents`
+    std::atomic<unsigned> *lock{nullptr};                           //!< If set, a spinlock held across a `getdents`
+    int result{0};                                                  //!< The return value of the syscall, or minus `errno` if it failed
+    //! Called with the result filled in, from within `check_for_any_completed_io()`
+    void (*completed)(syscall_operation_state *) noexcept {nullptr};
+    syscall_operation_state *_next{nullptr};  // used by the multiplexer
+  };
+
+  /*! \brief Initiates a filesystem syscall, invoking `op->completed` from within some later
+  `check_for_any_completed_io()` upon completion. Note that you should always call
+  `.flush_inited_io_operations()` after you finished initiating operations.
+
+  Fails with `errc::operation_not_supported` if this multiplexer cannot perform the syscall
+  asynchronously, in which case you should perform it synchronously instead.
+  */
+  virtual result<void> init_syscall_operation(syscall_operation_state * /*unused*/) noexcept { return errc::operation_not_supported; }
+
+  /*! \brief A convenience coroutine awaitable type returned by `.co_file()`, `.co_close()`,
+  `.co_stat()` and friends, which performs a filesystem syscall via an i/o multiplexer.
+
+  Upon first `.await_ready()`, the awaitable initiates the syscall. If no multiplexer was
+  supplied, or it cannot perform the syscall asynchronously, the syscall is performed
+  synchronously and the awaitable is immediately ready. Otherwise the coroutine is suspended,
+  and resumed from within `io_multiplexer::check_for_any_completed_io()`.
+
+  Calling `.await_ready()` upon many awaitables before awaiting any of them places all
+  of their syscalls in flight at once. If you are not using coroutines, `.await_resume()`
+  pumps the multiplexer for completions until the syscall completes.
+
+  `Op` supplies `result_type`, `bool prepare(syscall_operation_state &)` which returns false
+  if the syscall must be performed synchronously, `result_type finish(const syscall_operation_state &)`,
+  `void discard(const syscall_operation_state &)` which disposes of a result never fetched
+  e.g. closes a file descriptor opened, and `result_type synchronous()`.
+  */
+  template <class Op> class syscall_awaitable : protected syscall_operation_state
+  {
+  public:
+    //! The result type of this awaitable
+    using result_type = typename Op::result_type;
+
+  private:
+    enum _status_t : int
+    {
+      _not_initiated,
+      _initiated,
+      _suspended,
+      _finished,
+      _consumed
+    };
+    io_multiplexer *_ctx{nullptr};
+    Op _op;
+    optional<result_type> _sync;
+    std::atomic<int> _status{_not_initiated};
+#if LLFIO_ENABLE_COROUTINES
+    coroutine_handle<> _coro;
+#endif
+
+    static void _completed(syscall_operation_state *s) noexcept
+    {
+      auto *self = static_cast<syscall_awaitable *>(s);
+      // Once finished, the awaitable may be destroyed by another thread, so touch nothing after
+      if(self->_status.exchange(_finished, std::memory_order_acq_rel) == _suspended)
+      {
+#if LLFIO_ENABLE_COROUTINES
+        // Only a suspended coroutine's awaitable is still alive, and it wrote _coro before suspending
+        self->_coro.resume();
+#endif
+      }
+    }
+
+  public:
+    //! Constructs an instance which performs `op` via `ctx`, or synchronously if `ctx` is null.
+    syscall_awaitable(io_multiplexer *ctx, Op &&op) noexcept
+        : _ctx(ctx)
+        , _op(std::move(op))
+    {
+    }
+    syscall_awaitable(const syscall_awaitable &) = delete;
+    //! Move construction, terminates the process if the syscall is in progress
+    syscall_awaitable(syscall_awaitable &&o) noexcept
+        : syscall_operation_state(o)
+        , _ctx(o._ctx)
+        , _op(std::move(o._op))
+        , _sync(std::move(o._sync))
+        , _status(o._status.load(std::memory_order_acquire))
+    {
+      const int status = _status.load(std::memory_order_relaxed);
+      if(status == _initiated || status == _suspended)
+      {
+        abort();  // attempt to relocate an awaitable currently in use
+      }
+      o._sync.reset();
+      o._status.store(_consumed, std::memory_order_relaxed);
+    }
+    syscall_awaitable &operator=(const syscall_awaitable &) = delete;
+    syscall_awaitable &operator=(syscall_awaitable &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~syscall_awaitable();
+      new(this) syscall_awaitable(std::move(o));
+      return *this;
+    }
+    //! Destructor, blocks if the syscall is in progress. A result never fetched is disposed of e.g. a file opened is closed.
+    ~syscall_awaitable()
+    {
+      int status = _status.load(std::memory_order_acquire);
+      // Resumption of the coroutine at this point causes recursion into this destructor, so prevent that.
+      // If this fails, the syscall has just finished.
+      if(status == _suspended)
+      {
+        (void) _status.compare_exchange_strong(status, _initiated, std::memory_order_acq_rel);
+      }
+      while(status == _initiated || status == _suspended)
+      {
+        // Block forever until I finish
+        (void) _ctx->check_for_any_completed_io({});
+        status = _status.load(std::memory_order_acquire);
+      }
+      if(status == _finished && !_sync)
+      {
+        _op.discard(*this);
+      }
+    }
+
+    //! True if the syscall is finished. Begins the syscall if it is not initiated yet.
+    bool await_ready() noexcept
+    {
+      const int status = _status.load(std::memory_order_acquire);
+      if(status != _not_initiated)
+      {
+        return status >= _finished;
+      }
+      if(_ctx != nullptr && _op.prepare(*this))
+      {
+        this->completed = &syscall_awaitable::_completed;
+        // The syscall may complete on another thread before initiation returns
+        _status.store(_initiated, std::memory_order_release);
+        if(_ctx->init_syscall_operation(this))
+        {
+          return _status.load(std::memory_order_acquire) == _finished;
+        }
+      }
+      // Either no multiplexer, or it cannot do this syscall
+      _sync.emplace(_op.synchronous());
+      _status.store(_finished, std::memory_order_release);
+      return true;
+    }
+
+    //! Returns the result of the syscall, which can be fetched once. If not finished yet, pumps the multiplexer until it is.
+    result_type await_resume() noexcept
+    {
+      if(!await_ready())
+      {
+        (void) _ctx->flush_inited_io_operations();
+        while(_status.load(std::memory_order_acquire) != _finished)
+        {
+          (void) _ctx->check_for_any_completed_io({});
+        }
+      }
+      _status.store(_consumed, std::memory_order_relaxed);
+      if(_sync)
+      {
+        result_type ret(std::move(*_sync));
+        _sync.reset();
+        return ret;
+      }
+      return _op.finish(*this);
+    }
+
+#if LLFIO_ENABLE_COROUTINES
+    //! Suspends the coroutine for resumption after the syscall finishes
+    bool await_suspend(coroutine_handle<> coro) noexcept
+    {
+      _coro = coro;
+      int expected = _initiated;
+      // If the syscall has finished in the meantime, don't suspend
+      return _status.compare_exchange_strong(expected, _suspended, std::memory_order_acq_rel);
+    }
+#endif
+  };
+
   //! Statistics about the just returned `wait_for_completed_io()` operation
   struct check_for_any_completed_io_statistics
   {
@@ -1384,6 +1956,26 @@ public:
   woken is not specified.
   */
   virtual result<void> wake_check_for_any_completed_io() noexcept = 0;
+
+  /*! \brief Returns a handle which becomes readable when `check_for_any_completed_io()`
+  would have work to do, for integrating this multiplexer into a foreign event loop.
+
+  The foreign event loop waits upon the handle level triggered, e.g. with `poll()` or
+  `epoll_wait()`, and when it becomes readable calls `check_for_any_completed_io()` with
+  a zero deadline. That call resets the readiness of the handle, unless it left work
+  undone e.g. due to `max_completions`, in which case the handle remains readable. The
+  handle may become readable spuriously. As the foreign event loop never sleeps within
+  `check_for_any_completed_io()`, it has no need of `wake_check_for_any_completed_io()`.
+
+  The handle is owned by the multiplexer, and must not be closed nor read from. Calling
+  this function more than once returns the same handle. Once it has been called,
+  `check_for_any_completed_io()` may perform an additional syscall or two per call
+  to maintain the readiness of the handle.
+
+  Fails with `errc::operation_not_supported` if this multiplexer cannot provide such a
+  handle, which is the default.
+  */
+  virtual result<native_handle_type> completion_notification_handle() noexcept { return errc::operation_not_supported; }
 };
 //! A unique ptr to an i/o multiplexer implementation.
 using io_multiplexer_ptr = std::unique_ptr<io_multiplexer>;
@@ -1404,10 +1996,6 @@ namespace test
   */
   LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_null(size_t threads, bool disable_immediate_completions) noexcept;
 
-#if defined(__linux__) || DOXYGEN_IS_IN_THE_HOUSE
-// LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_epoll(size_t threads) noexcept;
-// LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_io_uring() noexcept;
-#endif
 #if(defined(__FreeBSD__) || defined(__APPLE__)) || DOXYGEN_IS_IN_THE_HOUSE
 // LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_bsd_kqueue(size_t threads) noexcept;
 #endif
@@ -1422,6 +2010,243 @@ namespace test
 }  // namespace test
 #endif
 
+#if defined(__linux__) || DOXYGEN_IS_IN_THE_HOUSE
+/*! \brief The configuration of an i/o multiplexer implemented using Linux io_uring.
+
+The defaults are those of `multiplexer_linux_io_uring(threads, false)`.
+*/
+struct multiplexer_linux_io_uring_config
+{
+  //! The number of kernel threads which will use the multiplexer. If one, no locking is performed.
+  size_t threads{1};
+  /*! If true, a kernel thread polls each submission queue (`IORING_SETUP_SQPOLL`), thus removing
+  syscalls from i/o initiation. This usually requires elevated privileges on kernels before 5.11.
+  */
+  bool submission_polling{false};
+  /*! The CPU to pin the submission polling kernel threads to (`IORING_SETUP_SQ_AFF`). If negative,
+  they are pinned to the CPU of the calling thread if it is pinned to a single CPU, else not pinned.
+  */
+  int submission_polling_cpu{-1};
+  //! The milliseconds without submissions after which the submission polling kernel threads sleep.
+  unsigned submission_polling_idle_ms{100};
+  /*! If true, a third io_uring created with `IORING_SETUP_IOPOLL` busy polls for the completion
+  of reads and writes without a deadline upon seekable handles opened with `caching::none` or
+  `caching::only_metadata` (i.e. `O_DIRECT`). Whilst such i/o is in flight,
+  `check_for_any_completed_io()` spins rather than sleeps. Handles whose filesystem or device
+  cannot be polled have their i/o resubmitted to the ordinary seekable io_uring.
+  */
+  bool completion_polling{false};
+  //! The number of submission queue entries of each io_uring, which the kernel rounds up to a power of two.
+  uint32_t submission_entries{256};
+  /*! The number of completion queue entries of each io_uring (`IORING_SETUP_CQSIZE`), zero means
+  twice `submission_entries`. More allows more i/o in flight than can be submitted at once.
+  */
+  uint32_t completion_entries{0};
+  /*! If true, the io_urings of this multiplexer share one pool of kernel worker threads
+  (`IORING_SETUP_ATTACH_WQ`), and from Linux 5.11, one submission polling kernel thread.
+  */
+  bool share_worker_pool{false};
+  /*! If not null, the io_urings of this multiplexer share the pool of kernel worker threads of
+  this other multiplexer, which must be one implemented using io_uring. Implies `share_worker_pool`.
+  */
+  const io_multiplexer *share_worker_pool_with{nullptr};
+};
+
+/*! \brief Return an i/o multiplexer implemented using Linux io_uring.
+
+Two io_uring instances are created, one for seekable handles and the other for
+non-seekable handles. Writes and barriers to seekable handles are ordered with respect
+to all preceding overlapping i/o upon the same inode, thus implementing POSIX read/write
+concurrency guarantees. I/o to non-seekable handles is queued per handle, with only
+one read and one write in flight per handle at a time.
+
+Barriers of kind `barrier_kind::wait_data_only` and weaker are submitted as
+`IORING_OP_SYNC_FILE_RANGE` upon the range of the request if the kernel supports it,
+exactly as the synchronous implementation calls `sync_file_range()`. Otherwise, and for
+the stronger kinds, barriers are submitted as a `IORING_OP_FSYNC` restricted to the range
+of the request.
+
+I/o with a deadline is submitted with a linked timeout, which for non-seekable handles
+bounds the wait for readiness. I/o waiting its turn within the multiplexer has its deadline
+enforced by a timer wheel. Either way, i/o which exceeds its deadline fails with
+`errc::timed_out`.
+
+The filesystem syscalls of `file_handle::co_file()`, `directory_handle::co_directory()`,
+`file_handle::co_close()` and `fs_handle::co_stat()` are submitted as `IORING_OP_OPENAT`,
+`IORING_OP_CLOSE` and `IORING_OP_STATX` if the kernel supports them. Otherwise, and for
+the `getdents64()` of `directory_handle::co_read()` for which io_uring has no opcode, they
+are performed upon a pool of up to four threads launched upon first use, which signal
+completion via an eventfd polled alongside the io_urings.
+
+Handles which perform their i/o in user space (e.g. `mapped_file_handle`) can be
+registered, but their i/o is performed synchronously upon initiation.
+
+`io_handle::allocate_registered_buffer()` hands out pages from a slab of memory
+registered with the kernel upon first use, which is large page backed if possible.
+Single buffer i/o upon such a registered buffer does not pin pages per i/o. If the slab
+could not be registered, or is exhausted, the default allocation is used instead.
+
+`io_multiplexer::allocate_buffer_group()` is supported if the kernel supports
+`IORING_OP_PROVIDE_BUFFERS` (Linux 5.7 onwards). The group's buffers are provided to the
+non-seekable io_uring, and reads from non-seekable handles into the group are submitted
+with `IOSQE_BUFFER_SELECT`, so the kernel picks a buffer only once there is data to read.
+Seekable handles cannot read into a buffer group. Buffers released back to the group are
+provided to the kernel again in runs of consecutive buffers upon the next flush or check.
+
+`io_multiplexer::completion_notification_handle()` returns an eventfd registered with both
+io_urings using `IORING_REGISTER_EVENTFD`, which the syscall worker threads also signal.
+
+\param threads The number of kernel threads which will use the multiplexer. If one,
+no locking is performed.
+\param is_polling If true, the kernel polls the submission queues using a kernel thread,
+thus removing syscalls from i/o initiation. This usually requires elevated privileges
+on kernels before 5.11.
+\errors Any of the values `io_uring_setup()` and `mmap()` can return, including
+`errc::function_not_supported` if this kernel does not support io_uring.
+*/
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_io_uring(size_t threads, bool is_polling) noexcept;
+/*! \brief Return an i/o multiplexer implemented using Linux io_uring, as configured by `config`.
+
+\errors As per `multiplexer_linux_io_uring(size_t, bool)`.
+*/
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_io_uring(const multiplexer_linux_io_uring_config &config) noexcept;
+
+/*! \brief Return an i/o multiplexer implemented using Linux edge triggered epoll.
+
+This multiplexer is intended for large numbers of non-seekable handles e.g. `pipe_handle`,
+and works on any Linux kernel. Non-seekable, nonblocking handles are registered once
+with the epoll set. I/o is attempted upon initiation, and if the kernel is not ready,
+it is queued per handle and performed in order when epoll reports readiness. Queued
+i/o which exceeds its deadline is removed from its queue by a timer wheel, and fails
+with `errc::timed_out`.
+
+Seekable handles, blocking handles, and handles which perform their i/o in user space
+can be registered, but their i/o is performed synchronously upon initiation, as epoll
+cannot multiplex them.
+
+The filesystem syscalls of `file_handle::co_file()`, `directory_handle::co_directory()`,
+`directory_handle::co_read()`, `file_handle::co_close()` and `fs_handle::co_stat()` are
+performed upon a pool of up to four threads launched upon first use, which signal
+completion via an eventfd within the epoll set.
+
+`io_multiplexer::completion_notification_handle()` returns the epoll set itself, which
+is readable whenever it has readiness to report. When first called, a timerfd armed to
+the earliest deadline of queued i/o is added to the epoll set, so deadlines are enforced
+without the foreign event loop needing to know about them.
+
+\param threads The number of kernel threads which will use the multiplexer. If one,
+no locking is performed.
+\errors Any of the values `epoll_create1()`, `eventfd()` and `epoll_ctl()` can return.
+*/
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_epoll(size_t threads) noexcept;
+#endif
+
+/*! \class io_multiplexer_group
+\brief A group of i/o multiplexers, usually one per CPU, whose completions are
+processed with work stealing.
+
+A single i/o multiplexer pumped by many threads serialises those threads upon its
+lock. A group instead owns one multiplexer per CPU. Handles are assigned to the
+multiplexer of the CPU of the thread which calls `.set_multiplexer()`, so the i/o
+they initiate from that CPU goes to that CPU's multiplexer, and its lock is mostly
+uncontended.
+
+`.check_for_any_completed_io()` first processes the calling CPU's multiplexer. If
+it has nothing to report, it steals by processing each of the other multiplexers
+in turn without sleeping, so an idle thread drains a busy CPU's completions. Only
+if nothing anywhere completed does it sleep upon its own multiplexer, for no more
+than `steal_interval()` at a time, before trying to steal again.
+
+As other threads may process any multiplexer, each multiplexer in the group must
+have been created for more than one thread.
+*/
+class LLFIO_DECL io_multiplexer_group
+{
+  std::vector<io_multiplexer_ptr> _multiplexers;
+  std::atomic<size_t> _steal_cursor{0};
+  std::chrono::microseconds _steal_interval{std::chrono::milliseconds(1)};
+
+public:
+  //! Statistics about the just returned `check_for_any_completed_io()` operation
+  using check_for_any_completed_io_statistics = io_multiplexer::check_for_any_completed_io_statistics;
+
+  //! Constructs an instance taking ownership of the multiplexers, which must each have been created for more than one thread.
+  explicit io_multiplexer_group(std::vector<io_multiplexer_ptr> &&multiplexers) noexcept
+      : _multiplexers(std::move(multiplexers))
+  {
+  }
+  io_multiplexer_group(const io_multiplexer_group &) = delete;
+  io_multiplexer_group(io_multiplexer_group &&) = delete;
+  io_multiplexer_group &operator=(const io_multiplexer_group &) = delete;
+  io_multiplexer_group &operator=(io_multiplexer_group &&) = delete;
+  ~io_multiplexer_group() = default;
+
+  //! The number of multiplexers in the group
+  size_t size() const noexcept { return _multiplexers.size(); }
+  //! The multiplexer at index `idx`
+  io_multiplexer *operator[](size_t idx) const noexcept { return _multiplexers[idx].get(); }
+
+  //! The index of the multiplexer for the CPU upon which the calling thread is currently running
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t current_index() const noexcept;
+  //! The multiplexer for the CPU upon which the calling thread is currently running
+  io_multiplexer *current() const noexcept { return _multiplexers[current_index()].get(); }
+
+  //! The maximum time which `check_for_any_completed_io()` sleeps upon its own multiplexer before trying to steal again
+  std::chrono::microseconds steal_interval() const noexcept { return _steal_interval; }
+  //! Sets the maximum time which `check_for_any_completed_io()` sleeps upon its own multiplexer before trying to steal again
+  void set_steal_interval(std::chrono::microseconds v) noexcept { _steal_interval = v; }
+
+  /*! \brief Sets the multiplexer of the handle to that of the CPU upon which the calling
+  thread is currently running. If the handle is already set to that multiplexer, this
+  does nothing. The handle must not have i/o in progress if it is moved between multiplexers.
+  */
+  inline result<void> set_multiplexer(io_handle &h) noexcept;  // defined in io_handle.hpp
+
+  //! Flushes any previously initiated i/o in all of the multiplexers
+  result<void> flush_inited_io_operations() noexcept
+  {
+    for(auto &m : _multiplexers)
+    {
+      OUTCOME_TRY(m->flush_inited_io_operations());
+    }
+    return success();
+  }
+
+  /*! \brief Processes completions for the calling CPU's multiplexer, stealing completions
+  from the other multiplexers in the group if it has none, and not exceeding `d` of waiting
+  (this function never fails with timed out).
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<check_for_any_completed_io_statistics> check_for_any_completed_io(deadline d = std::chrono::seconds(0),
+                                                                                                          size_t max_completions = (size_t) -1) noexcept;
+};
+//! A unique ptr to an i/o multiplexer group
+using io_multiplexer_group_ptr = std::unique_ptr<io_multiplexer_group>;
+
+#if defined(__linux__) || DOXYGEN_IS_IN_THE_HOUSE
+/*! \brief Return a group of i/o multiplexers implemented using Linux io_uring, one per CPU.
+
+\param cpus The number of multiplexers to create, zero means one per hardware thread.
+\param is_polling As per `multiplexer_linux_io_uring()`.
+\errors As per `multiplexer_linux_io_uring()`.
+*/
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_group_ptr> multiplexer_group_linux_io_uring(size_t cpus = 0, bool is_polling = false) noexcept;
+/*! \brief Return a group of i/o multiplexers implemented using Linux io_uring, one per CPU,
+each configured by `config` except that its `threads` is always more than one.
+
+\param cpus The number of multiplexers to create, zero means one per hardware thread.
+\param config As per `multiplexer_linux_io_uring(const multiplexer_linux_io_uring_config &)`.
+\errors As per `multiplexer_linux_io_uring()`.
+*/
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_group_ptr> multiplexer_group_linux_io_uring(size_t cpus, const multiplexer_linux_io_uring_config &config) noexcept;
+
+/*! \brief Return a group of i/o multiplexers implemented using Linux edge triggered epoll, one per CPU.
+
+\param cpus The number of multiplexers to create, zero means one per hardware thread.
+\errors As per `multiplexer_linux_epoll()`.
+*/
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_group_ptr> multiplexer_group_linux_epoll(size_t cpus = 0) noexcept;
+#endif
+
 //! \brief Thread local settings
 namespace this_thread
 {
@@ -85,6 +85,7 @@ import LLFIO_MODULE_NAME;
 #ifndef LLFIO_EXCLUDE_MAPPED_FILE_HANDLE
 #include "mapped.hpp"
 #include "algorithm/handle_adapter/xor.hpp"
+#include "algorithm/mapped_ring_buffer.hpp"
 #include "algorithm/shared_fs_mutex/memory_map.hpp"
 #include "algorithm/trivial_vector.hpp"
 #endif
@@ -79,6 +79,17 @@ public:
                                    readwrite = (read | write)};
   QUICKCPPLIB_BITFIELD_END(flag);
 
+  //! The seals which can be placed upon a section created by `anonymous_section()`
+  QUICKCPPLIB_BITFIELD_BEGIN(seal_flag){none = 0U,                //!< No seals
+                                        no_more_seals = 1U << 0U,  //!< No further seals can be added
+                                        shrink = 1U << 1U,         //!< The section can no longer be shrunk
+                                        grow = 1U << 2U,           //!< The section can no longer be grown
+                                        write = 1U << 3U,          //!< The contents can no longer be modified
+                                        future_write = 1U << 4U,   //!< No new writable maps can be created, existing writable maps continue to work
+
+                                        immutable = (no_more_seals | shrink | grow | write)};
+  QUICKCPPLIB_BITFIELD_END(seal_flag);
+
 protected:
   file_handle *_backing{nullptr};
   file_handle _anonymous;
@@ -164,6 +175,35 @@ public:
   */
   LLFIO_MAKE_FREE_FUNCTION
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<section_handle> section(extent_type bytes, const path_handle &dirh = path_discovery::storage_backed_temporary_files_directory(), flag _flag = flag::read | flag::write) noexcept;
+  /*! \brief Create a memory section backed by anonymous memory which never touches a filing system.
+  \param bytes The initial size of this section. Cannot be zero. Rounded up to the page size
+  chosen by `flag::page_sizes_1` etc.
+  \param _flag How to create the section.
+
+  On Linux and FreeBSD this uses `memfd_create()`, which permits the section to be sealed using
+  `add_seals()` and, with `flag::page_sizes_1` etc, to use huge pages. On Windows this creates
+  a section backed by the paging file. Elsewhere this is `section()` with an anonymous file
+  in `path_discovery::memory_backed_temporary_files_directory()`.
+
+  To share the section with another process, send it `native_handle()` (e.g. via `SCM_RIGHTS`
+  on POSIX, `DuplicateHandle()` on Windows, or inheritance), and have it adopt that handle using
+  `from_native_handle()`. A producer can publish an immutable buffer by writing it, closing its
+  writable maps, and placing `seal_flag::immutable` upon it. Consumers can check `seals()`
+  before mapping it read only, and rely on its contents never changing thereafter.
+
+  \errors Any of the values POSIX `memfd_create()`, `ftruncate()` or `NtCreateSection()` can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<section_handle> anonymous_section(extent_type bytes, flag _flag = flag::read | flag::write) noexcept;
+  /*! \brief Adopt the native handle of a memory section, typically received from another process.
+  \param nativeh The native handle of a section, which is taken ownership of. On POSIX this can be the
+  file descriptor of any mappable file, on Windows it must be a section handle.
+  \param _flag How the section will be used, which must be permitted by the native handle.
+
+  \errors Any of the values POSIX `fstat()` can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<section_handle> from_native_handle(native_handle_type nativeh, flag _flag = flag::read | flag::write) noexcept;
 
   //! Returns the memory section's flags
   flag section_flags() const noexcept { return _flag; }
@@ -187,6 +227,19 @@ public:
   */
   LLFIO_MAKE_FREE_FUNCTION
   LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<extent_type> truncate(extent_type newsize = 0) noexcept;
+
+  /*! Place seals upon the section, which cannot be removed. Only sections created by `anonymous_section()`
+  on platforms with `memfd_create()` can be sealed.
+
+  \errors `errc::operation_not_supported` if the section cannot be sealed, `errc::operation_not_permitted`
+  if `seal_flag::no_more_seals` has been placed, `errc::device_or_resource_busy` if placing `seal_flag::write`
+  whilst writable maps of the section exist. Any of the values POSIX `fcntl()` can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> add_seals(seal_flag seals) noexcept;
+  //! Returns the seals currently placed upon the section, which is always none if the section cannot be sealed.
+  LLFIO_MAKE_FREE_FUNCTION
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<seal_flag> seals() const noexcept;
 };
 inline std::ostream &operator<<(std::ostream &s, const section_handle::flag &v)
 {
@@ -446,6 +499,7 @@ protected:
   extent_type _offset{0};
   size_type _reservation{0}, _length{0}, _pagesize{0};
   section_handle::flag _flag{section_handle::flag::none};
+  bool _recyclable{false};  // anonymous memory which can go into the recycled mapping cache on close
 
   explicit map_handle(section_handle *section, section_handle::flag flags)
       : _section(section)
@@ -485,6 +539,7 @@ public:
       , _length(o._length)
       , _pagesize(o._pagesize)
       , _flag(o._flag)
+      , _recyclable(o._recyclable)
   {
     o._section = nullptr;
     o._addr = nullptr;
@@ -493,6 +548,7 @@ public:
     o._length = 0;
     o._pagesize = 0;
     o._flag = section_handle::flag::none;
+    o._recyclable = false;
   }
   //! No copy construction (use `clone()`)
   map_handle(const map_handle &) = delete;
@@ -552,6 +608,51 @@ public:
   LLFIO_MAKE_FREE_FUNCTION
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<map_handle> map(size_type bytes, bool zeroed = false, section_handle::flag _flag = section_handle::flag::readwrite) noexcept;
 
+  //! Statistics about the process-wide cache of recycled anonymous mappings.
+  struct cache_statistics
+  {
+    size_t items_in_cache{0};
+    size_t bytes_in_cache{0};
+    size_t items_just_trimmed{0};
+    size_t bytes_just_trimmed{0};
+    size_t hits{0}, misses{0};
+  };
+  /*! Trim the process-wide cache of recycled anonymous mappings, returning statistics about
+  the cache after trimming.
+
+  On POSIX, closing a `map_handle` created by `map(size_type, bool, section_handle::flag)` with
+  `section_handle::flag::readwrite` and the default page size does not `munmap()` the memory,
+  rather the pages are released to the kernel using `MADV_FREE` and the address space is retained
+  for reuse by a later `map()` of a similar size. This avoids the `mmap()`/`munmap()` pair and the
+  TLB shootdowns that accompany it for workloads which churn large allocations. Pages released this
+  way remain in the process' commit charge until the kernel needs them, and are reported as
+  `utils::process_memory_usage::private_recycled`.
+
+  The cache holds no more than 32Mb by default, see `set_cache_limit()`. Mappings larger than
+  the limit are always unmapped on close, and the least recently released mappings are unmapped
+  to make room for newer ones. A later `map()` reuses a cached mapping at least as big as, but
+  no more than twice, the size requested.
+
+  \param older_than Unmap all cached mappings released before this time point. The default
+  unmaps everything in the cache, `std::chrono::steady_clock::time_point()` unmaps nothing and
+  merely returns statistics.
+
+  \note On Windows there is currently no cache, and this always returns empty statistics.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC cache_statistics trim_cache(std::chrono::steady_clock::time_point older_than = std::chrono::steady_clock::time_point::max()) noexcept;
+  /*! Disable, or enable, the process-wide cache of recycled anonymous mappings, returning the
+  previous setting. Disabling the cache does not empty it, call `trim_cache()` for that. The cache
+  is enabled by default on platforms which support it.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool set_cache_disabled(bool disabled) noexcept;
+  /*! Set the maximum bytes the process-wide cache of recycled anonymous mappings may hold,
+  returning the previous limit. Lowering the limit unmaps the least recently released mappings
+  until the cache fits. Zero means nothing is ever cached.
+
+  \note On Windows there is currently no cache, and this does nothing and returns zero.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t set_cache_limit(size_t bytes) noexcept;
+
   /*! Reserve address space within which individual pages can later be committed. Reserved address
   space is NOT added to the process' commit charge.
 
@@ -587,6 +688,30 @@ public:
   LLFIO_MAKE_FREE_FUNCTION
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<map_handle> map(section_handle &section, size_type bytes = 0, extent_type offset = 0, section_handle::flag _flag = section_handle::flag::readwrite) noexcept;
 
+  /*! Create a memory mapped view of a backing storage at exactly the address `addr`.
+
+  \param addr The address at which to place the view. Must be a multiple of the page size, on
+  Windows it needs to be a multiple of the kernel memory allocation granularity (typically 64Kb).
+  \param section A memory section handle specifying the backing storage to use.
+  \param bytes How many bytes to map.
+  \param offset The offset into the backing storage to map from.
+  \param _flag The permissions with which to map the view.
+
+  This is the primitive with which to place views of sections next to one another, for example
+  to map the same storage twice back to back (see `algorithm::mapped_ring_buffer`). The usual
+  pattern is to `reserve()` enough address space, and then to map views into the reservation.
+
+  \warning On POSIX, any existing mappings in the range are replaced, so the range must
+  be address space you own, typically a reservation whose ownership you then relinquish using
+  `release()` once it is entirely covered by views. On Windows, the range must be free, so you
+  must close any reservation first, and be prepared for another thread to have taken the
+  address space in the meantime.
+
+  \errors Any of the values POSIX `mmap()` or `NtMapViewOfSection()` can return.
+  */
+  LLFIO_MAKE_FREE_FUNCTION
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<map_handle> map_at(byte *addr, section_handle &section, size_type bytes, extent_type offset = 0, section_handle::flag _flag = section_handle::flag::readwrite) noexcept;
+
   //! The memory section this handle is using
   section_handle *section() const noexcept { return _section; }
   //! Sets the memory section this handle is using
@@ -727,6 +852,28 @@ public:
     return *ret.data();
   }
 
+  /*! \brief Query which pages of a region of memory are currently resident, without faulting them in.
+
+  \return The portion of `bitmap` filled in. Bit `n % 8` of byte `n / 8` is set if page `n` of
+  the region, after it is rounded out to the page size, is resident in memory.
+  \param bitmap Where to write the bitmap, which must be at least `(pages + 7) / 8` bytes long.
+  \param region The region of memory to query.
+
+  Pages are always of `utils::page_size()`, even within large page maps. On POSIX this is
+  implemented using `mincore()`, and so for file backed maps reports pages in the kernel page
+  cache even if not yet faulted into this process. On Windows it reports pages in this process'
+  working set, as does `QueryWorkingSetEx()`.
+
+  Note that since Linux 5.0, for a file backed map `mincore()` reports page cache residency only
+  if the calling process owns the file or could open it for writing. Otherwise only the pages
+  currently mapped into this process are reported as resident, so a page in the page cache but
+  not yet faulted in here appears non-resident. Anonymous memory is unaffected.
+  \errors `errc::invalid_argument` if `bitmap` is too small. Any of the values POSIX mincore()
+  or NtQueryVirtualMemory() can return.
+  \mallocs None.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<span<byte>> residency(span<byte> bitmap, buffer_type region) noexcept;
+
 #if 0
   /*! \brief Read data from the mapped view.
 
@@ -923,6 +1070,24 @@ inline result<section_handle> section(section_handle::extent_type bytes, const p
 {
   return section_handle::section(std::forward<decltype(bytes)>(bytes), std::forward<decltype(dirh)>(dirh), std::forward<decltype(_flag)>(_flag));
 }
+/*! \brief Create a memory section backed by anonymous memory which never touches a filing system.
+\param bytes The initial size of this section. Cannot be zero.
+\param _flag How to create the section.
+
+\errors Any of the values POSIX memfd_create(), ftruncate() or NtCreateSection() can return.
+*/
+inline result<section_handle> anonymous_section(section_handle::extent_type bytes, section_handle::flag _flag = section_handle::flag::read | section_handle::flag::write) noexcept
+{
+  return section_handle::anonymous_section(std::forward<decltype(bytes)>(bytes), std::forward<decltype(_flag)>(_flag));
+}
+/*! \brief Adopt the native handle of a memory section, typically received from another process.
+\param nativeh The native handle of a section, which is taken ownership of.
+\param _flag How the section will be used, which must be permitted by the native handle.
+*/
+inline result<section_handle> from_native_handle(native_handle_type nativeh, section_handle::flag _flag = section_handle::flag::read | section_handle::flag::write) noexcept
+{
+  return section_handle::from_native_handle(std::forward<decltype(nativeh)>(nativeh), std::forward<decltype(_flag)>(_flag));
+}
 //! Return the current maximum permitted extent of the memory section.
 inline result<section_handle::extent_type> length(const section_handle &self) noexcept
 {
@@ -939,6 +1104,16 @@ inline result<section_handle::extent_type> truncate(section_handle &self, sectio
 {
   return self.truncate(std::forward<decltype(newsize)>(newsize));
 }
+//! Place seals upon the section, which cannot be removed.
+inline result<void> add_seals(section_handle &self, section_handle::seal_flag seals) noexcept
+{
+  return self.add_seals(std::forward<decltype(seals)>(seals));
+}
+//! Returns the seals currently placed upon the section.
+inline result<section_handle::seal_flag> seals(const section_handle &self) noexcept
+{
+  return self.seals();
+}
 //! Swap with another instance
 inline void swap(map_handle &self, map_handle &o) noexcept
 {
@@ -977,6 +1152,19 @@ inline result<map_handle> map(section_handle &section, map_handle::size_type byt
 {
   return map_handle::map(std::forward<decltype(section)>(section), std::forward<decltype(bytes)>(bytes), std::forward<decltype(offset)>(offset), std::forward<decltype(_flag)>(_flag));
 }
+/*! Create a memory mapped view of a backing storage at exactly the address `addr`.
+\param addr The address at which to place the view. Must be a multiple of the page size, on Windows it needs to be a multiple of the kernel memory allocation granularity (typically 64Kb).
+\param section A memory section handle specifying the backing storage to use.
+\param bytes How many bytes to map.
+\param offset The offset into the backing storage to map from.
+\param _flag The permissions with which to map the view.
+
+\errors Any of the values POSIX mmap() or NtMapViewOfSection() can return.
+*/
+inline result<map_handle> map_at(byte *addr, section_handle &section, map_handle::size_type bytes, map_handle::extent_type offset = 0, section_handle::flag _flag = section_handle::flag::readwrite) noexcept
+{
+  return map_handle::map_at(std::forward<decltype(addr)>(addr), std::forward<decltype(section)>(section), std::forward<decltype(bytes)>(bytes), std::forward<decltype(offset)>(offset), std::forward<decltype(_flag)>(_flag));
+}
 //! The size of the memory map. This is the accessible size, NOT the reservation size.
 inline map_handle::size_type length(const map_handle &self) noexcept
 {
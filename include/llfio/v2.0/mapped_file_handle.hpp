@@ -29,8 +29,19 @@ Distributed under the Boost Software License, Version 1.0.
 #ifndef LLFIO_MAPPED_FILE_HANDLE_H
 #define LLFIO_MAPPED_FILE_HANDLE_H
 
+#include <memory>  // for unique_ptr
+
 LLFIO_V2_NAMESPACE_EXPORT_BEGIN
 
+namespace detail
+{
+  struct mapped_file_handle_prefetcher;
+  struct LLFIO_DECL mapped_file_handle_prefetcher_deleter
+  {
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void operator()(mapped_file_handle_prefetcher *p) const noexcept;
+  };
+}  // namespace detail
+
 /*! \class mapped_file_handle
 \brief A memory mapped regular file or device
 
@@ -155,6 +166,10 @@ protected:
   size_type _reservation{0};
   section_handle _sh;  // Tracks the file (i.e. *this) somewhat lazily
   map_handle _mh;      // The current map with valid extent
+  std::unique_ptr<detail::mapped_file_handle_prefetcher, detail::mapped_file_handle_prefetcher_deleter> _prefetcher;  // Only if enabled
+
+  // Releases the pages of the given file extent from this process and, where possible, from the page cache without losing their contents
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void _prefetcher_drop(extent_type offset, size_type bytes) noexcept;
 
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC size_t _do_max_buffers() const noexcept override { return _mh.max_buffers(); }
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs = io_request<const_buffers_type>(),
@@ -197,7 +212,13 @@ protected:
   }
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
   {
-    return _mh.read(reqs, d);
+    const auto offset = reqs.offset;
+    auto ret = _mh.read(reqs, d);
+    if(_prefetcher && ret)
+    {
+      touch(offset, ret.bytes_transferred());
+    }
+    return ret;
   }
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
   {
@@ -242,6 +263,7 @@ public:
       , _reservation(o._reservation)
       , _sh(std::move(o._sh))
       , _mh(std::move(o._mh))
+      , _prefetcher(std::move(o._prefetcher))
   {
     _sh.set_backing(this);
     _mh.set_section(&_sh);
@@ -296,7 +318,9 @@ public:
   \param _creation How to create the file.
   \param _caching How to ask the kernel to cache the file.
   \param flags Any additional custom behaviours.
-  \param sflags Any additional custom behaviours for the internal `section_handle`.
+  \param sflags Any additional custom behaviours for the internal `section_handle`. If this
+  includes `section_handle::flag::cow`, the file is mapped copy on write, so changes made
+  through the map are private to this handle and never reach the file.
 
   Note that if the file is currently zero sized, no mapping occurs now, but
   later when `truncate()` or `update_map()` is called.
@@ -471,6 +495,11 @@ public:
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<void> set_multiplexer(io_multiplexer *c = this_thread::multiplexer()) noexcept override
   {
     OUTCOME_TRY(file_handle::set_multiplexer(c));
+    // The map does its i/o in user space, so only propagate if it can actually be multiplexed
+    if(!_mh.is_multiplexable())
+    {
+      return success();
+    }
     return _mh.set_multiplexer(file_handle::multiplexer());
   }
   /*! \brief Return the current maximum permitted extent of the file, after updating the map.
@@ -525,6 +554,60 @@ public:
     return extent.length;
   }
 
+  //! Configuration for the background prefetcher, see `enable_prefetcher()`.
+  struct prefetcher_config
+  {
+    size_type window{4 * 1024 * 1024};  //!< The bytes prefetched per window. Rounded up to the page size.
+    size_type windows_ahead{2};          //!< How many windows to keep prefetched ahead of the access pattern.
+    size_type trigger{2};                //!< How many consecutive sequential or strided accesses before prefetching begins.
+    bool drop_consumed{false};           //!< Release windows already consumed by a sequential scan from memory.
+  };
+  //! Statistics about the background prefetcher, see `prefetcher_statistics()`.
+  struct prefetcher_stats
+  {
+    size_type windows_prefetched{0};  //!< Windows handed to the helper thread for prefetch.
+    size_type bytes_prefetched{0};    //!< Bytes handed to the helper thread for prefetch.
+    size_type bytes_dropped{0};       //!< Bytes of consumed windows released.
+  };
+
+  /*! \brief Enable an opt-in background prefetcher for this mapped file.
+
+  Mapped reads otherwise rely upon the kernel's readahead heuristics, which for very
+  large mapped files scanned in order cause a stall upon a major page fault at every
+  readahead boundary. The prefetcher watches the offsets passed to `read()` and to
+  `touch()`, and once `config.trigger` consecutive sequential or constant stride
+  accesses have been seen, it asks a helper thread to prefetch the next
+  `config.windows_ahead` windows using `map_handle::prefetch()` (`MADV_WILLNEED`
+  on POSIX, `PrefetchVirtualMemory()` on Windows).
+
+  If `config.drop_consumed` is set, windows already passed over by a sequential
+  scan are released from this process' working set and, on POSIX, from the kernel
+  page cache (`MADV_DONTNEED` and `POSIX_FADV_DONTNEED`). Unlike `map_handle::do_not_store()`
+  this never loses the contents of those pages, dirty pages are written back as usual.
+  If the map is copy on write, only the kernel page cache is advised, as releasing the
+  private pages would discard their modifications.
+
+  Calling this again replaces the configuration and resets the access pattern detection.
+
+  \errors Any of the values `std::thread` can throw.
+  \mallocs One allocation, and a thread.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> enable_prefetcher(prefetcher_config config = {}) noexcept;
+  //! Disable the background prefetcher, joining its helper thread.
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void disable_prefetcher() noexcept;
+  //! True if the background prefetcher is enabled.
+  bool is_prefetcher_enabled() const noexcept { return _prefetcher != nullptr; }
+  //! Statistics about the background prefetcher, all zero if it is not enabled.
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC prefetcher_stats prefetcher_statistics() const noexcept;
+  /*! \brief Hint to the background prefetcher that `bytes` at `offset` are being accessed.
+
+  `read()` calls this for you. Code accessing the map directly via `address()` ought
+  to call this once per record or block, it is cheap, and does nothing if the
+  prefetcher is not enabled. It is safe to call concurrently from multiple threads,
+  though interleaved access patterns will not be recognised as sequential or strided.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void touch(extent_type offset, size_type bytes = 1) noexcept;
+
 
 #if 0
   /*! \brief Read data from the mapped file.
@@ -724,6 +807,7 @@ LLFIO_V2_NAMESPACE_END
 #else
 #include "detail/impl/posix/mapped_file_handle.ipp"
 #endif
+#include "detail/impl/mapped_file_handle_prefetcher.ipp"
 #undef LLFIO_INCLUDED_BY_HEADER
 #endif
 
@@ -349,6 +349,13 @@ struct LLFIO_DECL stat_t  // NOLINT
   Windows, however.
   */
   LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<want> stamp(handle &h, want wanted = want::all) noexcept;
+
+#if defined(__linux__) && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+  // Used to fill from the result of an asynchronous statx(), see `fs_handle::co_stat()`
+  static constexpr size_t _statx_buffer_size = 256;
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC unsigned _statx_mask(want wanted) noexcept;
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t _fill_from_statx(const void *statxbuf, want wanted) noexcept;
+#endif
 };
 static_assert(std::is_trivially_copyable<stat_t>::value, "stat_t is not trivally copyable!");
 
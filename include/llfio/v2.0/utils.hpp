@@ -32,6 +32,8 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "quickcpplib/algorithm/string.hpp"
 
+#include <atomic>
+
 //! \file utils.hpp Provides namespace utils
 
 LLFIO_V2_NAMESPACE_EXPORT_BEGIN
@@ -207,6 +209,8 @@ namespace utils
     size_t private_committed{0};
     //! The total anonymous memory currently paged into the process. Always `<= private_committed`. Also known as "active anonymous pages".
     size_t private_paged_in{0};
+    //! The anonymous memory held in `map_handle`'s cache of recycled mappings. Always `<= private_committed`. Can be released using `map_handle::trim_cache()`.
+    size_t private_recycled{0};
   };
   /*! \brief Retrieve the current memory usage statistics for this process.
 
@@ -243,6 +247,8 @@ namespace utils
     }
     LLFIO_HEADERS_ONLY_FUNC_SPEC large_page_allocation allocate_large_pages(size_t bytes);
     LLFIO_HEADERS_ONLY_FUNC_SPEC void deallocate_large_pages(void *p, size_t bytes);
+    // Bytes of address space currently held by map_handle's cache of recycled mappings
+    LLFIO_HEADERS_ONLY_FUNC_SPEC std::atomic<size_t> &map_handle_cache_bytes() noexcept;
   }  // namespace detail
 
   /*! \class page_allocator
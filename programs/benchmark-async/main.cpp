@@ -362,6 +362,24 @@ completion i/o min 1300 max 1.40714e+06 mean 23037 stddev 15035.4
    total results collected = 6094784
 */
 
+/* GCC 12 -O2 on Linux kernel 6.18, null multiplexer only, before and after making
+i/o operation state transitions lock free. Mean total i/o in nanoseconds over five
+interleaved runs of BENCHMARK_DURATION = 3, with the fastest and slowest run:
+
+                            Before                  After
+unsynchronised  1 handles     60.9 (58.7 - 63.8)      55.9 (54.0 - 59.2)
+unsynchronised  4 handles    198.0 (190.8 - 212.3)   182.2 (177.8 - 189.8)
+unsynchronised 16 handles    736.1 (715.8 - 756.5)   708.0 (690.7 - 731.5)
+unsynchronised 64 handles   2894.6 (2811.2 - 3000.4) 2804.2 (2705.1 - 3060.8)
+  synchronised  1 handles     85.1 (81.7 - 89.6)      71.5 (70.0 - 72.6)
+  synchronised  4 handles    256.1 (244.5 - 292.9)   223.8 (213.7 - 243.0)
+  synchronised 16 handles    918.4 (896.3 - 935.2)   820.1 (803.9 - 835.9)
+  synchronised 64 handles   3606.9 (3489.3 - 3736.0) 3279.4 (3118.6 - 3552.1)
+
+Single runs vary by up to 20%. Unsynchronised before and after overlap except with 4
+handles, where after is faster.
+*/
+
 #define LLFIO_ENABLE_TEST_IO_MULTIPLEXERS 1
 
 #include "../../include/llfio/llfio.hpp"
@@ -1143,6 +1161,52 @@ int main(void)
   benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-synchronised.csv", 64, "llfio::pipe_handle and IOCP synchronised", //
     []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_win_iocp(2, true).value(); });
 #endif
+#ifdef __linux__
+  std::cout << "\nWarming up ..." << std::endl;
+  do_benchmark<benchmark_llfio<llfio::pipe_handle>>(-1, //
+    []() -> llfio::io_multiplexer_ptr { return llfio::multiplexer_linux_epoll(2).value(); });
+  benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-epoll-unsynchronised.csv", 64, "llfio::pipe_handle and epoll unsynchronised", //
+    []() -> llfio::io_multiplexer_ptr { return llfio::multiplexer_linux_epoll(1).value(); });
+  benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-epoll-synchronised.csv", 64, "llfio::pipe_handle and epoll synchronised", //
+    []() -> llfio::io_multiplexer_ptr { return llfio::multiplexer_linux_epoll(2).value(); });
+
+  std::cout << "\nWarming up ..." << std::endl;
+  do_benchmark<benchmark_llfio<llfio::pipe_handle>>(-1, //
+    []() -> llfio::io_multiplexer_ptr { return llfio::multiplexer_linux_io_uring(2, false).value(); });
+  benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-io-uring-unsynchronised.csv", 64, "llfio::pipe_handle and io_uring unsynchronised", //
+    []() -> llfio::io_multiplexer_ptr { return llfio::multiplexer_linux_io_uring(1, false).value(); });
+  benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-io-uring-synchronised.csv", 64, "llfio::pipe_handle and io_uring synchronised", //
+    []() -> llfio::io_multiplexer_ptr { return llfio::multiplexer_linux_io_uring(2, false).value(); });
+  // Both io_urings share one pool of kernel worker threads
+  benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-io-uring-shared-wq-unsynchronised.csv", 64,
+                                                 "llfio::pipe_handle and io_uring with shared worker pool unsynchronised", //
+                                                 []() -> llfio::io_multiplexer_ptr {
+                                                   llfio::multiplexer_linux_io_uring_config config;
+                                                   config.share_worker_pool = true;
+                                                   return llfio::multiplexer_linux_io_uring(config).value();
+                                                 });
+  // A kernel thread polls the submission queues, so initiation needs no syscall. This usually
+  // requires elevated privileges on kernels before 5.11.
+  if(llfio::multiplexer_linux_io_uring(1, true))
+  {
+    benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-io-uring-sqpoll-unsynchronised.csv", 64, "llfio::pipe_handle and io_uring SQPOLL unsynchronised", //
+      []() -> llfio::io_multiplexer_ptr { return llfio::multiplexer_linux_io_uring(1, true).value(); });
+    // The kernel submission polling thread pinned to the last CPU, away from this thread
+    benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-io-uring-sqpoll-pinned-unsynchronised.csv", 64,
+                                                   "llfio::pipe_handle and io_uring SQPOLL pinned unsynchronised", //
+                                                   []() -> llfio::io_multiplexer_ptr {
+                                                     llfio::multiplexer_linux_io_uring_config config;
+                                                     config.submission_polling = true;
+                                                     config.submission_polling_cpu = (int) std::max(1U, std::thread::hardware_concurrency()) - 1;
+                                                     return llfio::multiplexer_linux_io_uring(config).value();
+                                                   });
+  }
+  else
+  {
+    std::cout << "\nio_uring SQPOLL is not available to this process, skipping." << std::endl;
+  }
+  // IOPOLL only applies to O_DIRECT file i/o, so cannot be benchmarked with pipes
+#endif
 
 #if ENABLE_ASIO
   std::cout << "\nWarming up ..." << std::endl;
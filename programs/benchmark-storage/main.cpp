@@ -0,0 +1,633 @@
+/* Sweep storage i/o through every backend, emitting latency percentiles as CSV
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+/* Every combination of backend, queue depth, block size, access pattern and read/write mix
+is run for a fixed duration against one test file in a local temporary directory, and
+a row of throughput and latency percentiles is appended to the CSV for each.
+
+Backends:
+  blocking         file_handle, page cache, blocking i/o
+  mmap             mapped_file_handle, i/o is memcpy() to and from the map
+  io_uring         file_handle, page cache, i/o through the io_uring multiplexer
+  direct           file_handle, caching::only_metadata (O_DIRECT), blocking i/o
+  direct_io_uring  file_handle, caching::only_metadata (O_DIRECT), i/o through io_uring
+
+For the blocking backends, the queue depth is the number of threads each issuing one i/o
+at a time. For the io_uring backends, it is the number of i/o kept in flight by a single
+thread. Latency is measured from initiation to observed completion, and is recorded in
+a histogram of two significant figures of precision, as HdrHistogram does.
+
+Reads of the cached backends are mostly served from the page cache, as the test file is
+written out beforehand. Make the test file bigger than RAM to avoid this.
+
+Usage: benchmark-storage [--directory=path] [--file-size=MiB] [--duration=seconds] [--csv=file]
+                         [--backends=blocking,mmap,io_uring,direct,direct_io_uring]
+                         [--queue-depths=1,4,16,64,256] [--block-sizes=512,4096,65536,1048576,4194304]
+                         [--patterns=sequential,random] [--read-percents=100,0,70]
+*/
+
+#include "../../include/llfio/llfio.hpp"
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace llfio = LLFIO_V2_NAMESPACE;
+using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+
+//! Upper bound on the memory used for i/o buffers, beyond which buffers are shared between i/o
+static constexpr size_t MAX_BUFFER_MEMORY = 256 * 1024 * 1024;
+
+enum class backend_t
+{
+  blocking,
+  mmap,
+  io_uring,
+  direct,
+  direct_io_uring
+};
+static const char *backend_names[] = {"blocking", "mmap", "io_uring", "direct", "direct_io_uring"};
+
+struct config_t
+{
+  backend_t backend;
+  size_t queue_depth;
+  size_t block_size;
+  bool random;
+  unsigned read_percent;
+};
+
+// A log-linear histogram of nanoseconds, exact below 128, thereafter within 1/64
+class latency_histogram
+{
+  static constexpr size_t sub_buckets = 64;
+  std::vector<uint64_t> _counts;
+  uint64_t _total{0}, _sum{0}, _max{0};
+
+  static size_t _index(uint64_t v) noexcept
+  {
+    if(v < 2 * sub_buckets)
+    {
+      return (size_t) v;
+    }
+    unsigned shift = 1;
+    while((v >> shift) >= 2 * sub_buckets)
+    {
+      ++shift;
+    }
+    return 2 * sub_buckets + (shift - 1) * sub_buckets + (size_t)((v >> shift) - sub_buckets);
+  }
+  // The highest value recorded into the bucket
+  static uint64_t _value(size_t idx) noexcept
+  {
+    if(idx < 2 * sub_buckets)
+    {
+      return idx;
+    }
+    const unsigned shift = (unsigned) ((idx - 2 * sub_buckets) / sub_buckets) + 1;
+    const uint64_t top = (idx - 2 * sub_buckets) % sub_buckets + sub_buckets;
+    return ((top + 1) << shift) - 1;
+  }
+
+public:
+  latency_histogram()
+      : _counts(2 * sub_buckets + 64 * sub_buckets)
+  {
+  }
+  void record(uint64_t ns) noexcept
+  {
+    _counts[_index(ns)]++;
+    _total++;
+    _sum += ns;
+    _max = std::max(_max, ns);
+  }
+  void merge(const latency_histogram &o) noexcept
+  {
+    for(size_t n = 0; n < _counts.size(); n++)
+    {
+      _counts[n] += o._counts[n];
+    }
+    _total += o._total;
+    _sum += o._sum;
+    _max = std::max(_max, o._max);
+  }
+  uint64_t count() const noexcept { return _total; }
+  uint64_t max() const noexcept { return _max; }
+  double mean() const noexcept { return (_total == 0) ? 0 : (double) _sum / _total; }
+  uint64_t percentile(double p) const noexcept
+  {
+    const auto want = (uint64_t)((p / 100.0) * _total + 0.5);
+    uint64_t seen = 0;
+    for(size_t n = 0; n < _counts.size(); n++)
+    {
+      seen += _counts[n];
+      if(seen >= want && seen > 0)
+      {
+        return std::min(_value(n), _max);
+      }
+    }
+    return _max;
+  }
+};
+
+struct result_t
+{
+  latency_histogram latencies;
+  uint64_t bytes{0};
+  double seconds{0};
+  std::string error;
+};
+
+// Chooses the offset and kind of each i/o
+class access_generator
+{
+  const config_t &_config;
+  const uint64_t _blocks;
+  std::atomic<uint64_t> &_next;
+  small_prng _rand;
+
+public:
+  access_generator(const config_t &config, uint64_t file_size, std::atomic<uint64_t> &next, uint32_t seed)
+      : _config(config)
+      , _blocks(file_size / config.block_size)
+      , _next(next)
+      , _rand(seed)
+  {
+  }
+  uint64_t offset() noexcept
+  {
+    const uint64_t block = _config.random ? (uint64_t) _rand() % _blocks : _next.fetch_add(1, std::memory_order_relaxed) % _blocks;
+    return block * _config.block_size;
+  }
+  bool is_read() noexcept { return (_rand() % 100) < _config.read_percent; }
+};
+
+using buffer_vector = std::vector<llfio::byte, llfio::utils::page_allocator<llfio::byte>>;
+
+// Aligned buffers for the i/o, fewer than the queue depth if they would use too much memory
+static std::vector<buffer_vector> make_buffers(const config_t &config)
+{
+  const size_t count = std::max((size_t) 1, std::min(config.queue_depth, MAX_BUFFER_MEMORY / config.block_size));
+  std::vector<buffer_vector> ret(count);
+  for(auto &b : ret)
+  {
+    b.resize(config.block_size);
+    memset(b.data(), 78, b.size());
+  }
+  return ret;
+}
+
+// One thread per queue depth each issuing one i/o at a time
+template <class HandleType> result_t run_blocking(HandleType &h, const config_t &config, uint64_t file_size, std::chrono::seconds duration)
+{
+  auto buffers = make_buffers(config);
+  std::vector<result_t> results(config.queue_depth);
+  std::atomic<uint64_t> next(0);
+  std::atomic<bool> done(false);
+  std::vector<std::thread> threads;
+  for(size_t n = 0; n < config.queue_depth; n++)
+  {
+    threads.emplace_back([&, n] {
+      auto &buffer = buffers[n % buffers.size()];
+      auto &result = results[n];
+      access_generator access(config, file_size, next, (uint32_t) n + 1);
+      while(!done.load(std::memory_order_relaxed))
+      {
+        const auto offset = access.offset();
+        const auto begin = std::chrono::steady_clock::now();
+        if(access.is_read())
+        {
+          typename HandleType::buffer_type b{buffer.data(), buffer.size()};
+          auto r = h.read({{&b, 1}, offset});
+          if(!r)
+          {
+            result.error = r.error().message();
+            break;
+          }
+          for(auto &i : r.value())
+          {
+            // mapped_file_handle returns buffers pointing into the map rather than filling ours
+            if(i.data() != buffer.data())
+            {
+              memcpy(buffer.data(), i.data(), i.size());
+            }
+            result.bytes += i.size();
+          }
+        }
+        else
+        {
+          typename HandleType::const_buffer_type b{buffer.data(), buffer.size()};
+          auto r = h.write({{&b, 1}, offset});
+          if(!r)
+          {
+            result.error = r.error().message();
+            break;
+          }
+          result.bytes += r.bytes_transferred();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        result.latencies.record((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+      }
+    });
+  }
+  const auto begin = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(duration);
+  done = true;
+  for(auto &t : threads)
+  {
+    t.join();
+  }
+  result_t ret;
+  ret.seconds = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - begin).count();
+  for(auto &r : results)
+  {
+    ret.latencies.merge(r.latencies);
+    ret.bytes += r.bytes;
+    if(ret.error.empty())
+    {
+      ret.error = std::move(r.error);
+    }
+  }
+  return ret;
+}
+
+// One thread keeping queue depth i/o in flight
+result_t run_multiplexed(llfio::io_multiplexer *multiplexer, llfio::file_handle &h, const config_t &config, uint64_t file_size, std::chrono::seconds duration)
+{
+  using buffer_type = llfio::file_handle::buffer_type;
+  using buffers_type = llfio::file_handle::buffers_type;
+  using const_buffer_type = llfio::file_handle::const_buffer_type;
+  using const_buffers_type = llfio::file_handle::const_buffers_type;
+  struct slot_t
+  {
+    std::unique_ptr<llfio::byte[]> storage;
+    llfio::io_multiplexer::io_operation_state *state{nullptr};
+    buffer_type b;
+    const_buffer_type cb;
+    bool is_read{false};
+    std::chrono::steady_clock::time_point begin;
+  };
+  auto buffers = make_buffers(config);
+  const auto state_reqs = multiplexer->io_state_requirements();
+  std::vector<slot_t> slots(config.queue_depth);
+  std::atomic<uint64_t> next(0);
+  access_generator access(config, file_size, next, 1);
+  result_t ret;
+  auto initiate = [&](size_t idx) {
+    auto &slot = slots[idx];
+    auto &buffer = buffers[idx % buffers.size()];
+    const auto offset = access.offset();
+    slot.is_read = access.is_read();
+    slot.begin = std::chrono::steady_clock::now();
+    if(slot.is_read)
+    {
+      slot.b = {buffer.data(), buffer.size()};
+      slot.state = multiplexer->construct_and_init_io_operation({slot.storage.get(), state_reqs.first}, &h, nullptr, {}, {},
+                                                                llfio::file_handle::io_request<buffers_type>({&slot.b, 1}, offset));
+    }
+    else
+    {
+      slot.cb = {buffer.data(), buffer.size()};
+      slot.state = multiplexer->construct_and_init_io_operation({slot.storage.get(), state_reqs.first}, &h, nullptr, {}, {},
+                                                                llfio::file_handle::io_request<const_buffers_type>({&slot.cb, 1}, offset));
+    }
+  };
+  // Returns false if the i/o failed
+  auto complete = [&](slot_t &slot, std::chrono::steady_clock::time_point now) {
+    bool ok = true;
+    if(slot.is_read)
+    {
+      auto r = std::move(*slot.state).get_completed_read();
+      if(r)
+      {
+        ret.bytes += r.bytes_transferred();
+      }
+      else if(ret.error.empty())
+      {
+        ret.error = r.error().message();
+        ok = false;
+      }
+    }
+    else
+    {
+      auto r = std::move(*slot.state).get_completed_write_or_barrier();
+      if(r)
+      {
+        ret.bytes += r.bytes_transferred();
+      }
+      else if(ret.error.empty())
+      {
+        ret.error = r.error().message();
+        ok = false;
+      }
+    }
+    slot.state->~io_operation_state();
+    slot.state = nullptr;
+    ret.latencies.record((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(now - slot.begin).count());
+    return ok;
+  };
+  for(size_t n = 0; n < slots.size(); n++)
+  {
+    slots[n].storage = std::make_unique<llfio::byte[]>(state_reqs.first);
+    initiate(n);
+  }
+  const auto begin = std::chrono::steady_clock::now();
+  auto end = begin;
+  bool stopping = false;
+  size_t inflight = slots.size();
+  while(inflight > 0)
+  {
+    auto flushed = multiplexer->flush_inited_io_operations();
+    if(!flushed)
+    {
+      ret.error = flushed.error().message();
+      stopping = true;
+    }
+    auto checked = multiplexer->check_for_any_completed_io(std::chrono::seconds(1));
+    if(!checked)
+    {
+      ret.error = checked.error().message();
+      stopping = true;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if(!stopping && now - begin >= std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration))
+    {
+      stopping = true;
+      end = now;
+    }
+    for(size_t n = 0; n < slots.size(); n++)
+    {
+      auto &slot = slots[n];
+      if(slot.state != nullptr && is_finished(slot.state->current_state()))
+      {
+        if(!complete(slot, now))
+        {
+          stopping = true;
+        }
+        if(stopping)
+        {
+          --inflight;
+        }
+        else
+        {
+          initiate(n);
+        }
+      }
+    }
+  }
+  if(end == begin)
+  {
+    end = std::chrono::steady_clock::now();
+  }
+  ret.seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin).count();
+  return ret;
+}
+
+static std::vector<std::string> split(const std::string &s)
+{
+  std::vector<std::string> ret;
+  size_t begin = 0;
+  for(size_t idx = s.find(','); idx != s.npos; begin = idx + 1, idx = s.find(',', begin))
+  {
+    ret.push_back(s.substr(begin, idx - begin));
+  }
+  ret.push_back(s.substr(begin));
+  return ret;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string directory, csv("benchmark-storage.csv");
+  uint64_t file_size = 1024ULL * 1024 * 1024;
+  std::chrono::seconds duration(1);
+  std::vector<backend_t> backends = {backend_t::blocking, backend_t::mmap, backend_t::io_uring, backend_t::direct, backend_t::direct_io_uring};
+  std::vector<size_t> queue_depths = {1, 4, 16, 64, 256};
+  std::vector<size_t> block_sizes = {512, 4096, 65536, 1048576, 4194304};
+  std::vector<bool> patterns = {false, true};
+  std::vector<unsigned> read_percents = {100, 0, 70};
+  for(int n = 1; n < argc; n++)
+  {
+    const std::string arg(argv[n]);
+    const auto eq = arg.find('=');
+    const std::string name = arg.substr(0, eq), value = (eq == arg.npos) ? std::string() : arg.substr(eq + 1);
+    if(name == "--directory")
+    {
+      directory = value;
+    }
+    else if(name == "--file-size")
+    {
+      file_size = std::stoull(value) * 1024 * 1024;
+    }
+    else if(name == "--duration")
+    {
+      duration = std::chrono::seconds(std::stoi(value));
+    }
+    else if(name == "--csv")
+    {
+      csv = value;
+    }
+    else if(name == "--backends")
+    {
+      backends.clear();
+      for(auto &i : split(value))
+      {
+        auto it = std::find_if(std::begin(backend_names), std::end(backend_names), [&](const char *x) { return i == x; });
+        if(it == std::end(backend_names))
+        {
+          std::cerr << "Unknown backend " << i << std::endl;
+          return 1;
+        }
+        backends.push_back((backend_t)(it - std::begin(backend_names)));
+      }
+    }
+    else if(name == "--queue-depths")
+    {
+      queue_depths.clear();
+      for(auto &i : split(value))
+      {
+        queue_depths.push_back(std::stoul(i));
+      }
+    }
+    else if(name == "--block-sizes")
+    {
+      block_sizes.clear();
+      for(auto &i : split(value))
+      {
+        block_sizes.push_back(std::stoul(i));
+      }
+    }
+    else if(name == "--patterns")
+    {
+      patterns.clear();
+      for(auto &i : split(value))
+      {
+        patterns.push_back(i == "random");
+      }
+    }
+    else if(name == "--read-percents")
+    {
+      read_percents.clear();
+      for(auto &i : split(value))
+      {
+        read_percents.push_back((unsigned) std::stoul(i));
+      }
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0]
+                << " [--directory=path] [--file-size=MiB] [--duration=seconds] [--csv=file] [--backends=blocking,mmap,io_uring,direct,direct_io_uring] "
+                   "[--queue-depths=1,4,16,64,256] [--block-sizes=512,4096,65536,1048576,4194304] [--patterns=sequential,random] [--read-percents=100,0,70]"
+                << std::endl;
+      return 1;
+    }
+  }
+  try
+  {
+    llfio::path_handle customdirh;
+    if(!directory.empty())
+    {
+      customdirh = llfio::path_handle::path(directory).value();
+    }
+    const auto &dirh = directory.empty() ? llfio::path_discovery::storage_backed_temporary_files_directory() : customdirh;
+    const auto name = llfio::utils::random_string(32) + ".benchmark-storage";
+    // Keep the test file open throughout, it is unlinked when this closes
+    auto testfile = llfio::file_handle::file(dirh, name, llfio::file_handle::mode::write, llfio::file_handle::creation::only_if_not_exist,
+                                             llfio::file_handle::caching::all, llfio::file_handle::flag::unlink_on_first_close)
+                    .value();
+    {
+      std::cout << "Writing " << (file_size / 1024 / 1024) << " MiB test file ..." << std::endl;
+      buffer_vector buffer(1024 * 1024);
+      small_prng rand;
+      for(auto &i : buffer)
+      {
+        i = llfio::to_byte((unsigned char) rand());
+      }
+      for(uint64_t offset = 0; offset < file_size; offset += buffer.size())
+      {
+        testfile.write(offset, {{buffer.data(), (size_t) std::min((uint64_t) buffer.size(), file_size - offset)}}).value();
+      }
+      testfile.barrier(llfio::file_handle::barrier_kind::wait_data_only).value();
+    }
+    llfio::io_multiplexer_ptr multiplexer;
+#ifdef __linux__
+    if(auto r = llfio::multiplexer_linux_io_uring(1, false))
+    {
+      multiplexer = std::move(r).value();
+    }
+    else
+    {
+      std::cerr << "io_uring is not available on this system (" << r.error().message() << "), skipping its backends" << std::endl;
+    }
+#endif
+
+    std::ofstream of(csv);
+    of << "Backend,Handle,Queue depth,Block size,Pattern,Read percent,Operations,IOPS,MiB/sec,Mean usec,p50 usec,p90 usec,p99 usec,p99.9 usec,p99.99 usec,Max usec"
+       << std::endl;
+    for(auto backend : backends)
+    {
+      const bool is_multiplexed = (backend == backend_t::io_uring || backend == backend_t::direct_io_uring);
+      if(is_multiplexed && !multiplexer)
+      {
+        continue;
+      }
+      const auto caching = (backend == backend_t::direct || backend == backend_t::direct_io_uring) ? llfio::file_handle::caching::only_metadata :
+                                                                                                      llfio::file_handle::caching::all;
+      auto fh = llfio::file_handle::file(dirh, name, llfio::file_handle::mode::write, llfio::file_handle::creation::open_existing, caching,
+                                         is_multiplexed ? llfio::file_handle::flag::multiplexable : llfio::file_handle::flag::none)
+                .value();
+      llfio::mapped_file_handle mfh;
+      if(backend == backend_t::mmap)
+      {
+        mfh = llfio::mapped_file_handle::mapped_file(file_size, dirh, name, llfio::file_handle::mode::write, llfio::file_handle::creation::open_existing).value();
+      }
+      if(is_multiplexed)
+      {
+        fh.set_multiplexer(multiplexer.get()).value();
+      }
+      for(auto queue_depth : queue_depths)
+      {
+        for(auto block_size : block_sizes)
+        {
+          if(block_size > file_size)
+          {
+            continue;
+          }
+          for(bool random : patterns)
+          {
+            for(auto read_percent : read_percents)
+            {
+              const config_t config{backend, queue_depth, block_size, random, read_percent};
+              result_t result;
+              switch(backend)
+              {
+              case backend_t::mmap:
+                result = run_blocking(mfh, config, file_size, duration);
+                break;
+              case backend_t::io_uring:
+              case backend_t::direct_io_uring:
+                result = run_multiplexed(multiplexer.get(), fh, config, file_size, duration);
+                break;
+              default:
+                result = run_blocking(fh, config, file_size, duration);
+                break;
+              }
+              std::cout << backend_names[(int) backend] << " qd " << queue_depth << " bs " << block_size << (random ? " random" : " sequential") << " reads "
+                        << read_percent << "%: ";
+              if(!result.error.empty())
+              {
+                // For example, O_DIRECT i/o smaller than the device's sector size
+                std::cout << "FAILED (" << result.error << ")" << std::endl;
+                continue;
+              }
+              const auto &l = result.latencies;
+              const double iops = l.count() / result.seconds, mibs = result.bytes / result.seconds / 1024 / 1024;
+              std::cout << (uint64_t) iops << " IOPS, " << mibs << " MiB/sec, p50 " << l.percentile(50) / 1000.0 << " usec, p99 " << l.percentile(99) / 1000.0
+                        << " usec" << std::endl;
+              of << backend_names[(int) backend] << "," << ((backend == backend_t::mmap) ? "mapped_file_handle" : "file_handle") << "," << queue_depth << ","
+                 << block_size << "," << (random ? "random" : "sequential") << "," << read_percent << "," << l.count() << "," << iops << "," << mibs << ","
+                 << l.mean() / 1000.0 << "," << l.percentile(50) / 1000.0 << "," << l.percentile(90) / 1000.0 << "," << l.percentile(99) / 1000.0 << ","
+                 << l.percentile(99.9) / 1000.0 << "," << l.percentile(99.99) / 1000.0 << "," << l.max() / 1000.0 << std::endl;
+            }
+          }
+        }
+      }
+      if(is_multiplexed)
+      {
+        fh.set_multiplexer(nullptr).value();
+      }
+    }
+    return 0;
+  }
+  catch(const std::exception &e)
+  {
+    std::cerr << "FATAL: " << e.what() << std::endl;
+    return 1;
+  }
+}
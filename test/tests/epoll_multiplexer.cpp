@@ -0,0 +1,192 @@
+/* Integration test kernel for whether the epoll multiplexer works
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include <future>
+
+#ifdef __linux__
+static inline void TestEpollMultiplexerPipeHandle()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  for(size_t threads : {1, 2})
+  {
+    auto multiplexer = llfio::multiplexer_linux_epoll(threads).value();
+    const auto state_reqs = multiplexer->io_state_requirements();
+
+    // Writes which overflow the pipe buffer must be queued, and complete in order
+    {
+      auto pipes = llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value();
+      pipes.second.set_multiplexer(multiplexer.get()).value();
+      static constexpr size_t COUNT = 64, SIZE = 16384;
+      std::vector<std::vector<llfio::byte>> data(COUNT, std::vector<llfio::byte>(SIZE));
+      std::vector<llfio::pipe_handle::const_buffer_type> buffers(COUNT);
+      std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+      std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+      for(size_t n = 0; n < COUNT; n++)
+      {
+        memset(data[n].data(), (int) n, SIZE);
+        buffers[n] = {data[n].data(), SIZE};
+        storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+        states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &pipes.second, nullptr, {}, {},
+                                                                 llfio::pipe_handle::io_request<llfio::pipe_handle::const_buffers_type>({&buffers[n], 1}, 0));
+        BOOST_REQUIRE(states[n] != nullptr);
+      }
+      // Reading from the other end makes the queued writes ready
+      auto reader = std::async([&] {
+        std::vector<llfio::byte> ret(COUNT * SIZE);
+        size_t offset = 0;
+        while(offset < ret.size())
+        {
+          offset += pipes.first.read(0, {{ret.data() + offset, ret.size() - offset}}).value();
+        }
+        return ret;
+      });
+      for(size_t n = 0; n < COUNT; n++)
+      {
+        while(!is_finished(multiplexer->check_io_operation(states[n])))
+        {
+          multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+        }
+        auto r = std::move(*states[n]).get_completed_write_or_barrier();
+        BOOST_REQUIRE(r.has_value());
+        BOOST_CHECK(r.bytes_transferred() == SIZE);
+        states[n]->~io_operation_state();
+      }
+      auto readback = reader.get();
+      for(size_t n = 0; n < COUNT; n++)
+      {
+        BOOST_CHECK(0 == memcmp(readback.data() + n * SIZE, data[n].data(), SIZE));
+      }
+      pipes.second.set_multiplexer(nullptr).value();
+    }
+
+    // Cancellation of a pending read must complete with operation_canceled
+    {
+      auto pipes = llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value();
+      pipes.first.set_multiplexer(multiplexer.get()).value();
+      auto storage = std::make_unique<llfio::byte[]>(state_reqs.first);
+      llfio::byte buffer[64];
+      llfio::pipe_handle::buffer_type b{buffer, sizeof(buffer)};
+      auto *state = multiplexer->construct_and_init_io_operation({storage.get(), state_reqs.first}, &pipes.first, nullptr, {}, {},
+                                                                 llfio::pipe_handle::io_request<llfio::pipe_handle::buffers_type>({&b, 1}, 0));
+      BOOST_CHECK(is_initiated(state->current_state()));
+      // Handles with pending i/o cannot be deregistered
+      BOOST_CHECK(!pipes.first.set_multiplexer(nullptr));
+      auto s = multiplexer->cancel_io_operation(state).value();
+      BOOST_REQUIRE(is_finished(s));
+      auto r = std::move(*state).get_completed_read();
+      BOOST_CHECK(!r && r.error() == llfio::errc::operation_canceled);
+      state->~io_operation_state();
+      // Reading after the write end has closed returns nothing
+      pipes.second.close().value();
+      BOOST_CHECK(pipes.first.read(0, {{buffer, sizeof(buffer)}}).value() == 0);
+      pipes.first.set_multiplexer(nullptr).value();
+    }
+
+    // A cancel arriving after the visitor was told of initiation, but before the i/o was
+    // queued, must still cancel the i/o
+    {
+      auto pipes = llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value();
+      pipes.first.set_multiplexer(multiplexer.get()).value();
+      struct cancelling_visitor final : public llfio::io_multiplexer::io_operation_state_visitor
+      {
+        llfio::io_multiplexer *multiplexer{nullptr};
+        llfio::io_multiplexer::io_operation_state *state{nullptr};
+        bool cancelled{false}, completed{false};
+        virtual void read_initiated(llfio::io_multiplexer::io_operation_state::lock_guard & /*unused*/, llfio::io_operation_state_type /*unused*/) override
+        {
+          cancelled = multiplexer->cancel_io_operation(state).has_value();
+        }
+        virtual bool read_completed(llfio::io_multiplexer::io_operation_state::lock_guard & /*unused*/, llfio::io_operation_state_type /*unused*/,
+                                    llfio::pipe_handle::io_result<llfio::pipe_handle::buffers_type> &&res) override
+        {
+          completed = !res && res.error() == llfio::errc::operation_canceled;
+          return true;
+        }
+      } visitor;
+      visitor.multiplexer = multiplexer.get();
+      auto storage = std::make_unique<llfio::byte[]>(state_reqs.first);
+      llfio::byte buffer[64];
+      llfio::pipe_handle::buffer_type b{buffer, sizeof(buffer)};
+      visitor.state = multiplexer->construct({storage.get(), state_reqs.first}, &pipes.first, &visitor, {}, {},
+                                             llfio::pipe_handle::io_request<llfio::pipe_handle::buffers_type>({&b, 1}, 0));
+      BOOST_REQUIRE(visitor.state != nullptr);
+      (void) multiplexer->init_io_operation(visitor.state);
+      BOOST_CHECK(visitor.cancelled);
+      BOOST_CHECK(visitor.completed);
+      BOOST_CHECK(is_finished(visitor.state->current_state()));
+      visitor.state->~io_operation_state();
+      pipes.first.set_multiplexer(nullptr).value();
+    }
+
+    // Pending reads past their deadline complete with timed_out
+    {
+      auto pipes = llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value();
+      pipes.first.set_multiplexer(multiplexer.get()).value();
+      static constexpr size_t COUNT = 16;
+      std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+      std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+      llfio::byte buffer[64];
+      llfio::pipe_handle::buffer_type b{buffer, sizeof(buffer)};
+      const auto begin = std::chrono::steady_clock::now();
+      for(size_t n = 0; n < COUNT; n++)
+      {
+        storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+        states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &pipes.first, nullptr, {}, std::chrono::milliseconds(50 + n),
+                                                                 llfio::pipe_handle::io_request<llfio::pipe_handle::buffers_type>({&b, 1}, 0));
+      }
+      for(size_t n = 0; n < COUNT; n++)
+      {
+        while(!is_finished(multiplexer->check_io_operation(states[n])))
+        {
+          multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+        }
+        auto r = std::move(*states[n]).get_completed_read();
+        BOOST_CHECK(!r && r.error() == llfio::errc::timed_out);
+        states[n]->~io_operation_state();
+      }
+      BOOST_CHECK(std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(50));
+      // As do blocking reads
+      auto r = pipes.first.read({{&b, 1}, 0}, std::chrono::milliseconds(50));
+      BOOST_CHECK(!r && r.error() == llfio::errc::timed_out);
+      pipes.first.set_multiplexer(nullptr).value();
+    }
+
+    // Seekable handles have their i/o performed synchronously
+    {
+      auto fh = llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable).value();
+      fh.set_multiplexer(multiplexer.get()).value();
+      BOOST_CHECK(fh.write(0, {{(const llfio::byte *) "hello world", 11}}).value() == 11);
+      fh.barrier().value();
+      llfio::byte buffer[64];
+      BOOST_CHECK(fh.read(0, {{buffer, sizeof(buffer)}}).value() == 11);
+      BOOST_CHECK(0 == memcmp(buffer, "hello world", 11));
+      fh.set_multiplexer(nullptr).value();
+    }
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, epoll_multiplexer, pipe_handle, "Tests that pipe i/o through the epoll multiplexer works as expected", TestEpollMultiplexerPipeHandle())
+#endif
@@ -0,0 +1,163 @@
+/* Integration test kernel for whether per i/o request flags work
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestIoRequestFlagsFileHandle()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using io_flag = llfio::file_handle::io_flag;
+  std::vector<llfio::io_multiplexer_ptr> multiplexers;
+  multiplexers.emplace_back();  // no multiplexer
+#ifdef __linux__
+  if(auto multiplexer = llfio::multiplexer_linux_io_uring(1, false))
+  {
+    multiplexers.push_back(std::move(multiplexer).value());
+  }
+#endif
+  for(auto &multiplexer : multiplexers)
+  {
+    auto fh = llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable).value();
+    if(multiplexer)
+    {
+      fh.set_multiplexer(multiplexer.get()).value();
+    }
+    std::vector<llfio::byte> data(65536, llfio::to_byte(78)), buffer(65536);
+
+    // Per write durability
+    for(auto flags : {io_flag(io_flag::data_sync), io_flag(io_flag::sync)})
+    {
+      llfio::file_handle::const_buffer_type b{data.data(), data.size()};
+      BOOST_CHECK(fh.write({{&b, 1}, 0, flags}).value()[0].size() == data.size());
+    }
+
+    // Reads of cached data without blocking either read it, or fail if the platform can't tell
+    {
+      llfio::file_handle::buffer_type b{buffer.data(), buffer.size()};
+      auto r = fh.read({{&b, 1}, 0, io_flag::nowait});
+#ifdef __linux__
+      BOOST_REQUIRE(r.has_value());
+#endif
+      if(r)
+      {
+        BOOST_CHECK(r.value()[0].size() <= buffer.size());
+        BOOST_CHECK(0 == memcmp(buffer.data(), data.data(), r.value()[0].size()));
+      }
+      else
+      {
+        BOOST_CHECK(r.error() == llfio::errc::resource_unavailable_try_again);
+      }
+    }
+
+    // Appends ignore the offset
+    {
+      llfio::file_handle::const_buffer_type b{(const llfio::byte *) "tail", 4};
+      auto w = fh.write({{&b, 1}, 0, io_flag::append});
+#ifdef __linux__
+      BOOST_REQUIRE(w.has_value());
+#endif
+      if(w)
+      {
+        BOOST_CHECK(fh.maximum_extent().value() == data.size() + 4);
+        llfio::byte tail[4];
+        BOOST_CHECK(fh.read(data.size(), {{tail, 4}}).value() == 4);
+        BOOST_CHECK(0 == memcmp(tail, "tail", 4));
+        BOOST_CHECK(fh.read(0, {{tail, 1}}).value() == 1);
+        BOOST_CHECK(tail[0] == llfio::to_byte(78));
+      }
+      else
+      {
+        BOOST_CHECK(w.error() == llfio::errc::operation_not_supported);
+      }
+    }
+    if(multiplexer)
+    {
+      fh.set_multiplexer(nullptr).value();
+    }
+  }
+}
+
+static inline void TestIoRequestFlagsPipeHandle()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using io_flag = llfio::pipe_handle::io_flag;
+  std::vector<llfio::io_multiplexer_ptr> multiplexers;
+  multiplexers.emplace_back();  // no multiplexer
+#ifdef __linux__
+  multiplexers.push_back(llfio::multiplexer_linux_epoll(1).value());
+  if(auto multiplexer = llfio::multiplexer_linux_io_uring(1, false))
+  {
+    multiplexers.push_back(std::move(multiplexer).value());
+  }
+#endif
+  for(auto &multiplexer : multiplexers)
+  {
+    // Blocking pipes, as well as nonblocking ones, must not block
+    for(auto flags : {llfio::pipe_handle::flag::none, llfio::pipe_handle::flag::multiplexable})
+    {
+      if(multiplexer && flags == llfio::pipe_handle::flag::none)
+      {
+        continue;
+      }
+      auto pipes = llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, flags).value();
+      if(multiplexer)
+      {
+        pipes.first.set_multiplexer(multiplexer.get()).value();
+      }
+      llfio::byte buffer[64];
+      llfio::pipe_handle::buffer_type b{buffer, sizeof(buffer)};
+      auto r = pipes.first.read({{&b, 1}, 0, io_flag::nowait});
+      BOOST_REQUIRE(!r);
+      BOOST_CHECK(r.error() == llfio::errc::resource_unavailable_try_again);
+      BOOST_CHECK(pipes.second.write(0, {{(const llfio::byte *) "hello", 5}}).value() == 5);
+      b = {buffer, sizeof(buffer)};
+      r = pipes.first.read({{&b, 1}, 0, io_flag::nowait});
+      BOOST_REQUIRE(r.has_value());
+      BOOST_CHECK(r.value()[0].size() == 5);
+      BOOST_CHECK(0 == memcmp(buffer, "hello", 5));
+      if(multiplexer)
+      {
+        pipes.first.set_multiplexer(nullptr).value();
+      }
+
+      // Writes to a full pipe fail rather than block
+      std::vector<llfio::byte> data(4096);
+      bool failed = false;
+      for(size_t n = 0; n < 4096 && !failed; n++)
+      {
+        llfio::pipe_handle::const_buffer_type cb{data.data(), data.size()};
+        auto w = pipes.second.write({{&cb, 1}, 0, io_flag::nowait});
+        if(!w)
+        {
+          BOOST_CHECK(w.error() == llfio::errc::resource_unavailable_try_again);
+          failed = true;
+        }
+      }
+      BOOST_CHECK(failed);
+    }
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, io_request_flags, file_handle, "Tests that per i/o request flags work as expected with file handles", TestIoRequestFlagsFileHandle())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_request_flags, pipe_handle, "Tests that per i/o request flags work as expected with pipe handles", TestIoRequestFlagsPipeHandle())
@@ -0,0 +1,1171 @@
+/* Integration test kernel for whether the io_uring multiplexer works
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#ifdef __linux__
+#include <poll.h>
+#include <time.h>
+
+static inline void TestIoUringMultiplexerFileHandle()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  for(size_t threads : {1, 2})
+  {
+    auto multiplexer_ = llfio::multiplexer_linux_io_uring(threads, false);
+    if(!multiplexer_)
+    {
+      std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    auto multiplexer = std::move(multiplexer_).value();
+    auto fh = llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable).value();
+    fh.set_multiplexer(multiplexer.get()).value();
+    BOOST_REQUIRE(fh.multiplexer() == multiplexer.get());
+
+    // Blocking i/o through the multiplexer
+    BOOST_CHECK(fh.write(0, {{(const llfio::byte *) "hello world", 11}}).value() == 11);
+    fh.barrier().value();
+    llfio::byte buffer[64];
+    BOOST_CHECK(fh.read(0, {{buffer, sizeof(buffer)}}).value() == 11);
+    BOOST_CHECK(0 == memcmp(buffer, "hello world", 11));
+    BOOST_CHECK(fh.read(6, {{buffer, 5}}).value() == 5);
+    BOOST_CHECK(0 == memcmp(buffer, "world", 5));
+    // Reading past the end of the file returns nothing
+    BOOST_CHECK(fh.read(4096, {{buffer, sizeof(buffer)}}).value() == 0);
+
+    // Ranged barriers of every kind only flush the range requested, and return the buffers barriered
+    for(auto kind : {llfio::file_handle::barrier_kind::nowait_view_only, llfio::file_handle::barrier_kind::wait_view_only,
+                     llfio::file_handle::barrier_kind::nowait_data_only, llfio::file_handle::barrier_kind::wait_data_only,
+                     llfio::file_handle::barrier_kind::nowait_all, llfio::file_handle::barrier_kind::wait_all})
+    {
+      BOOST_CHECK(fh.write(6, {{(const llfio::byte *) "world", 5}}).value() == 5);
+      llfio::file_handle::const_buffer_type b{(const llfio::byte *) "world", 5};
+      auto r = fh.barrier({{&b, 1}, 6}, kind);
+      BOOST_REQUIRE(r);
+      BOOST_CHECK(r.value().size() == 1);
+      BOOST_CHECK(r.value()[0].size() == 5);
+    }
+
+    // Many concurrent writes to non-overlapping regions
+    static constexpr size_t COUNT = 512;
+    const auto state_reqs = multiplexer->io_state_requirements();
+    std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+    std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+    std::vector<uint32_t> values(COUNT);
+    std::vector<llfio::file_handle::const_buffer_type> buffers(COUNT);
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      values[n] = (uint32_t) n;
+      buffers[n] = {(const llfio::byte *) &values[n], sizeof(uint32_t)};
+      storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+      states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &fh, nullptr, {}, {},
+                                                               llfio::file_handle::io_request<llfio::file_handle::const_buffers_type>({&buffers[n], 1}, n * sizeof(uint32_t)));
+      BOOST_REQUIRE(states[n] != nullptr);
+    }
+    multiplexer->flush_inited_io_operations().value();
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      while(!is_finished(multiplexer->check_io_operation(states[n])))
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+      }
+      auto r = std::move(*states[n]).get_completed_write_or_barrier();
+      BOOST_REQUIRE(r.has_value());
+      BOOST_CHECK(r.bytes_transferred() == sizeof(uint32_t));
+      states[n]->~io_operation_state();
+    }
+    std::vector<uint32_t> readback(COUNT);
+    BOOST_REQUIRE(fh.read(0, {{(llfio::byte *) readback.data(), COUNT * sizeof(uint32_t)}}).value() == COUNT * sizeof(uint32_t));
+    BOOST_CHECK(readback == values);
+
+    // Cancellation of pending i/o must complete with operation_canceled, or succeed if too late
+    {
+      auto *state = multiplexer->construct_and_init_io_operation({storage[0].get(), state_reqs.first}, &fh, nullptr, {}, {},
+                                                                 llfio::file_handle::io_request<llfio::file_handle::buffers_type>({(llfio::file_handle::buffer_type *) nullptr, 0}, 0));
+      auto s = multiplexer->cancel_io_operation(state).value();
+      while(!is_finished(s))
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+        s = state->current_state();
+      }
+      auto r = std::move(*state).get_completed_read();
+      BOOST_CHECK(r || r.error() == llfio::errc::operation_canceled);
+      state->~io_operation_state();
+    }
+
+    // I/o blocked behind earlier overlapping i/o which times out or is cancelled must still be released
+    {
+      uint32_t ones = 0x01010101, twos = 0x02020202, threes = 0x03030303, readback = 0;
+      llfio::file_handle::const_buffer_type b1{(const llfio::byte *) &ones, 4}, b2{(const llfio::byte *) &twos, 4}, b3{(const llfio::byte *) &threes, 4};
+      llfio::file_handle::buffer_type b4{(llfio::byte *) &readback, 4};
+      using write_request = llfio::file_handle::io_request<llfio::file_handle::const_buffers_type>;
+      auto *w1 = multiplexer->construct_and_init_io_operation({storage[0].get(), state_reqs.first}, &fh, nullptr, {}, {}, write_request({&b1, 1}, 0));
+      // Blocked by w1, and times out before w1 is submitted
+      auto *w2 = multiplexer->construct_and_init_io_operation({storage[1].get(), state_reqs.first}, &fh, nullptr, {}, std::chrono::milliseconds(1),
+                                                              write_request({&b2, 1}, 0));
+      // Blocked by w1 and w2, and cancelled
+      auto *w3 = multiplexer->construct_and_init_io_operation({storage[2].get(), state_reqs.first}, &fh, nullptr, {}, {}, write_request({&b3, 1}, 2));
+      // Blocked by all of them
+      auto *r4 = multiplexer->construct_and_init_io_operation({storage[3].get(), state_reqs.first}, &fh, nullptr, {}, {},
+                                                              llfio::file_handle::io_request<llfio::file_handle::buffers_type>({&b4, 1}, 0));
+      BOOST_REQUIRE(w1 != nullptr && w2 != nullptr && w3 != nullptr && r4 != nullptr);
+      BOOST_CHECK(is_finished(multiplexer->cancel_io_operation(w3).value()));
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      multiplexer->flush_inited_io_operations().value();
+      for(auto *state : {w1, w2, w3, r4})
+      {
+        while(!is_finished(multiplexer->check_io_operation(state)))
+        {
+          multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+        }
+      }
+      BOOST_CHECK(std::move(*w1).get_completed_write_or_barrier().has_value());
+      auto r2 = std::move(*w2).get_completed_write_or_barrier();
+      BOOST_CHECK(!r2 && r2.error() == llfio::errc::timed_out);
+      auto r3 = std::move(*w3).get_completed_write_or_barrier();
+      BOOST_CHECK(!r3 && r3.error() == llfio::errc::operation_canceled);
+      BOOST_CHECK(std::move(*r4).get_completed_read().value()[0].size() == 4);
+      BOOST_CHECK(readback == ones);
+      for(auto *state : {w1, w2, w3, r4})
+      {
+        state->~io_operation_state();
+      }
+    }
+
+    // A batch of many more reads than the rings can hold is initiated in a single call
+    {
+      static constexpr size_t BATCH = 4096;
+      const auto batch_reqs = multiplexer->batch_io_state_requirements(BATCH);
+      std::vector<llfio::byte> batch_storage(batch_reqs.first + batch_reqs.second);
+      llfio::span<llfio::byte> aligned_storage{
+      (llfio::byte *) (((uintptr_t) batch_storage.data() + batch_reqs.second - 1) & ~(uintptr_t)(batch_reqs.second - 1)), batch_reqs.first};
+      std::vector<llfio::io_multiplexer::io_operation_state *> batch_states(BATCH);
+      std::vector<uint32_t> batch_values(BATCH);
+      std::vector<llfio::file_handle::buffer_type> batch_buffers(BATCH);
+      std::vector<llfio::file_handle::io_request<llfio::file_handle::buffers_type>> batch_requests;
+      for(size_t n = 0; n < BATCH; n++)
+      {
+        batch_buffers[n] = {(llfio::byte *) &batch_values[n], sizeof(uint32_t)};
+        batch_requests.emplace_back(llfio::file_handle::buffers_type(&batch_buffers[n], 1), (n % COUNT) * sizeof(uint32_t));
+      }
+      // Insufficient storage is rejected before anything is initiated
+      BOOST_CHECK(!multiplexer->construct_and_init_io_operations(batch_states, aligned_storage.subspan(0, batch_reqs.first - 1), &fh, nullptr, {},
+                                                                 llfio::span<const llfio::file_handle::io_request<llfio::file_handle::buffers_type>>(batch_requests)));
+      multiplexer
+      ->construct_and_init_io_operations(batch_states, aligned_storage, &fh, nullptr, {},
+                                         llfio::span<const llfio::file_handle::io_request<llfio::file_handle::buffers_type>>(batch_requests))
+      .value();
+      for(size_t n = 0; n < BATCH; n++)
+      {
+        while(!is_finished(multiplexer->check_io_operation(batch_states[n])))
+        {
+          multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+        }
+        auto r = std::move(*batch_states[n]).get_completed_read();
+        BOOST_REQUIRE(r.has_value());
+        BOOST_CHECK(batch_values[n] == values[n % COUNT]);
+        batch_states[n]->~io_operation_state();
+      }
+    }
+
+    // Pooled states are recycled without reallocation, and can be relocated into
+    {
+      llfio::io_multiplexer::state_pool pool(multiplexer.get());
+      llfio::byte buffer2[4];
+      llfio::file_handle::buffer_type b{buffer2, sizeof(buffer2)};
+      auto *state = pool.construct_and_init_io_operation(&fh, nullptr, {}, {}, llfio::file_handle::io_request<llfio::file_handle::buffers_type>({&b, 1}, 0));
+      BOOST_REQUIRE(state != nullptr);
+      while(!is_finished(multiplexer->check_io_operation(state)))
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+      }
+      auto *relocated = pool.relocate(state);
+      BOOST_REQUIRE(relocated != nullptr);
+      pool.release(reinterpret_cast<llfio::byte *>(state));
+      BOOST_CHECK(std::move(*relocated).get_completed_read().value()[0].size() == sizeof(buffer2));
+      pool.destroy(relocated);
+      // The most recently released block is handed out next
+      auto block = pool.acquire();
+      BOOST_CHECK(block.data() == reinterpret_cast<llfio::byte *>(relocated));
+      pool.release(block.data());
+    }
+
+    // Registered buffers come from the multiplexer's slab where possible, and are recycled
+    {
+      size_t bytes = 100;
+      auto b1 = fh.allocate_registered_buffer(bytes).value();
+      BOOST_CHECK(bytes >= 100);
+      BOOST_CHECK(b1->size() == bytes);
+      b1.reset();
+      bytes = 100;
+      b1 = fh.allocate_registered_buffer(bytes).value();
+      bytes = 8192;
+      auto b2 = fh.allocate_registered_buffer(bytes).value();
+      BOOST_CHECK(b2->data() != b1->data());
+      memset(b1->data(), 'x', b1->size());
+      llfio::file_handle::const_buffer_type wb{b1->data(), b1->size()};
+      auto w = fh.write(b1, {{&wb, 1}, 0});
+      BOOST_REQUIRE(w.has_value());
+      BOOST_CHECK(w.bytes_transferred() == b1->size());
+      llfio::file_handle::buffer_type rb{b2->data() + 16, 32};
+      auto r = fh.read(b2, {{&rb, 1}, 0});
+      BOOST_REQUIRE(r.has_value());
+      BOOST_CHECK(r.bytes_transferred() == 32);
+      BOOST_CHECK(r.value()[0].data() == b2->data() + 16);
+      BOOST_CHECK(0 == memcmp(b2->data() + 16, b1->data(), 32));
+      // Registered buffers can outlive the multiplexer
+      fh.set_multiplexer(nullptr).value();
+      multiplexer.reset();
+      memset(b2->data(), 0, b2->size());
+    }
+  }
+}
+
+static inline void TestIoUringMultiplexerMappedFileHandle()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto multiplexer_ = llfio::multiplexer_linux_io_uring(1, false);
+  if(!multiplexer_)
+  {
+    std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+    return;
+  }
+  auto multiplexer = std::move(multiplexer_).value();
+  auto mfh = llfio::mapped_temp_inode(1024 * 1024, llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable).value();
+  mfh.truncate(4096).value();
+  // Mapped file handles do their i/o in user space, which is performed synchronously
+  mfh.set_multiplexer(multiplexer.get()).value();
+  BOOST_CHECK(mfh.max_buffers() == 0);
+  BOOST_CHECK(mfh.write(0, {{(const llfio::byte *) "hello world", 11}}).value() == 11);
+  llfio::byte buffer[64];
+  llfio::mapped_file_handle::buffer_type b{buffer, sizeof(buffer)};
+  auto read = mfh.read({{&b, 1}, 0}).value();
+  BOOST_REQUIRE(read.size() == 1);
+  BOOST_CHECK(0 == memcmp(read[0].data(), "hello world", 11));
+  mfh.barrier().value();
+  mfh.set_multiplexer(nullptr).value();
+}
+
+static inline void TestIoUringMultiplexerPipeHandleDeadlines()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  for(size_t threads : {1, 2})
+  {
+    auto multiplexer_ = llfio::multiplexer_linux_io_uring(threads, false);
+    if(!multiplexer_)
+    {
+      std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    auto multiplexer = std::move(multiplexer_).value();
+    const auto state_reqs = multiplexer->io_state_requirements();
+    auto pipes = llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value();
+    pipes.first.set_multiplexer(multiplexer.get()).value();
+
+    // The first read is submitted with a linked timeout, the remainder wait their turn in
+    // the multiplexer, and all complete with timed_out
+    static constexpr size_t COUNT = 16;
+    std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+    std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+    llfio::byte buffer[64];
+    llfio::pipe_handle::buffer_type b{buffer, sizeof(buffer)};
+    const auto begin = std::chrono::steady_clock::now();
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+      states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &pipes.first, nullptr, {}, std::chrono::milliseconds(50 + n),
+                                                               llfio::pipe_handle::io_request<llfio::pipe_handle::buffers_type>({&b, 1}, 0));
+    }
+    multiplexer->flush_inited_io_operations().value();
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      while(!is_finished(multiplexer->check_io_operation(states[n])))
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+      }
+      auto r = std::move(*states[n]).get_completed_read();
+      BOOST_CHECK(!r && r.error() == llfio::errc::timed_out);
+      states[n]->~io_operation_state();
+    }
+    BOOST_CHECK(std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(50));
+
+    // Blocking reads time out, and reads whose data arrives in time succeed
+    auto r = pipes.first.read({{&b, 1}, 0}, std::chrono::milliseconds(50));
+    BOOST_CHECK(!r && r.error() == llfio::errc::timed_out);
+    BOOST_CHECK(pipes.second.write(0, {{(const llfio::byte *) "hello", 5}}).value() == 5);
+    r = pipes.first.read({{&b, 1}, 0}, std::chrono::seconds(5));
+    BOOST_REQUIRE(r.has_value());
+    BOOST_CHECK(r.bytes_transferred() == 5);
+    pipes.first.set_multiplexer(nullptr).value();
+  }
+}
+
+static inline void TestIoUringMultiplexerGroup()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto group_ = llfio::multiplexer_group_linux_io_uring(4);
+  if(!group_)
+  {
+    std::cout << "io_uring is not available on this system (" << group_.error().message().c_str() << "), skipping test." << std::endl;
+    return;
+  }
+  auto group = std::move(group_).value();
+  BOOST_REQUIRE(group->size() == 4);
+  BOOST_CHECK(group->current_index() < group->size());
+
+  // Spread reads over every multiplexer in the group
+  static constexpr size_t COUNT = 8;
+  std::vector<std::pair<llfio::pipe_handle, llfio::pipe_handle>> pipes;
+  for(size_t n = 0; n < COUNT; n++)
+  {
+    pipes.push_back(llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value());
+    pipes.back().first.set_multiplexer((*group)[n % group->size()]).value();
+  }
+  const auto state_reqs = group->current()->io_state_requirements();
+  std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+  std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+  llfio::byte buffer[COUNT][8];
+  std::vector<llfio::pipe_handle::buffer_type> buffers(COUNT);
+  for(size_t n = 0; n < COUNT; n++)
+  {
+    buffers[n] = {buffer[n], sizeof(buffer[n])};
+    storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+    states[n] = (*group)[n % group->size()]->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &pipes[n].first, nullptr, {}, {},
+                                                                             llfio::pipe_handle::io_request<llfio::pipe_handle::buffers_type>({&buffers[n], 1}, 0));
+    BOOST_REQUIRE(states[n] != nullptr);
+  }
+  group->flush_inited_io_operations().value();
+
+  // Nothing is ready, so this waits out the deadline without failing
+  auto r = group->check_for_any_completed_io(std::chrono::milliseconds(10)).value();
+  BOOST_CHECK(r.initiated_ios_finished == 0);
+
+  // One thread pumping the group completes the i/o of every multiplexer in it
+  for(size_t n = 0; n < COUNT; n++)
+  {
+    BOOST_CHECK(pipes[n].second.write(0, {{(const llfio::byte *) "hello", 5}}).value() == 5);
+  }
+  for(size_t n = 0; n < COUNT; n++)
+  {
+    while(!is_finished(states[n]->current_state()))
+    {
+      group->check_for_any_completed_io(std::chrono::seconds(5)).value();
+    }
+    auto read = std::move(*states[n]).get_completed_read();
+    BOOST_REQUIRE(read.has_value());
+    BOOST_CHECK(read.value()[0].size() == 5);
+    states[n]->~io_operation_state();
+  }
+  for(auto &p : pipes)
+  {
+    p.first.set_multiplexer(nullptr).value();
+  }
+
+  // Handles are assigned to the multiplexer of the calling thread's CPU
+  auto pipe = llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value();
+  group->set_multiplexer(pipe.first).value();
+  BOOST_CHECK(pipe.first.multiplexer() != nullptr);
+  pipe.first.set_multiplexer(nullptr).value();
+}
+
+static inline void TestIoUringMultiplexerGroupIdleSleeps()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto thread_cpu_time = [] {
+    struct timespec ts;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  };
+  auto test = [&](llfio::io_multiplexer_group_ptr group, const char *name) {
+    // More members than a thread could ever cache generations for, as stealing touches them all
+    BOOST_REQUIRE(group->size() == 8);
+    group->set_steal_interval(std::chrono::milliseconds(10));
+    for(int pass = 0; pass < 2; pass++)
+    {
+      const auto begin = std::chrono::steady_clock::now();
+      const auto cpubegin = thread_cpu_time();
+      auto r = group->check_for_any_completed_io(std::chrono::milliseconds(300)).value();
+      const auto cpu = std::chrono::duration_cast<std::chrono::milliseconds>(thread_cpu_time() - cpubegin);
+      const auto wall = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+      std::cout << name << " idle group check took " << wall.count() << " ms of which " << cpu.count() << " ms was CPU" << std::endl;
+      BOOST_CHECK(r.initiated_ios_finished == 0);
+      BOOST_CHECK(wall >= std::chrono::milliseconds(300));
+      // An idle group must sleep, not spin
+      BOOST_CHECK(cpu < wall / 4);
+    }
+  };
+  auto group = llfio::multiplexer_group_linux_io_uring(8);
+  if(!group)
+  {
+    std::cout << "io_uring is not available on this system (" << group.error().message().c_str() << "), skipping io_uring." << std::endl;
+  }
+  else
+  {
+    test(std::move(group).value(), "io_uring");
+  }
+  test(llfio::multiplexer_group_linux_epoll(8).value(), "epoll");
+}
+
+static inline void TestIoUringMultiplexerSyscalls()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto multiplexer_ = llfio::multiplexer_linux_io_uring(1, false);
+  if(!multiplexer_)
+  {
+    std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+    return;
+  }
+  auto multiplexer = std::move(multiplexer_).value();
+  auto dirh = llfio::directory_handle::temp_directory().value();
+  static constexpr size_t COUNT = 64;
+  std::vector<std::string> names;
+  for(size_t n = 0; n < COUNT; n++)
+  {
+    names.push_back(std::to_string(n));
+    auto fh = llfio::file_handle::file(dirh, names.back(), llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+    BOOST_CHECK(fh.write(0, {{(const llfio::byte *) "hello world", n % 12}}).value() == n % 12);
+  }
+
+  // Initiating every open before fetching any result places them all in flight at once
+  std::vector<llfio::io_multiplexer::syscall_awaitable<llfio::file_handle::_co_file_op>> opens;
+  opens.reserve(COUNT);
+  for(size_t n = 0; n < COUNT; n++)
+  {
+    opens.push_back(llfio::file_handle::co_file(dirh, names[n], llfio::file_handle::mode::read, llfio::file_handle::creation::open_existing,
+                                                llfio::file_handle::caching::all, llfio::file_handle::flag::none, multiplexer.get()));
+  }
+  for(auto &o : opens)
+  {
+    (void) o.await_ready();
+  }
+  std::vector<llfio::file_handle> fhs;
+  for(auto &o : opens)
+  {
+    fhs.push_back(o.await_resume().value());
+  }
+  BOOST_CHECK(!llfio::file_handle::co_file(dirh, "nonexistent", llfio::file_handle::mode::read, llfio::file_handle::creation::open_existing,
+                                           llfio::file_handle::caching::all, llfio::file_handle::flag::none, multiplexer.get())
+               .await_resume());
+
+  for(size_t n = 0; n < COUNT; n++)
+  {
+    auto s = fhs[n].co_stat(llfio::stat_t::want::size | llfio::stat_t::want::type, multiplexer.get()).await_resume().value();
+    BOOST_CHECK(s.st_type == llfio::filesystem::file_type::regular);
+    BOOST_CHECK(s.st_size == n % 12);
+  }
+  auto dh = llfio::directory_handle::co_directory(dirh, {}, llfio::directory_handle::mode::read, llfio::directory_handle::creation::open_existing,
+                                                  llfio::directory_handle::caching::all, llfio::directory_handle::flag::none, multiplexer.get())
+            .await_resume()
+            .value();
+  BOOST_CHECK(dh.co_stat(llfio::stat_t::want::type, multiplexer.get()).await_resume().value().st_type == llfio::filesystem::file_type::directory);
+
+  // Handles with a multiplexer set close through it, as does this thread's multiplexer
+  fhs[0] = llfio::file_handle::file(dirh, names[0], llfio::file_handle::mode::read, llfio::file_handle::creation::open_existing,
+                                    llfio::file_handle::caching::all, llfio::file_handle::flag::multiplexable)
+           .value();
+  fhs[0].set_multiplexer(multiplexer.get()).value();
+  llfio::this_thread::set_multiplexer(multiplexer.get());
+  for(auto &fh : fhs)
+  {
+    fh.co_close().await_resume().value();
+    BOOST_CHECK(!fh.is_valid());
+  }
+  llfio::this_thread::set_multiplexer(nullptr);
+  for(auto &name : names)
+  {
+    llfio::file_handle::file(dirh, name, llfio::file_handle::mode::write).value().unlink().value();
+  }
+  dirh.unlink().value();
+}
+
+static inline void TestIoUringMultiplexerDirectoryRead()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto multiplexer_ = llfio::multiplexer_linux_io_uring(1, false);
+  if(!multiplexer_)
+  {
+    std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+    return;
+  }
+  std::vector<llfio::io_multiplexer_ptr> multiplexers;
+  multiplexers.push_back(std::move(multiplexer_).value());
+  multiplexers.push_back(llfio::multiplexer_linux_epoll(1).value());
+  auto dirh = llfio::directory_handle::temp_directory().value();
+  static constexpr size_t DIRECTORIES = 16;
+  std::vector<llfio::directory_handle> dhs;
+  for(size_t d = 0; d < DIRECTORIES; d++)
+  {
+    dhs.push_back(llfio::directory_handle::directory(dirh, std::to_string(d), llfio::directory_handle::mode::write, llfio::directory_handle::creation::if_needed).value());
+    for(size_t n = 0; n < d * 8; n++)
+    {
+      llfio::file_handle::file(dhs.back(), std::to_string(n), llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+    }
+  }
+  for(auto &multiplexer : multiplexers)
+  {
+    // Every directory is enumerated at once
+    std::vector<std::vector<llfio::directory_entry>> entries(DIRECTORIES, std::vector<llfio::directory_entry>(DIRECTORIES * 8));
+    std::vector<llfio::io_multiplexer::syscall_awaitable<llfio::directory_handle::_co_read_op>> reads;
+    reads.reserve(DIRECTORIES);
+    for(size_t d = 0; d < DIRECTORIES; d++)
+    {
+      reads.push_back(dhs[d].co_read({{entries[d].data(), entries[d].size()}}, multiplexer.get()));
+    }
+    for(auto &r : reads)
+    {
+      (void) r.await_ready();
+    }
+    for(size_t d = 0; d < DIRECTORIES; d++)
+    {
+      auto filled = reads[d].await_resume().value();
+      BOOST_CHECK(filled.done());
+      BOOST_REQUIRE(filled.size() == d * 8);
+      std::vector<bool> seen(d * 8);
+      for(auto &i : filled)
+      {
+        const auto n = std::stoul(i.leafname.path().string());
+        BOOST_REQUIRE(n < seen.size());
+        BOOST_CHECK(!seen[n]);
+        seen[n] = true;
+      }
+    }
+    // Globs and partial fills work as per read()
+    llfio::directory_entry few[4];
+    auto filled = dhs[DIRECTORIES - 1].co_read({few}, multiplexer.get()).await_resume().value();
+    BOOST_CHECK(!filled.done());
+    BOOST_CHECK(filled.size() == 4);
+    filled = dhs[DIRECTORIES - 1].co_read({few, "1*"}, multiplexer.get()).await_resume().value();
+    BOOST_CHECK(filled.size() == 4);
+    for(auto &i : filled)
+    {
+      BOOST_CHECK(i.leafname.path().string()[0] == '1');
+    }
+    filled = dhs[DIRECTORIES - 1].co_read({few, "7"}, multiplexer.get()).await_resume().value();
+    BOOST_CHECK(filled.size() == 1);
+    BOOST_CHECK(filled.done());
+  }
+  for(size_t d = 0; d < DIRECTORIES; d++)
+  {
+    for(size_t n = 0; n < d * 8; n++)
+    {
+      llfio::file_handle::file(dhs[d], std::to_string(n), llfio::file_handle::mode::write).value().unlink().value();
+    }
+    dhs[d].unlink().value();
+  }
+  dirh.unlink().value();
+}
+
+static inline void TestIoUringMultiplexerBufferGroup()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  for(size_t threads : {1, 2})
+  {
+    auto multiplexer_ = llfio::multiplexer_linux_io_uring(threads, false);
+    if(!multiplexer_)
+    {
+      std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    auto multiplexer = std::move(multiplexer_).value();
+    auto group_ = multiplexer->allocate_buffer_group(4, 4096);
+    if(!group_)
+    {
+      std::cout << "io_uring cannot select buffers on this system (" << group_.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    auto group = std::move(group_).value();
+    BOOST_CHECK(group->size() == 4 * 4096);
+    const auto state_reqs = multiplexer->io_state_requirements();
+
+    // Many more pipes with a read outstanding than buffers in the group
+    static constexpr size_t COUNT = 64;
+    std::vector<std::pair<llfio::pipe_handle, llfio::pipe_handle>> pipes;
+    std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+    std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+    std::vector<llfio::pipe_handle::buffer_type> buffers(COUNT, {nullptr, 4096});
+    auto init = [&](size_t n) {
+      buffers[n] = {nullptr, 4096};
+      states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &pipes[n].first, nullptr, llfio::io_handle::registered_buffer_type(group),
+                                                               {}, llfio::pipe_handle::io_request<llfio::pipe_handle::buffers_type>({&buffers[n], 1}, 0));
+    };
+    auto wait = [&](size_t n) {
+      while(!is_finished(multiplexer->check_io_operation(states[n])))
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+      }
+      auto r = std::move(*states[n]).get_completed_read();
+      states[n]->~io_operation_state();
+      states[n] = nullptr;
+      return r;
+    };
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      pipes.push_back(llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value());
+      pipes.back().first.set_multiplexer(multiplexer.get()).value();
+      storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+      init(n);
+    }
+    multiplexer->flush_inited_io_operations().value();
+    multiplexer->check_for_any_completed_io(std::chrono::milliseconds(10)).value();
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      BOOST_CHECK(!is_finished(multiplexer->check_io_operation(states[n])));
+    }
+
+    // Only the active pipes are given a buffer, and released buffers get reused
+    for(size_t round = 0; round < 8; round++)
+    {
+      std::vector<llfio::byte *> seen;
+      for(size_t n = round; n < COUNT; n += 16)
+      {
+        BOOST_CHECK(pipes[n].second.write(0, {{(const llfio::byte *) &n, sizeof(n)}}).value() == sizeof(n));
+      }
+      for(size_t n = round; n < COUNT; n += 16)
+      {
+        auto r = wait(n);
+        BOOST_REQUIRE(r.has_value());
+        auto b = r.value()[0];
+        BOOST_REQUIRE(b.size() == sizeof(n));
+        BOOST_CHECK(0 == memcmp(b.data(), &n, sizeof(n)));
+        BOOST_CHECK(b.data() >= group->data() && b.data() < group->data() + group->size());
+        BOOST_CHECK(std::find(seen.begin(), seen.end(), b.data()) == seen.end());
+        seen.push_back(b.data());
+        multiplexer->release_selected_buffer(group, b).value();
+        BOOST_CHECK(multiplexer->release_selected_buffer(group, b).error() == llfio::errc::invalid_argument);
+        init(n);
+      }
+      multiplexer->flush_inited_io_operations().value();
+    }
+
+    // More active pipes than buffers, the excess fail
+    {
+      std::vector<llfio::pipe_handle::buffer_type> held;
+      size_t nobufs = 0;
+      for(size_t n = 0; n < 6; n++)
+      {
+        BOOST_CHECK(pipes[n].second.write(0, {{(const llfio::byte *) "x", 1}}).value() == 1);
+      }
+      for(size_t n = 0; n < 6; n++)
+      {
+        auto r = wait(n);
+        if(r)
+        {
+          held.push_back(r.value()[0]);
+        }
+        else if(r.error() == llfio::errc::no_buffer_space)
+        {
+          nobufs++;
+        }
+      }
+      BOOST_CHECK(held.size() == 4);
+      BOOST_CHECK(nobufs == 2);
+      for(auto &b : held)
+      {
+        multiplexer->release_selected_buffer(group, b).value();
+      }
+    }
+
+    // End of file selects no buffer
+    pipes[COUNT - 1].second.close().value();
+    {
+      auto r = wait(COUNT - 1);
+      BOOST_REQUIRE(r.has_value());
+      BOOST_CHECK(r.value()[0].data() == nullptr);
+      BOOST_CHECK(r.value()[0].size() == 0);
+    }
+
+    // Seekable handles cannot read into a group
+    {
+      auto fh = llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write,
+                                               llfio::file_handle::flag::multiplexable)
+                .value();
+      fh.set_multiplexer(multiplexer.get()).value();
+      llfio::file_handle::buffer_type b{nullptr, 4096};
+      auto r = fh.read(group, {{&b, 1}, 0});
+      BOOST_CHECK(!r && r.error() == llfio::errc::operation_not_supported);
+      fh.set_multiplexer(nullptr).value();
+    }
+
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      if(states[n] != nullptr)
+      {
+        (void) multiplexer->cancel_io_operation(states[n]).value();
+        BOOST_CHECK(!wait(n));
+      }
+      pipes[n].first.set_multiplexer(nullptr).value();
+    }
+  }
+}
+
+static inline void TestIoUringMultiplexerCompletionNotification()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto multiplexer_ = llfio::multiplexer_linux_io_uring(2, false);
+  if(!multiplexer_)
+  {
+    std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+    return;
+  }
+  std::vector<llfio::io_multiplexer_ptr> multiplexers;
+  multiplexers.push_back(std::move(multiplexer_).value());
+  multiplexers.push_back(llfio::multiplexer_linux_epoll(2).value());
+  for(auto &multiplexer : multiplexers)
+  {
+    const auto state_reqs = multiplexer->io_state_requirements();
+    const int fd = multiplexer->completion_notification_handle().value().fd;
+    BOOST_CHECK(multiplexer->completion_notification_handle().value().fd == fd);
+    auto readable = [fd](int ms) {
+      pollfd pfd{fd, POLLIN, 0};
+      return ::poll(&pfd, 1, ms) == 1;
+    };
+    // Notifications may be spurious, but not endlessly so
+    auto drain = [&] {
+      for(size_t n = 0; n < 4 && readable(0); n++)
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(0)).value();
+      }
+      BOOST_CHECK(!readable(20));
+    };
+    // As would a foreign event loop, wait upon the handle and then check without waiting
+    auto foreign_loop = [&](llfio::io_multiplexer::io_operation_state *state, size_t max_completions) {
+      size_t loops = 0;
+      while(!is_finished(state->current_state()))
+      {
+        BOOST_REQUIRE(readable(5000));
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(0), max_completions).value();
+        loops++;
+      }
+      return loops;
+    };
+    static constexpr size_t COUNT = 4;
+    std::vector<std::pair<llfio::pipe_handle, llfio::pipe_handle>> pipes;
+    std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+    std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+    std::vector<llfio::pipe_handle::buffer_type> buffers(COUNT);
+    llfio::byte buffer[COUNT][64];
+    auto init = [&](size_t n, llfio::deadline d) {
+      buffers[n] = {buffer[n], sizeof(buffer[n])};
+      states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &pipes[n].first, nullptr, {}, d,
+                                                               llfio::pipe_handle::io_request<llfio::pipe_handle::buffers_type>({&buffers[n], 1}, 0));
+    };
+    for(size_t n = 0; n < COUNT; n++)
+    {
+      pipes.push_back(llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value());
+      pipes.back().first.set_multiplexer(multiplexer.get()).value();
+      storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+      init(n, {});
+    }
+    multiplexer->flush_inited_io_operations().value();
+    drain();
+
+    // Data arriving makes the handle readable
+    pipes[1].second.write(0, {{(const llfio::byte *) "hello", 5}}).value();
+    foreign_loop(states[1], (size_t) -1);
+    {
+      auto r = std::move(*states[1]).get_completed_read();
+      BOOST_REQUIRE(r.has_value());
+      BOOST_CHECK(r.value()[0].size() == 5);
+      states[1]->~io_operation_state();
+    }
+    drain();
+
+    // Work left undone due to max_completions keeps the handle readable
+    for(size_t n : {0, 2, 3})
+    {
+      pipes[n].second.write(0, {{(const llfio::byte *) "x", 1}}).value();
+    }
+    for(size_t n : {0, 2, 3})
+    {
+      foreign_loop(states[n], 1);
+      BOOST_CHECK(std::move(*states[n]).get_completed_read().has_value());
+      states[n]->~io_operation_state();
+    }
+    drain();
+
+    // Deadlines are enforced without the foreign event loop knowing about them
+    {
+      const auto begin = std::chrono::steady_clock::now();
+      init(0, std::chrono::milliseconds(50));
+      multiplexer->flush_inited_io_operations().value();
+      BOOST_CHECK(foreign_loop(states[0], (size_t) -1) < 20);
+      auto r = std::move(*states[0]).get_completed_read();
+      BOOST_CHECK(!r && r.error() == llfio::errc::timed_out);
+      BOOST_CHECK(std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(50));
+      states[0]->~io_operation_state();
+    }
+    drain();
+
+    for(auto &p : pipes)
+    {
+      p.first.set_multiplexer(nullptr).value();
+    }
+  }
+}
+
+static inline void TestIoUringMultiplexerConfig()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto test = [](const char *desc, llfio::multiplexer_linux_io_uring_config config) {
+    auto multiplexer_ = llfio::multiplexer_linux_io_uring(config);
+    if(!multiplexer_)
+    {
+      std::cout << "io_uring " << desc << " is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping." << std::endl;
+      return;
+    }
+    auto multiplexer = std::move(multiplexer_).value();
+    // Uncached i/o is eligible for completion polling, cached i/o is not
+    for(auto caching : {llfio::file_handle::caching::all, llfio::file_handle::caching::none})
+    {
+      auto fh = llfio::file_handle::uniquely_named_file(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, caching,
+                                                        llfio::file_handle::flag::unlink_on_first_close | llfio::file_handle::flag::multiplexable)
+                .value();
+      fh.set_multiplexer(multiplexer.get()).value();
+      // More i/o in flight than the submission queue holds
+      static constexpr size_t COUNT = 64;
+      const size_t blocksize = 4096;
+      std::vector<llfio::byte, llfio::utils::page_allocator<llfio::byte>> data(COUNT * blocksize), readback(COUNT * blocksize);
+      for(size_t n = 0; n < data.size(); n++)
+      {
+        data[n] = (llfio::byte)(n / blocksize + 1);
+      }
+      const auto state_reqs = multiplexer->io_state_requirements();
+      std::vector<std::unique_ptr<llfio::byte[]>> storage(COUNT);
+      std::vector<llfio::io_multiplexer::io_operation_state *> states(COUNT);
+      std::vector<llfio::file_handle::const_buffer_type> cbuffers(COUNT);
+      std::vector<llfio::file_handle::buffer_type> buffers(COUNT);
+      auto wait_all = [&](auto &&get) {
+        for(size_t n = 0; n < COUNT; n++)
+        {
+          while(!is_finished(multiplexer->check_io_operation(states[n])))
+          {
+            multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+          }
+          BOOST_CHECK(get(states[n]) == blocksize);
+          states[n]->~io_operation_state();
+        }
+      };
+      for(size_t n = 0; n < COUNT; n++)
+      {
+        storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+        cbuffers[n] = {data.data() + n * blocksize, blocksize};
+        states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &fh, nullptr, {}, {},
+                                                                 llfio::file_handle::io_request<llfio::file_handle::const_buffers_type>({&cbuffers[n], 1}, n * blocksize));
+      }
+      multiplexer->flush_inited_io_operations().value();
+      wait_all([](llfio::io_multiplexer::io_operation_state *s) { return std::move(*s).get_completed_write_or_barrier().bytes_transferred(); });
+      for(size_t n = 0; n < COUNT; n++)
+      {
+        buffers[n] = {readback.data() + n * blocksize, blocksize};
+        states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &fh, nullptr, {}, {},
+                                                                 llfio::file_handle::io_request<llfio::file_handle::buffers_type>({&buffers[n], 1}, n * blocksize));
+      }
+      multiplexer->flush_inited_io_operations().value();
+      wait_all([](llfio::io_multiplexer::io_operation_state *s) { return std::move(*s).get_completed_read().bytes_transferred(); });
+      BOOST_CHECK(0 == memcmp(data.data(), readback.data(), data.size()));
+      // i/o with a deadline, and barriers, are never polled
+      llfio::file_handle::buffer_type b{readback.data(), blocksize};
+      BOOST_CHECK(fh.read({{&b, 1}, 0}, std::chrono::seconds(5)).value()[0].size() == blocksize);
+      BOOST_CHECK(fh.barrier({}, llfio::file_handle::barrier_kind::wait_all).has_value());
+      fh.set_multiplexer(nullptr).value();
+    }
+    std::cout << "io_uring " << desc << " ok" << std::endl;
+  };
+  for(size_t threads : {1, 2})
+  {
+    llfio::multiplexer_linux_io_uring_config config;
+    config.threads = threads;
+    test("default", config);
+    {
+      auto c = config;
+      c.submission_entries = 8;
+      c.completion_entries = 32;
+      test("small rings", c);
+    }
+    {
+      auto c = config;
+      c.submission_polling = true;
+      test("submission polling", c);
+      c.submission_polling_cpu = 0;
+      c.submission_polling_idle_ms = 10;
+      test("submission polling pinned", c);
+    }
+    {
+      auto c = config;
+      c.share_worker_pool = true;
+      test("shared worker pool", c);
+      auto other = llfio::multiplexer_linux_io_uring(config);
+      if(other)
+      {
+        c.share_worker_pool_with = other.value().get();
+        test("worker pool shared with another", c);
+      }
+    }
+    {
+      auto c = config;
+      c.completion_polling = true;
+      test("completion polling", c);
+      c.submission_polling = true;
+      test("completion and submission polling", c);
+    }
+  }
+}
+
+static inline void TestIoUringMultiplexerPriority()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using io_priority = llfio::file_handle::io_priority;
+  using io_priority_class = llfio::file_handle::io_priority_class;
+  for(size_t threads : {1, 2})
+  {
+    // A small submission queue, so most of the bulk i/o waits pending
+    llfio::multiplexer_linux_io_uring_config config;
+    config.threads = threads;
+    config.submission_entries = 8;
+    auto multiplexer_ = llfio::multiplexer_linux_io_uring(config);
+    if(!multiplexer_)
+    {
+      std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    auto multiplexer = std::move(multiplexer_).value();
+    auto fh = llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable).value();
+    // Blocking i/o of every priority class works
+    for(auto priority : {io_priority(), io_priority(io_priority_class::realtime), io_priority(io_priority_class::best_effort, 0), io_priority(io_priority_class::idle, 7)})
+    {
+      llfio::file_handle::const_buffer_type cb{(const llfio::byte *) "hello", 5};
+      BOOST_CHECK(fh.write({{&cb, 1}, 0, priority}).value()[0].size() == 5);
+      llfio::byte buffer[5];
+      llfio::file_handle::buffer_type b{buffer, 5};
+      BOOST_CHECK(fh.read({{&b, 1}, 0, priority}).value()[0].size() == 5);
+    }
+    fh.set_multiplexer(multiplexer.get()).value();
+
+    // High priority reads initiated after many bulk writes complete before the last of them
+    static constexpr size_t BULK = 64, HIGH = 4;
+    std::vector<uint32_t> values(BULK + HIGH), readback(HIGH + 1);
+    for(size_t n = 0; n < values.size(); n++)
+    {
+      values[n] = (uint32_t) n;
+    }
+    fh.write(BULK * sizeof(uint32_t), {{(const llfio::byte *) &values[BULK], HIGH * sizeof(uint32_t)}}).value();
+    const auto state_reqs = multiplexer->io_state_requirements();
+    std::vector<std::unique_ptr<llfio::byte[]>> storage(BULK + HIGH + 1);
+    std::vector<llfio::io_multiplexer::io_operation_state *> states(BULK + HIGH + 1);
+    std::vector<llfio::file_handle::const_buffer_type> cbuffers(BULK);
+    std::vector<llfio::file_handle::buffer_type> buffers(HIGH + 1);
+    for(size_t n = 0; n < states.size(); n++)
+    {
+      storage[n] = std::make_unique<llfio::byte[]>(state_reqs.first);
+      if(n < BULK)
+      {
+        cbuffers[n] = {(const llfio::byte *) &values[n], sizeof(uint32_t)};
+        states[n] = multiplexer->construct_and_init_io_operation({storage[n].get(), state_reqs.first}, &fh, nullptr, {}, {},
+                                                                 llfio::file_handle::io_request<llfio::file_handle::const_buffers_type>({&cbuffers[n], 1}, n * sizeof(uint32_t)));
+      }
+      else
+      {
+        // The last high priority read overlaps the last bulk write, so must still follow it
+        const size_t offset = (n < BULK + HIGH) ? n : BULK - 1;
+        buffers[n - BULK] = {(llfio::byte *) &readback[n - BULK], sizeof(uint32_t)};
+        states[n] = multiplexer->construct_and_init_io_operation(
+        {storage[n].get(), state_reqs.first}, &fh, nullptr, {}, {},
+        llfio::file_handle::io_request<llfio::file_handle::buffers_type>({&buffers[n - BULK], 1}, offset * sizeof(uint32_t),
+                                                                         io_priority(io_priority_class::best_effort, 0)));
+      }
+    }
+    multiplexer->flush_inited_io_operations().value();
+    std::vector<int> order(states.size(), -1);
+    for(int seq = 0; seq < (int) states.size();)
+    {
+      for(size_t n = 0; n < states.size(); n++)
+      {
+        if(order[n] == -1 && is_finished(multiplexer->check_io_operation(states[n])))
+        {
+          order[n] = seq++;
+        }
+      }
+      if(seq < (int) states.size())
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5), 1).value();
+      }
+    }
+    BOOST_CHECK(*std::max_element(order.begin() + BULK, order.begin() + BULK + HIGH) < *std::max_element(order.begin(), order.begin() + BULK));
+    BOOST_CHECK(order[BULK + HIGH] > order[BULK - 1]);
+    for(size_t n = 0; n < states.size(); n++)
+    {
+      if(n < BULK)
+      {
+        BOOST_CHECK(std::move(*states[n]).get_completed_write_or_barrier().bytes_transferred() == sizeof(uint32_t));
+      }
+      else
+      {
+        BOOST_CHECK(std::move(*states[n]).get_completed_read().bytes_transferred() == sizeof(uint32_t));
+      }
+      states[n]->~io_operation_state();
+    }
+    for(size_t n = 0; n < HIGH; n++)
+    {
+      BOOST_CHECK(readback[n] == values[BULK + n]);
+    }
+    BOOST_CHECK(readback[HIGH] == values[BULK - 1]);
+    fh.set_multiplexer(nullptr).value();
+  }
+}
+
+#if LLFIO_ENABLE_COROUTINES
+static inline void TestIoUringMultiplexerCoroutineCombinators()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using read_awaitable = llfio::io_multiplexer::awaitable<llfio::file_handle::io_result<llfio::file_handle::buffers_type>>;
+  for(size_t threads : {1, 2})
+  {
+    auto multiplexer_ = llfio::multiplexer_linux_io_uring(threads, false);
+    if(!multiplexer_)
+    {
+      std::cout << "io_uring is not available on this system (" << multiplexer_.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    auto multiplexer = std::move(multiplexer_).value();
+
+    // A scatter read over 32 shards suspends the coroutine once
+    static constexpr size_t SHARDS = 32;
+    auto fh = llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable).value();
+    std::vector<uint32_t> values(SHARDS * 1024), readback(SHARDS * 1024);
+    for(size_t n = 0; n < values.size(); n++)
+    {
+      values[n] = (uint32_t) n;
+    }
+    BOOST_REQUIRE(fh.write(0, {{(const llfio::byte *) values.data(), values.size() * sizeof(uint32_t)}}).value() == values.size() * sizeof(uint32_t));
+    fh.set_multiplexer(multiplexer.get()).value();
+    std::vector<llfio::file_handle::buffer_type> buffers(SHARDS);
+    auto scatter_read = [&]() -> llfio::eager<llfio::result<void>> {
+      std::vector<read_awaitable> reads(SHARDS);
+      for(size_t n = 0; n < SHARDS; n++)
+      {
+        buffers[n] = {(llfio::byte *) &readback[n * 1024], 4096};
+        reads[n] = fh.co_read({{&buffers[n], 1}, n * 4096});
+      }
+      for(auto &r : co_await llfio::when_all(reads))
+      {
+        auto read = r.await_resume();
+        if(!read)
+        {
+          co_return std::move(read).error();
+        }
+        BOOST_CHECK(read.value()[0].size() == 4096);
+      }
+      co_return llfio::success();
+    };
+    {
+      auto c = scatter_read();
+      size_t pumps = 0;
+      while(!c.await_ready())
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+        pumps++;
+      }
+      c.await_resume().value();
+      BOOST_CHECK(pumps <= SHARDS);
+      BOOST_CHECK(readback == values);
+    }
+    fh.set_multiplexer(nullptr).value();
+
+    // The first of many reads to finish resumes the coroutine, the rest are cancelled
+    static constexpr size_t PIPES = 8;
+    std::vector<std::pair<llfio::pipe_handle, llfio::pipe_handle>> pipes;
+    for(size_t n = 0; n < PIPES; n++)
+    {
+      pipes.push_back(llfio::pipe_handle::anonymous_pipe(llfio::pipe_handle::caching::all, llfio::pipe_handle::flag::multiplexable).value());
+      pipes.back().first.set_multiplexer(multiplexer.get()).value();
+    }
+    llfio::byte pipe_buffer[PIPES][8];
+    std::vector<llfio::pipe_handle::buffer_type> pipe_buffers(PIPES);
+    size_t first_index = (size_t) -1;
+    auto first_read = [&]() -> llfio::eager<llfio::result<void>> {
+      std::vector<read_awaitable> reads(PIPES);
+      for(size_t n = 0; n < PIPES; n++)
+      {
+        pipe_buffers[n] = {pipe_buffer[n], 8};
+        reads[n] = pipes[n].first.co_read({{&pipe_buffers[n], 1}, 0});
+      }
+      auto first = co_await llfio::when_any(reads);
+      BOOST_REQUIRE(first.size() == 1);
+      first_index = (size_t)(first.data() - reads.data());
+      auto read = first[0].await_resume();
+      if(!read)
+      {
+        co_return std::move(read).error();
+      }
+      BOOST_CHECK(read.value()[0].size() == 5);
+      co_return llfio::success();
+    };
+    {
+      auto c = first_read();
+      multiplexer->check_for_any_completed_io(std::chrono::milliseconds(10)).value();
+      BOOST_CHECK(!c.await_ready());
+      BOOST_CHECK(pipes[5].second.write(0, {{(const llfio::byte *) "hello", 5}}).value() == 5);
+      while(!c.await_ready())
+      {
+        multiplexer->check_for_any_completed_io(std::chrono::seconds(5)).value();
+      }
+      c.await_resume().value();
+      BOOST_CHECK(first_index == 5);
+    }
+    for(auto &p : pipes)
+    {
+      p.first.set_multiplexer(nullptr).value();
+    }
+  }
+}
+#endif
+
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, file_handle, "Tests that file i/o through the io_uring multiplexer works as expected", TestIoUringMultiplexerFileHandle())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, mapped_file_handle, "Tests that mapped file i/o through the io_uring multiplexer works as expected",
+                       TestIoUringMultiplexerMappedFileHandle())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, pipe_handle_deadlines, "Tests that pipe i/o through the io_uring multiplexer times out as expected",
+                       TestIoUringMultiplexerPipeHandleDeadlines())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, group, "Tests that a group of io_uring multiplexers steals completions as expected",
+                       TestIoUringMultiplexerGroup())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, group_idle_sleeps, "Tests that an idle group of io_uring and epoll multiplexers sleeps rather than spins",
+                       TestIoUringMultiplexerGroupIdleSleeps())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, syscalls, "Tests that opens, closes and stats through the io_uring multiplexer work as expected",
+                       TestIoUringMultiplexerSyscalls())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, directory_read, "Tests that directory enumeration through the io_uring and epoll multiplexers works as expected",
+                       TestIoUringMultiplexerDirectoryRead())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, buffer_group, "Tests that pipe reads through the io_uring multiplexer select buffers from a group as expected",
+                       TestIoUringMultiplexerBufferGroup())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, completion_notification,
+                       "Tests that the completion notification handles of the io_uring and epoll multiplexers become readable as expected",
+                       TestIoUringMultiplexerCompletionNotification())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, config, "Tests that every io_uring multiplexer configuration performs file i/o as expected",
+                       TestIoUringMultiplexerConfig())
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, priority, "Tests that high priority i/o through the io_uring multiplexer overtakes ordinary i/o as expected",
+                       TestIoUringMultiplexerPriority())
+#if LLFIO_ENABLE_COROUTINES
+KERNELTEST_TEST_KERNEL(integration, llfio, io_uring_multiplexer, coroutine_combinators, "Tests that when_all() and when_any() through the io_uring multiplexer work as expected",
+                       TestIoUringMultiplexerCoroutineCombinators())
+#endif
+#endif
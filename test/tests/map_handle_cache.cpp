@@ -0,0 +1,131 @@
+/* Integration test kernel for whether the map_handle recycled mapping cache works
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestMapHandleCache()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  const bool cache_was_disabled = llfio::map_handle::set_cache_disabled(false);
+  llfio::map_handle::trim_cache();
+  auto stats = llfio::map_handle::trim_cache(std::chrono::steady_clock::time_point());
+  BOOST_CHECK(stats.items_in_cache == 0);
+  BOOST_CHECK(stats.bytes_in_cache == 0);
+  const auto hits = stats.hits;
+
+  llfio::byte *addr;
+  {
+    auto maph = llfio::map_handle::map(3 * 1024 * 1024).value();
+    addr = maph.address();
+    memset(addr, 78, maph.length());
+  }
+  stats = llfio::map_handle::trim_cache(std::chrono::steady_clock::time_point());
+#if defined(_WIN32)
+  BOOST_CHECK(stats.items_in_cache == 0);
+  (void) hits;
+#else
+  if(stats.items_in_cache == 0)
+  {
+    // Kernel doesn't implement MADV_FREE
+    std::cout << "NOTE: map_handle recycled mapping cache not available on this platform" << std::endl;
+  }
+  else
+  {
+    BOOST_CHECK(stats.items_in_cache == 1);
+    BOOST_CHECK(stats.bytes_in_cache == 3 * 1024 * 1024);
+    BOOST_CHECK(llfio::utils::current_process_memory_usage().value().private_recycled >= 3 * 1024 * 1024);
+    {
+      // A slightly smaller map reuses the released mapping, and can be zeroed on request
+      auto maph = llfio::map_handle::map(2 * 1024 * 1024 + 4096, true).value();
+      BOOST_CHECK(maph.address() == addr);
+      BOOST_CHECK(maph.length() == 2 * 1024 * 1024 + 4096);
+      bool allzero = true;
+      for(size_t n = 0; n < maph.length(); n++)
+      {
+        if(maph.address()[n] != llfio::to_byte(0))
+        {
+          allzero = false;
+          break;
+        }
+      }
+      BOOST_CHECK(allzero);
+      stats = llfio::map_handle::trim_cache(std::chrono::steady_clock::time_point());
+      BOOST_CHECK(stats.items_in_cache == 0);
+      BOOST_CHECK(stats.hits == hits + 1);
+    }
+    {
+      // Maps with non-default permissions never come from, nor go to, the cache
+      auto maph = llfio::map_handle::map(3 * 1024 * 1024, false, llfio::section_handle::flag::nocommit).value();
+      BOOST_CHECK(maph.address() != addr);
+    }
+    stats = llfio::map_handle::trim_cache(std::chrono::steady_clock::time_point());
+    BOOST_CHECK(stats.items_in_cache == 1);
+
+    // Trimming unmaps everything older than the time point
+    stats = llfio::map_handle::trim_cache();
+    BOOST_CHECK(stats.items_just_trimmed == 1);
+    BOOST_CHECK(stats.bytes_just_trimmed == 3 * 1024 * 1024);
+    BOOST_CHECK(stats.items_in_cache == 0);
+    BOOST_CHECK(llfio::utils::current_process_memory_usage().value().private_recycled == 0);
+
+    // A disabled cache neither takes nor gives
+    BOOST_CHECK(!llfio::map_handle::set_cache_disabled(true));
+    {
+      auto maph = llfio::map_handle::map(3 * 1024 * 1024).value();
+    }
+    stats = llfio::map_handle::trim_cache(std::chrono::steady_clock::time_point());
+    BOOST_CHECK(stats.items_in_cache == 0);
+
+    // The cache is capped, mappings bigger than the cap are never cached, and the least recently
+    // released mappings are unmapped to make room
+    BOOST_CHECK(llfio::map_handle::set_cache_disabled(false));
+    const size_t old_limit = llfio::map_handle::set_cache_limit(4 * 1024 * 1024);
+    {
+      auto maph = llfio::map_handle::map(8 * 1024 * 1024).value();
+    }
+    stats = llfio::map_handle::trim_cache(std::chrono::steady_clock::time_point());
+    BOOST_CHECK(stats.items_in_cache == 0);
+    {
+      auto maph1 = llfio::map_handle::map(3 * 1024 * 1024).value();
+      auto maph2 = llfio::map_handle::map(2 * 1024 * 1024).value();
+      addr = maph2.address();
+      maph1.close().value();
+      maph2.close().value();
+    }
+    stats = llfio::map_handle::trim_cache(std::chrono::steady_clock::time_point());
+    BOOST_CHECK(stats.items_in_cache == 1);
+    BOOST_CHECK(stats.bytes_in_cache == 2 * 1024 * 1024);
+    {
+      // A mapping up to twice the size requested is reused
+      auto maph = llfio::map_handle::map(1024 * 1024).value();
+      BOOST_CHECK(maph.address() == addr);
+    }
+    BOOST_CHECK(llfio::map_handle::set_cache_limit(old_limit) == 4 * 1024 * 1024);
+    llfio::map_handle::trim_cache();
+  }
+#endif
+  llfio::map_handle::set_cache_disabled(cache_was_disabled);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, map_handle, cache, "Tests that the map_handle recycled mapping cache works as expected", TestMapHandleCache())
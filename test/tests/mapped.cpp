@@ -147,5 +147,39 @@ static inline void TestMappedView2()
   BOOST_CHECK(mfh.address() == nullptr);
 }
 
+static inline void TestMappedFileHandleCow()
+{
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::file_handle;
+  using LLFIO_V2_NAMESPACE::byte;
+  {
+    std::error_code ec;
+    filesystem::remove("testfile_cow", ec);
+  }
+  file_handle fh = file_handle::file({}, "testfile_cow", file_handle::mode::write, file_handle::creation::if_needed, file_handle::caching::all, file_handle::flag::unlink_on_first_close).value();
+  std::vector<byte> contents(64 * 1024, to_byte(78));
+  fh.write(0, {{contents.data(), contents.size()}}).value();
+  mapped_file_handle mfh = mapped_file_handle::mapped_file(0, {}, "testfile_cow", file_handle::mode::write, file_handle::creation::open_existing, file_handle::caching::all,
+                                                           file_handle::flag::none, section_handle::flag::cow)
+                           .value();
+  BOOST_REQUIRE(mfh.address() != nullptr);
+  BOOST_CHECK(!!(mfh.map().section_flags() & section_handle::flag::cow));
+  mfh.address()[0] = to_byte(79);
+  BOOST_CHECK(mfh.address()[0] == to_byte(79));
+  // Reserving more address space remaps the file, which must remain copy on write
+  mfh.reserve(1024 * 1024).value();
+  BOOST_REQUIRE(mfh.address() != nullptr);
+  BOOST_CHECK(!!(mfh.map().section_flags() & section_handle::flag::cow));
+  mfh.address()[1] = to_byte(79);
+  BOOST_CHECK(mfh.address()[1] == to_byte(79));
+  mfh.close().value();
+  // Neither modification reached the file
+  byte buffer[2];
+  BOOST_REQUIRE(fh.read(0, {{buffer, 2}}).value() == 2);
+  BOOST_CHECK(buffer[0] == to_byte(78));
+  BOOST_CHECK(buffer[1] == to_byte(78));
+}
+
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, mapped_span1, "Tests that llfio::mapped works as expected", TestMappedView1())
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, mapped_span2, "Tests that llfio::attached works as expected", TestMappedView2())
+KERNELTEST_TEST_KERNEL(integration, llfio, mapped_file_handle, cow, "Tests that a copy on write mapped_file_handle stays copy on write after reserve()", TestMappedFileHandleCow())
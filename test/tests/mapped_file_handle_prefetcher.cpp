@@ -0,0 +1,131 @@
+/* Integration test kernel for the mapped_file_handle background prefetcher
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestMappedFileHandlePrefetcher()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  static constexpr size_t filesize = 16 * 1024 * 1024, chunk = 64 * 1024;
+  auto mfh = llfio::mapped_file_handle::mapped_temp_inode(filesize).value();
+  mfh.truncate(filesize).value();
+  for(size_t n = 0; n < filesize; n += 4096)
+  {
+    mfh.address()[n] = llfio::to_byte(static_cast<unsigned char>(n / 4096));
+  }
+  BOOST_CHECK(!mfh.is_prefetcher_enabled());
+  BOOST_CHECK(mfh.prefetcher_statistics().windows_prefetched == 0);
+  mfh.touch(0);  // does nothing
+  BOOST_CHECK(!mfh.enable_prefetcher({0}));
+
+  llfio::mapped_file_handle::prefetcher_config config;
+  config.window = 1024 * 1024;
+  config.drop_consumed = true;
+  mfh.enable_prefetcher(config).value();
+  BOOST_REQUIRE(mfh.is_prefetcher_enabled());
+
+  // A sequential scan through read() is prefetched ahead, and consumed windows dropped without losing their contents
+  llfio::byte buffer[chunk];
+  bool ok = true;
+  for(size_t offset = 0; offset < filesize; offset += chunk)
+  {
+    llfio::mapped_file_handle::buffer_type b{buffer, chunk};
+    auto read = mfh.read({{&b, 1}, offset}).value();
+    if(read.size() != 1 || read[0].size() != chunk || read[0].data()[0] != llfio::to_byte(static_cast<unsigned char>(offset / 4096)))
+    {
+      ok = false;
+    }
+  }
+  BOOST_CHECK(ok);
+  auto stats = mfh.prefetcher_statistics();
+  std::cout << "Sequential scan prefetched " << stats.windows_prefetched << " windows of " << stats.bytes_prefetched << " bytes, and dropped " << stats.bytes_dropped
+            << " bytes" << std::endl;
+  BOOST_CHECK(stats.windows_prefetched >= filesize / config.window - config.windows_ahead);
+  BOOST_CHECK(stats.bytes_prefetched <= filesize);
+  BOOST_CHECK(stats.bytes_dropped >= filesize / 2);
+  for(size_t n = 0; n < filesize; n += 4096)
+  {
+    if(mfh.address()[n] != llfio::to_byte(static_cast<unsigned char>(n / 4096)))
+    {
+      ok = false;
+    }
+  }
+  BOOST_CHECK(ok);
+
+  // A constant stride through touch() prefetches the next few records
+  config.drop_consumed = false;
+  mfh.enable_prefetcher(config).value();
+  for(size_t offset = 0; offset < filesize / 2; offset += 256 * 1024)
+  {
+    mfh.touch(offset, 4096);
+  }
+  stats = mfh.prefetcher_statistics();
+  BOOST_CHECK(stats.windows_prefetched > 0);
+  BOOST_CHECK(stats.bytes_dropped == 0);
+
+  // Random access prefetches nothing
+  mfh.enable_prefetcher(config).value();
+  for(size_t n = 0; n < 64; n++)
+  {
+    mfh.touch(((n * 7919) % 64) * 256 * 1024 + ((n & 1) ? 0 : 8 * 1024 * 1024), 4096);
+  }
+  BOOST_CHECK(mfh.prefetcher_statistics().windows_prefetched == 0);
+
+  mfh.disable_prefetcher();
+  BOOST_CHECK(!mfh.is_prefetcher_enabled());
+
+  // Dropping consumed windows of a copy on write map must not discard its private modifications
+  auto cowh = llfio::mapped_file_handle::mapped_temp_inode(filesize, llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::mapped_file_handle::mode::write,
+                                                           llfio::mapped_file_handle::flag::none, llfio::section_handle::flag::cow)
+              .value();
+  cowh.truncate(filesize).value();
+  BOOST_REQUIRE(!!(cowh.map().section_flags() & llfio::section_handle::flag::cow));
+  for(size_t n = 0; n < filesize; n += 4096)
+  {
+    cowh.address()[n] = llfio::to_byte(static_cast<unsigned char>(n / 4096 + 1));
+  }
+  config.drop_consumed = true;
+  cowh.enable_prefetcher(config).value();
+  for(size_t offset = 0; offset < filesize; offset += chunk)
+  {
+    llfio::mapped_file_handle::buffer_type b{buffer, chunk};
+    auto read = cowh.read({{&b, 1}, offset}).value();
+    if(read.size() != 1 || read[0].size() != chunk || read[0].data()[0] != llfio::to_byte(static_cast<unsigned char>(offset / 4096 + 1)))
+    {
+      ok = false;
+    }
+  }
+  BOOST_CHECK(ok);
+  BOOST_CHECK(cowh.prefetcher_statistics().bytes_dropped >= filesize / 2);
+  for(size_t n = 0; n < filesize; n += 4096)
+  {
+    if(cowh.address()[n] != llfio::to_byte(static_cast<unsigned char>(n / 4096 + 1)))
+    {
+      ok = false;
+    }
+  }
+  BOOST_CHECK(ok);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, mapped_file_handle, prefetcher, "Tests that the mapped_file_handle background prefetcher works as expected", TestMappedFileHandlePrefetcher())
@@ -0,0 +1,113 @@
+/* Integration test kernel for algorithm::mapped_ring_buffer
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include <thread>
+
+static inline void TestMappedRingBufferWrapAround()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::algorithm::mapped_ring_buffer;
+  auto rb = mapped_ring_buffer::ring_buffer(10000).value();
+  BOOST_REQUIRE(rb.capacity() >= 10000);
+  BOOST_CHECK(rb.capacity() % llfio::utils::page_size() == 0);
+  BOOST_CHECK(rb.empty());
+  // Writes of 60% of the capacity wrap around the end of the buffer every other time
+  std::vector<llfio::byte> data(rb.capacity() * 3 / 5);
+  for(size_t n = 0; n < data.size(); n++)
+  {
+    data[n] = llfio::to_byte(static_cast<unsigned char>(n * 7));
+  }
+  for(size_t round = 0; round < 10; round++)
+  {
+    BOOST_REQUIRE(rb.write({data.data(), data.size()}));
+    BOOST_CHECK(!rb.write({data.data(), data.size()}));  // insufficient space
+    auto b = rb.begin_read();
+    BOOST_REQUIRE(b.size() == data.size());
+    BOOST_CHECK(0 == memcmp(b.data(), data.data(), data.size()));
+    rb.end_read(b.size());
+    BOOST_CHECK(rb.empty());
+  }
+}
+
+static inline void TestMappedRingBufferMultipleProducers()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::algorithm::mapped_ring_buffer;
+  // A second instance attached to the same section sees the same ring buffer, as another process would
+  auto sectionh = llfio::section_handle::section(2 * 1024 * 1024).value();
+  auto producer = mapped_ring_buffer::ring_buffer(sectionh, mapped_ring_buffer::producers::multiple).value();
+  auto consumer = mapped_ring_buffer::attach(sectionh).value();
+  BOOST_CHECK(consumer.capacity() == producer.capacity());
+  BOOST_CHECK(consumer.producer_kind() == mapped_ring_buffer::producers::multiple);
+
+  static constexpr uint32_t threads = 4, records = 100000;
+  std::vector<std::thread> producers;
+  for(uint32_t t = 0; t < threads; t++)
+  {
+    producers.emplace_back([&producer, t] {
+      for(uint32_t n = 0; n < records; n++)
+      {
+        const uint32_t record[3] = {t, n, t * 7 + n};
+        while(!producer.write({reinterpret_cast<const llfio::byte *>(record), sizeof(record)}))
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  // Records from each producer must arrive whole and in order
+  std::vector<uint32_t> next(threads, 0);
+  bool ok = true;
+  for(size_t received = 0; received < threads * records;)
+  {
+    auto b = consumer.begin_read();
+    const size_t count = b.size() / 12;
+    for(size_t n = 0; n < count; n++)
+    {
+      uint32_t record[3];
+      memcpy(record, b.data() + n * 12, 12);
+      if(record[0] >= threads || record[1] != next[record[0]] || record[2] != record[0] * 7 + record[1])
+      {
+        ok = false;
+      }
+      else
+      {
+        next[record[0]]++;
+      }
+    }
+    consumer.end_read(count * 12);
+    received += count;
+  }
+  for(auto &t : producers)
+  {
+    t.join();
+  }
+  BOOST_CHECK(ok);
+  BOOST_CHECK(consumer.empty());
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, mapped_ring_buffer, wrap_around, "Tests that mapped_ring_buffer reads and writes stay contiguous across the wrap around", TestMappedRingBufferWrapAround())
+KERNELTEST_TEST_KERNEL(integration, llfio, mapped_ring_buffer, multiple_producers, "Tests that mapped_ring_buffer works with multiple producers", TestMappedRingBufferMultipleProducers())
@@ -0,0 +1,83 @@
+/* Integration test kernel for whether scatter-gather lists longer than max_buffers() work
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestMaxBuffersFileHandle()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  std::vector<llfio::io_multiplexer_ptr> multiplexers;
+  multiplexers.emplace_back();  // no multiplexer
+#ifdef __linux__
+  if(auto multiplexer = llfio::multiplexer_linux_io_uring(1, false))
+  {
+    multiplexers.push_back(std::move(multiplexer).value());
+  }
+#endif
+  for(auto &multiplexer : multiplexers)
+  {
+    auto fh = llfio::file_handle::temp_inode(llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write, llfio::file_handle::flag::multiplexable).value();
+    if(multiplexer)
+    {
+      fh.set_multiplexer(multiplexer.get()).value();
+    }
+    // Many small records, as a log writer would gather them
+    const size_t records = 2 * fh.max_buffers() + 500, record = 13;
+    std::vector<llfio::byte> data(records * record), readback(records * record);
+    for(size_t n = 0; n < data.size(); n++)
+    {
+      data[n] = llfio::to_byte((unsigned char) (n * 7 + n / 251));
+    }
+    std::vector<llfio::file_handle::const_buffer_type> cbs;
+    std::vector<llfio::file_handle::buffer_type> bs;
+    for(size_t n = 0; n < records; n++)
+    {
+      cbs.emplace_back(data.data() + n * record, record);
+      bs.emplace_back(readback.data() + n * record, record);
+    }
+    auto written = fh.write({cbs, 0}).value();
+    BOOST_CHECK(written.size() == records);
+    auto read = fh.read({bs, 0}).value();
+    BOOST_CHECK(read.size() == records);
+    BOOST_CHECK(0 == memcmp(readback.data(), data.data(), data.size()));
+
+    // A read past the end stops at the end, partway through a later batch
+    const size_t skip = (fh.max_buffers() + 3) * record + 5;
+    bs.clear();
+    for(size_t n = 0; n < records; n++)
+    {
+      bs.emplace_back(readback.data() + n * record, record);
+    }
+    auto r = fh.read({bs, skip});
+    BOOST_REQUIRE(r.has_value());
+    BOOST_CHECK(r.bytes_transferred() == data.size() - skip);
+    BOOST_CHECK(0 == memcmp(readback.data(), data.data() + skip, data.size() - skip));
+    if(multiplexer)
+    {
+      fh.set_multiplexer(nullptr).value();
+    }
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, max_buffers, file_handle, "Tests that scatter-gather lists longer than max_buffers() work as expected with file handles", TestMaxBuffersFileHandle())
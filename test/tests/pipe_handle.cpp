@@ -94,7 +94,7 @@ static inline void TestNonBlockingPipeHandle()
   reader.close().value();
 }
 
-#if LLFIO_ENABLE_TEST_IO_MULTIPLEXERS
+#if LLFIO_ENABLE_TEST_IO_MULTIPLEXERS || defined(__linux__)
 static inline void TestMultiplexedPipeHandle()
 {
   static constexpr size_t MAX_PIPES = 64;
@@ -249,6 +249,23 @@ static inline void TestMultiplexedPipeHandle()
   test_multiplexer(llfio::test::multiplexer_win_iocp(2, false).value());
   std::cout << "\nMultithreaded IOCP, reactor completions:\n";
   test_multiplexer(llfio::test::multiplexer_win_iocp(2, true).value());
+#elif defined(__linux__)
+  std::cout << "\nSingle threaded epoll:\n";
+  test_multiplexer(llfio::multiplexer_linux_epoll(1).value());
+  std::cout << "\nMultithreaded epoll:\n";
+  test_multiplexer(llfio::multiplexer_linux_epoll(2).value());
+  {
+    auto multiplexer = llfio::multiplexer_linux_io_uring(1, false);
+    if(!multiplexer)
+    {
+      std::cout << "\nio_uring is not available on this system (" << multiplexer.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    std::cout << "\nSingle threaded io_uring:\n";
+    test_multiplexer(std::move(multiplexer).value());
+  }
+  std::cout << "\nMultithreaded io_uring:\n";
+  test_multiplexer(llfio::multiplexer_linux_io_uring(2, false).value());
 #else
 #error Not implemented yet
 #endif
@@ -360,6 +377,23 @@ static inline void TestCoroutinedPipeHandle()
   test_multiplexer(llfio::test::multiplexer_win_iocp(2, false).value());
   std::cout << "\nMultithreaded IOCP, reactor completions:\n";
   test_multiplexer(llfio::test::multiplexer_win_iocp(2, true).value());
+#elif defined(__linux__)
+  std::cout << "\nSingle threaded epoll:\n";
+  test_multiplexer(llfio::multiplexer_linux_epoll(1).value());
+  std::cout << "\nMultithreaded epoll:\n";
+  test_multiplexer(llfio::multiplexer_linux_epoll(2).value());
+  {
+    auto multiplexer = llfio::multiplexer_linux_io_uring(1, false);
+    if(!multiplexer)
+    {
+      std::cout << "\nio_uring is not available on this system (" << multiplexer.error().message().c_str() << "), skipping test." << std::endl;
+      return;
+    }
+    std::cout << "\nSingle threaded io_uring:\n";
+    test_multiplexer(std::move(multiplexer).value());
+  }
+  std::cout << "\nMultithreaded io_uring:\n";
+  test_multiplexer(llfio::multiplexer_linux_io_uring(2, false).value());
 #else
 #error Not implemented yet
 #endif
@@ -369,7 +403,7 @@ static inline void TestCoroutinedPipeHandle()
 
 KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, blocking, "Tests that blocking llfio::pipe_handle works as expected", TestBlockingPipeHandle())
 KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, nonblocking, "Tests that nonblocking llfio::pipe_handle works as expected", TestNonBlockingPipeHandle())
-#if LLFIO_ENABLE_TEST_IO_MULTIPLEXERS
+#if LLFIO_ENABLE_TEST_IO_MULTIPLEXERS || defined(__linux__)
 KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, multiplexed, "Tests that multiplexed llfio::pipe_handle works as expected", TestMultiplexedPipeHandle())
 #if LLFIO_ENABLE_COROUTINES
 KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, coroutined, "Tests that coroutined llfio::pipe_handle works as expected", TestCoroutinedPipeHandle())
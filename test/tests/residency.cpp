@@ -0,0 +1,117 @@
+/* Integration test kernel for map_handle::residency() and file_handle::cached_extents()
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestMapHandleResidency()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  const size_t pagesize = llfio::utils::page_size();
+  auto maph = llfio::map_handle::map(256 * pagesize).value();
+  llfio::byte bitmap[32];
+  BOOST_CHECK(!llfio::map_handle::residency({bitmap, 31}, {maph.address(), maph.length()}));
+  // Fault in every fourth page
+  for(size_t n = 0; n < 256; n += 4)
+  {
+    maph.address()[n * pagesize] = llfio::to_byte(78);
+  }
+  auto used = llfio::map_handle::residency({bitmap, 32}, {maph.address(), maph.length()}).value();
+  BOOST_REQUIRE(used.size() == 32);
+  bool ok = true;
+  for(size_t n = 0; n < 256; n += 4)
+  {
+    if((used[n / 8] & llfio::to_byte(static_cast<unsigned char>(1U << (n % 8)))) == llfio::to_byte(0))
+    {
+      ok = false;
+    }
+  }
+  BOOST_CHECK(ok);
+  // A partial page is rounded out to the whole page
+  used = llfio::map_handle::residency({bitmap, 32}, {maph.address() + 4 * pagesize + 1, 1}).value();
+  BOOST_REQUIRE(used.size() == 1);
+  BOOST_CHECK(used[0] == llfio::to_byte(1));
+}
+
+static inline void TestFileHandleCachedExtents()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  const size_t pagesize = llfio::utils::page_size();
+  auto fh = llfio::file_handle::temp_inode().value();
+  std::vector<llfio::byte> buffer(64 * pagesize, llfio::to_byte(78));
+  fh.write(0, {{buffer.data(), buffer.size()}}).value();
+  auto r = fh.cached_extents();
+#ifdef _WIN32
+  BOOST_CHECK(!r && r.error() == llfio::errc::operation_not_supported);
+#else
+  // Pages just written are in the page cache
+  BOOST_REQUIRE(r);
+  BOOST_REQUIRE(!r.value().empty());
+  BOOST_CHECK(r.value().front().offset == 0);
+  BOOST_CHECK(r.value().front().length > 0);
+  llfio::file_handle::extent_type total = 0;
+  for(auto &extent : r.value())
+  {
+    BOOST_CHECK(extent.offset % pagesize == 0);
+    BOOST_CHECK(extent.length % pagesize == 0);
+    BOOST_CHECK(extent.offset + extent.length <= 64 * pagesize);
+    total += extent.length;
+  }
+  std::cout << "cached_extents() reports " << r.value().size() << " extents totalling " << total << " bytes cached of " << buffer.size() << std::endl;
+  // A subrange is clamped to the subrange
+  r = fh.cached_extents({4 * pagesize + 1, pagesize});
+  BOOST_REQUIRE(r);
+  for(auto &extent : r.value())
+  {
+    BOOST_CHECK(extent.offset >= 4 * pagesize);
+    BOOST_CHECK(extent.offset + extent.length <= 5 * pagesize + 1);
+  }
+  // Past the end of the file is nothing
+  r = fh.cached_extents({128 * pagesize, pagesize});
+  BOOST_REQUIRE(r);
+  BOOST_CHECK(r.value().empty());
+  // A read only handle to a file we own can still be trusted to report the page cache
+  auto rfh = fh.reopen(llfio::file_handle::mode::read).value();
+  r = rfh.cached_extents();
+  BOOST_REQUIRE(r);
+  BOOST_CHECK(!r.value().empty());
+  // Nothing is reported past the end of a file which is not a multiple of the page size
+  auto tailfh = llfio::file_handle::temp_inode().value();
+  tailfh.write(0, {{buffer.data(), 10 * pagesize + 100}}).value();
+  r = tailfh.cached_extents();
+  BOOST_REQUIRE(r);
+  BOOST_REQUIRE(!r.value().empty());
+  BOOST_CHECK(r.value().back().offset + r.value().back().length <= 10 * pagesize + 100);
+  std::cout << "cached_extents() of a " << (10 * pagesize + 100) << " byte file ends at " << (r.value().back().offset + r.value().back().length) << std::endl;
+  r = tailfh.cached_extents({2 * pagesize, 8 * pagesize + 50});
+  BOOST_REQUIRE(r);
+  for(auto &extent : r.value())
+  {
+    BOOST_CHECK(extent.offset >= 2 * pagesize);
+    BOOST_CHECK(extent.offset + extent.length <= 10 * pagesize + 50);
+  }
+#endif
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, map_handle, residency, "Tests that map_handle::residency() works as expected", TestMapHandleResidency())
+KERNELTEST_TEST_KERNEL(integration, llfio, file_handle, cached_extents, "Tests that file_handle::cached_extents() works as expected", TestFileHandleCachedExtents())
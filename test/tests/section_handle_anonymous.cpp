@@ -0,0 +1,78 @@
+/* Integration test kernel for section_handle::anonymous_section() and sealing
+(C) 2026 the LLFIO contributors
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+static inline void TestAnonymousSection()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto sectionh = llfio::section_handle::anonymous_section(1024 * 1024).value();
+  BOOST_CHECK(sectionh.length().value() >= 1024 * 1024);
+  BOOST_CHECK(sectionh.seals().value() == llfio::section_handle::seal_flag::none);
+  {
+    auto maph = llfio::map_handle::map(sectionh).value();
+    memset(maph.address(), 78, 1024 * 1024);
+  }
+
+  // Another handle onto the same section sees the same contents, as another process would
+#ifdef _WIN32
+  HANDLE duph = nullptr;
+  BOOST_REQUIRE(DuplicateHandle(GetCurrentProcess(), sectionh.native_handle().h, GetCurrentProcess(), &duph, 0, false, DUPLICATE_SAME_ACCESS));
+  llfio::native_handle_type nativeh;
+  nativeh.h = duph;
+#else
+  llfio::native_handle_type nativeh;
+  nativeh.fd = ::dup(sectionh.native_handle().fd);
+  BOOST_REQUIRE(nativeh.fd != -1);
+#endif
+  {
+    auto sectionh2 = llfio::section_handle::from_native_handle(nativeh, llfio::section_handle::flag::read).value();
+    auto maph = llfio::map_handle::map(sectionh2, 0, 0, llfio::section_handle::flag::read).value();
+    BOOST_CHECK(maph.address()[0] == llfio::to_byte(78));
+    BOOST_CHECK(maph.address()[1024 * 1024 - 1] == llfio::to_byte(78));
+  }
+
+  auto r = sectionh.add_seals(llfio::section_handle::seal_flag::immutable);
+  if(!r && r.error() == llfio::errc::operation_not_supported)
+  {
+    std::cout << "NOTE: section_handle sealing not available on this platform" << std::endl;
+    return;
+  }
+  BOOST_REQUIRE(r);
+  BOOST_CHECK(sectionh.seals().value() == llfio::section_handle::seal_flag::immutable);
+  // The contents can still be read, but no longer changed, resized, or have their seals altered
+  {
+    auto maph = llfio::map_handle::map(sectionh, 0, 0, llfio::section_handle::flag::read).value();
+    BOOST_CHECK(maph.address()[512 * 1024] == llfio::to_byte(78));
+  }
+  BOOST_CHECK(!llfio::map_handle::map(sectionh));
+  BOOST_CHECK(!sectionh.truncate(2 * 1024 * 1024));
+  BOOST_CHECK(sectionh.add_seals(llfio::section_handle::seal_flag::write).error() == llfio::errc::operation_not_permitted);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, section_handle, anonymous, "Tests that section_handle::anonymous_section() can be shared and sealed", TestAnonymousSection())